@@ -0,0 +1,314 @@
+//
+//  EXTBatch.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#include <dispatch/dispatch.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#import "EXTChartViewModel.h"
+#import "EXTChunkedArchive.h"
+#import "EXTDemos.h"
+#import "EXTMaySpectralSequence.h"
+#import "EXTPolynomialSSeq.h"
+
+// computes charts without the app.  each input is a spectral sequence, which
+// is computed through the last page asked for; the chart of every page is
+// written out as JSON, to output/label/E<page>.json, so that two runs can be
+// diffed.  inputs run side by side, one per core.  the label is the input's
+// file name, without its extension; when two inputs would share a label, the
+// later ones get -2, -3, ... appended, so that they don't write over each
+// other.
+//
+//     ext-batch [--pages N] [--output dir] [--leibniz location]...
+//               [--leibniz-generators] input...
+//
+// an input is one of
+//
+//     path/to/document     a saved document, of either format
+//     demo:S5              any of the EXTDemos (S5, KUhC2, A1MSS, working,
+//                          random)
+//     may:n:width          +[EXTMaySpectralSequence fillForAn:width:]
+//
+// with --leibniz, the differentials on each page are pushed along the products
+// with the classes at the given locations (written as the chart writes them,
+// "(s, t)" say) before the chart is drawn; --leibniz-generators does the same
+// with every generator of a polynomial spectral sequence.
+//
+// a line of timings for each input goes to stdout, and problems to stderr.
+
+static int EXTBatchPages = 3;
+static NSString *EXTBatchOutput = @".";
+static NSMutableArray *EXTBatchLeibnizLocations;
+static BOOL EXTBatchLeibnizGenerators = NO;
+
+static uint64_t EXTNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// the phases an input goes through, in the order they're reported.
+enum {
+    EXTPhaseLoad,
+    EXTPhaseCompute,
+    EXTPhaseLeibniz,
+    EXTPhaseChart,
+    EXTPhaseWrite,
+    EXTPhaseCount
+};
+
+static const char *EXTPhaseNames[EXTPhaseCount] = {
+    "load", "compute", "leibniz", "chart", "write"
+};
+
+#pragma mark - inputs
+
+// a file name for the input's charts, which may be shared with other inputs.
+static NSString *EXTLabelForInput(NSString *input) {
+    if ([input hasPrefix:@"demo:"] || [input hasPrefix:@"may:"])
+        return [input stringByReplacingOccurrencesOfString:@":" withString:@"-"];
+
+    return input.lastPathComponent.stringByDeletingPathExtension;
+}
+
+// a file name for each of the inputs' charts, with no two the same.
+static NSArray *EXTUniqueLabelsForInputs(NSArray *inputs) {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:inputs.count];
+    NSMutableSet *taken = [NSMutableSet set];
+
+    for (NSString *input in inputs) {
+        NSString *base = EXTLabelForInput(input), *label = base;
+        for (int suffix = 2; [taken containsObject:label]; suffix++)
+            label = [NSString stringWithFormat:@"%@-%d", base, suffix];
+
+        [taken addObject:label];
+        [ret addObject:label];
+    }
+
+    return ret;
+}
+
+static EXTSpectralSequence *EXTLoadDocument(NSString *path, NSError **error) {
+    NSData *data = [NSData dataWithContentsOfFile:path
+                                          options:NSDataReadingMappedIfSafe
+                                            error:error];
+    if (!data)
+        return nil;
+
+    if ([EXTChunkedArchive isChunkedArchive:data]) {
+        EXTChunkedArchive *archive =
+            [[EXTChunkedArchive alloc] initForReadingWithData:data error:error];
+
+        return archive ? [EXTSpectralSequence sSeqFromChunkedArchive:archive
+                                                                error:error]
+                       : nil;
+    }
+
+    // the documents from before version 8 keep the spectral sequence under its
+    // own key, next to things (colors, marquees) we can't decode here.
+    NSKeyedUnarchiver *unarchiver =
+                        [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
+    EXTSpectralSequence *ret = [unarchiver decodeObjectForKey:@"sseq"];
+    if (!ret && error)
+        *error = [NSError errorWithDomain:@"edu.harvard.math.ext-chart"
+                                     code:(-1)
+                                 userInfo:@{NSLocalizedDescriptionKey:
+                                     @"This isn't an Ext Chart document."}];
+
+    return ret;
+}
+
+static EXTSpectralSequence *EXTLoadInput(NSString *input, NSError **error) {
+    if ([input hasPrefix:@"demo:"]) {
+        NSDictionary *demos = @{
+            @"S5": ^{return [EXTDemos S5Demo];},
+            @"KUhC2": ^{return [EXTDemos KUhC2Demo];},
+            @"A1MSS": ^{return [EXTDemos A1MSSDemo];},
+            @"working": ^{return [EXTDemos workingDemo];},
+            @"random": ^{return [EXTDemos randomDemo];}};
+        EXTSpectralSequence *(^demo)(void) = demos[[input substringFromIndex:5]];
+        if (demo)
+            return demo();
+    } else if ([input hasPrefix:@"may:"]) {
+        NSArray *parts = [input componentsSeparatedByString:@":"];
+        if (parts.count == 3)
+            return [EXTMaySpectralSequence fillForAn:[parts[1] integerValue]
+                                               width:[parts[2] intValue]];
+    } else {
+        return EXTLoadDocument(input, error);
+    }
+
+    if (error)
+        *error = [NSError errorWithDomain:@"edu.harvard.math.ext-chart"
+                                     code:(-1)
+                                 userInfo:@{NSLocalizedDescriptionKey:
+                                     @"Unrecognized input."}];
+    return nil;
+}
+
+// the locations --leibniz asks for, as this spectral sequence spells them.
+static NSArray *EXTLeibnizLocationsFor(EXTSpectralSequence *sseq) {
+    NSMutableArray *ret = [NSMutableArray array];
+
+    for (NSString *string in EXTBatchLeibnizLocations) {
+        EXTLocation *location = [sseq.locConvertor convertFromString:string];
+        if (location)
+            [ret addObject:location];
+        else
+            fprintf(stderr, "couldn't read the location %s\n", string.UTF8String);
+    }
+
+    if (EXTBatchLeibnizGenerators &&
+        [sseq isKindOfClass:[EXTPolynomialSSeq class]])
+        for (NSDictionary *generator in ((EXTPolynomialSSeq*)sseq).generators)
+            [ret addObject:generator[@"location"]];
+
+    return ret;
+}
+
+#pragma mark - running
+
+// returns NO if the input couldn't be read or a chart couldn't be written.
+static BOOL EXTRunInput(NSString *input, NSString *label, double *seconds) {
+    uint64_t start = EXTNanoseconds();
+    NSError *error = nil;
+
+    EXTSpectralSequence *sseq = EXTLoadInput(input, &error);
+    if (!sseq) {
+        fprintf(stderr, "%s: %s\n", input.UTF8String,
+                error.localizedDescription.UTF8String);
+        return NO;
+    }
+
+    NSString *directory = [EXTBatchOutput stringByAppendingPathComponent:label];
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:directory
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:&error]) {
+        fprintf(stderr, "%s: %s\n", input.UTF8String,
+                error.localizedDescription.UTF8String);
+        return NO;
+    }
+
+    NSArray *leibnizLocations = EXTLeibnizLocationsFor(sseq);
+    seconds[EXTPhaseLoad] += (EXTNanoseconds() - start) * 1e-9;
+
+    EXTChartViewModel *chart = [EXTChartViewModel new];
+    chart.sequence = sseq;
+
+    for (int page = 0; page <= EXTBatchPages; page++) {
+        @autoreleasepool {
+            start = EXTNanoseconds();
+            [sseq computeGroupsForPage:page];
+            seconds[EXTPhaseCompute] += (EXTNanoseconds() - start) * 1e-9;
+
+            if (leibnizLocations.count > 0) {
+                start = EXTNanoseconds();
+                [sseq propagateLeibniz:leibnizLocations page:page];
+                [sseq computeGroupsForPage:page];
+                seconds[EXTPhaseLeibniz] += (EXTNanoseconds() - start) * 1e-9;
+            }
+
+            start = EXTNanoseconds();
+            chart.currentPage = page;
+            [chart reloadCurrentPage];
+            NSDictionary *plist = chart.propertyListRepresentation;
+            seconds[EXTPhaseChart] += (EXTNanoseconds() - start) * 1e-9;
+
+            start = EXTNanoseconds();
+            NSData *json =
+                [NSJSONSerialization dataWithJSONObject:plist
+                                                options:NSJSONWritingPrettyPrinted
+                                                  error:&error];
+            NSString *path = [directory stringByAppendingPathComponent:
+                                [NSString stringWithFormat:@"E%d.json", page]];
+            BOOL written = json && [json writeToFile:path
+                                             options:NSDataWritingAtomic
+                                               error:&error];
+            seconds[EXTPhaseWrite] += (EXTNanoseconds() - start) * 1e-9;
+
+            if (!written) {
+                fprintf(stderr, "%s: %s\n", path.UTF8String,
+                        error.localizedDescription.UTF8String);
+                return NO;
+            }
+        }
+    }
+
+    return YES;
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        NSMutableArray *inputs = [NSMutableArray array];
+        EXTBatchLeibnizLocations = [NSMutableArray array];
+
+        for (int i = 1; i < argc; i++) {
+            if (!strcmp(argv[i], "--pages") && i + 1 < argc)
+                EXTBatchPages = atoi(argv[++i]);
+            else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+                EXTBatchOutput = @(argv[++i]);
+            else if (!strcmp(argv[i], "--leibniz") && i + 1 < argc)
+                [EXTBatchLeibnizLocations addObject:@(argv[++i])];
+            else if (!strcmp(argv[i], "--leibniz-generators"))
+                EXTBatchLeibnizGenerators = YES;
+            else if (argv[i][0] != '-')
+                [inputs addObject:@(argv[i])];
+            else
+                inputs = nil;
+
+            if (!inputs)
+                break;
+        }
+
+        if (inputs.count == 0) {
+            fprintf(stderr, "usage: %s [--pages N] [--output dir] "
+                            "[--leibniz location]... [--leibniz-generators] "
+                            "input...\n", argv[0]);
+            return 1;
+        }
+
+        // each spectral sequence spreads its own work over the cores as well,
+        // but a page's terms are often too few to keep them all busy, so the
+        // inputs go side by side.
+        NSUInteger count = inputs.count;
+        NSArray *labels = EXTUniqueLabelsForInputs(inputs);
+        double *seconds = calloc(count * EXTPhaseCount, sizeof(double));
+        BOOL *succeeded = calloc(count, sizeof(BOOL));
+        uint64_t start = EXTNanoseconds();
+
+        dispatch_apply(count,
+                       dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                       ^(size_t i) {
+            @autoreleasepool {
+                succeeded[i] = EXTRunInput(inputs[i], labels[i],
+                                           seconds + i * EXTPhaseCount);
+            }
+        });
+
+        int failures = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            printf("%-32s", [inputs[i] UTF8String]);
+            for (int phase = 0; phase < EXTPhaseCount; phase++)
+                printf(" %s %9.3fs", EXTPhaseNames[phase],
+                       seconds[i * EXTPhaseCount + phase]);
+            printf("%s\n", succeeded[i] ? "" : "  FAILED");
+            failures += !succeeded[i];
+        }
+        printf("%lu inputs in %.3fs\n", (unsigned long)count,
+               (EXTNanoseconds() - start) * 1e-9);
+
+        free(seconds);
+        free(succeeded);
+
+        return failures ? 1 : 0;
+    }
+}
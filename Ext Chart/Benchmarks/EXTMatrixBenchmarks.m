@@ -0,0 +1,316 @@
+//
+//  EXTMatrixBenchmarks.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#import "EXTDenseMultiply.h"
+#import "EXTMatrix.h"
+#import "EXTScratch.h"
+
+// a headless harness for the linear algebra underneath the spectral sequence
+// model.  each benchmark runs its block in batches of doubling size until a
+// batch takes up the minimum time, then reports that batch's time, heap
+// allocations and bytes per call.  everything is written to stdout as a single
+// JSON document, so that the results of two commits can be diffed or fed to a
+// script:
+//
+//     ext-bench [--min-time seconds] [--filter substring] [--label text]
+//
+// the allocation figures come from EXTHeapAllocationCount, so they count the
+// buffers behind matrix entries (and the scratch arena's chunks), not every
+// object that passes through the heap.
+
+typedef void (^EXTBenchmarkBlock)(void);
+
+static double EXTBenchmarkMinTime = 0.2;
+static const char *EXTBenchmarkFilter = NULL;
+
+static uint64_t EXTNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// same distribution as the unit tests: roughly density percent of the entries
+// are nonzero, and in characteristic 0 they lie in [-3, 3].
+static EXTMatrix *EXTRandomMatrix(int width, int height, int characteristic,
+                                  int density) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:height];
+    ret.characteristic = characteristic;
+
+    int *data = ret.presentation.mutableBytes;
+    for (int i = 0; i < width*height; i++)
+        if (random() % 100 < density)
+            data[i] = (int)(random() % (characteristic ? characteristic : 7)) -
+                      (characteristic ? 0 : 3);
+
+    return ret;
+}
+
+static EXTMatrix *EXTIdentity(int width, int characteristic) {
+    EXTMatrix *ret = [EXTMatrix identity:width];
+    ret.characteristic = characteristic;
+
+    return ret;
+}
+
+static void EXTRunBenchmark(NSMutableArray *results, NSString *kernel,
+                            NSDictionary *parameters, EXTBenchmarkBlock block) {
+    NSMutableString *name = [NSMutableString stringWithString:kernel];
+    for (NSString *key in [parameters.allKeys
+                           sortedArrayUsingSelector:@selector(compare:)])
+        [name appendFormat:@"/%@=%@", key, parameters[key]];
+
+    if (EXTBenchmarkFilter && !strstr(name.UTF8String, EXTBenchmarkFilter))
+        return;
+
+    // once to warm up the caches and the scratch arena.
+    @autoreleasepool {
+        block();
+    }
+
+    uint64_t iterations = 1, elapsed, allocations, bytes;
+    while (true) {
+        uint64_t startAllocations = EXTHeapAllocationCount(),
+                 startBytes = EXTHeapAllocationBytes(),
+                 start = EXTNanoseconds();
+        @autoreleasepool {
+            for (uint64_t i = 0; i < iterations; i++)
+                block();
+        }
+        elapsed = EXTNanoseconds() - start;
+        allocations = EXTHeapAllocationCount() - startAllocations;
+        bytes = EXTHeapAllocationBytes() - startBytes;
+
+        if (elapsed >= EXTBenchmarkMinTime * 1e9 || iterations >= (1ull << 30))
+            break;
+        iterations *= 2;
+    }
+
+    NSMutableDictionary *result = [parameters mutableCopy];
+    result[@"name"] = name;
+    result[@"kernel"] = kernel;
+    result[@"iterations"] = @(iterations);
+    result[@"nsPerOp"] = @((double)elapsed / iterations);
+    result[@"allocationsPerOp"] = @((double)allocations / iterations);
+    result[@"bytesPerOp"] = @((double)bytes / iterations);
+    [results addObject:result];
+
+    fprintf(stderr, "%-60s %14.0f ns/op %10.1f allocs/op %12.0f B/op\n",
+            name.UTF8String, (double)elapsed / iterations,
+            (double)allocations / iterations, (double)bytes / iterations);
+}
+
+#pragma mark - kernels
+
+// the individual routines on square random matrices.  characteristic 0 stays
+// small, since integral reduction grows its entries quickly.
+static void EXTBenchmarkKernels(NSMutableArray *results) {
+    int characteristics[] = {0, 2, 3}, densities[] = {50, 5, 1};
+
+    for (int c = 0; c < 3; c++)
+    for (int d = 0; d < 3; d++) {
+        int characteristic = characteristics[c], density = densities[d];
+        NSArray *sizes = characteristic ? @[@16, @64, @256] : @[@16, @48];
+
+        for (NSNumber *size in sizes) {
+            int n = size.intValue;
+            NSDictionary *parameters = @{@"characteristic": @(characteristic),
+                                         @"density": @(density),
+                                         @"width": @(n), @"height": @(n)};
+
+            EXTMatrix *left = EXTRandomMatrix(n, n, characteristic, density),
+                      *right = EXTRandomMatrix(n, n, characteristic, density),
+                      *narrow = EXTRandomMatrix(n/2, n, characteristic, density);
+
+            EXTRunBenchmark(results, @"newMultiply", parameters, ^{
+                [EXTMatrix newMultiply:left by:right];
+            });
+            EXTRunBenchmark(results, @"columnReduce", parameters, ^{
+                [left columnReduce];
+            });
+            EXTRunBenchmark(results, @"kernel", parameters, ^{
+                [left kernel];
+            });
+            EXTRunBenchmark(results, @"image", parameters, ^{
+                [left image];
+            });
+            EXTRunBenchmark(results, @"formIntersection", parameters, ^{
+                [EXTMatrix formIntersection:left with:narrow];
+            });
+
+            // B is a random subspace of the random subspace Z.
+            EXTMatrix *Z = [narrow image];
+            EXTMatrix *B = [[EXTMatrix newMultiply:Z
+                                                by:EXTRandomMatrix(MAX(1, (int)Z.width/2), (int)Z.width, characteristic, 50)] image];
+            EXTRunBenchmark(results, @"findOrdersOf", parameters, ^{
+                [EXTMatrix findOrdersOf:B in:Z];
+            });
+
+            // the map, given on four complementary pieces of its source.
+            NSMutableArray *partials = [NSMutableArray array];
+            for (int piece = 0; piece < 4; piece++) {
+                EXTPartialDefinition *partial = [EXTPartialDefinition new];
+                partial.inclusion = [EXTMatrix includeEvenlySpacedBasis:n/4
+                                                                 endDim:n
+                                                                 offset:piece
+                                                                spacing:4];
+                partial.inclusion.characteristic = characteristic;
+                partial.action = [EXTMatrix newMultiply:left
+                                                     by:partial.inclusion];
+                [partials addObject:partial];
+            }
+            EXTRunBenchmark(results, @"assemblePresentation", parameters, ^{
+                [EXTMatrix assemblePresentation:[partials mutableCopy]
+                                sourceDimension:n
+                                targetDimension:n];
+            });
+
+            // hadamardProduct defers its work, so ask for the entries.
+            EXTMatrix *factor = EXTRandomMatrix(n/8, n/8, characteristic,
+                                                density),
+                      *tile = EXTRandomMatrix(8, 8, characteristic, 50);
+            EXTRunBenchmark(results, @"hadamardProduct", parameters, ^{
+                [[EXTMatrix hadamardProduct:factor with:tile] presentation];
+            });
+        }
+    }
+}
+
+#pragma mark - dense products
+
+// EXTDenseMultiply by itself, on the large square operands mod 7 where its
+// blocking and vector paths matter, once for each path the machine has.  the
+// largest sizes take seconds a call on the scalar path, so --filter is handy.
+static void EXTBenchmarkDenseProducts(NSMutableArray *results) {
+    const int characteristic = 7, sizes[] = {256, 512, 1024, 2048};
+    const EXTDenseMultiplyPath paths[] = {EXTDenseMultiplyScalar,
+                                          EXTDenseMultiplySSE41,
+                                          EXTDenseMultiplyAVX2,
+                                          EXTDenseMultiplyNEON};
+    NSArray *pathNames = @[@"scalar", @"sse4.1", @"avx2", @"neon"];
+    EXTDenseMultiplyPath preferred = EXTDenseMultiplyPreferredPath();
+
+    for (int s = 0; s < 4; s++) {
+        int n = sizes[s];
+        EXTMatrix *left = EXTRandomMatrix(n, n, characteristic, 50),
+                  *right = EXTRandomMatrix(n, n, characteristic, 50),
+                  *product = [EXTMatrix matrixWidth:n height:n];
+        const int *leftData = left.presentation.mutableBytes,
+                  *rightData = right.presentation.mutableBytes;
+        int *productData = product.presentation.mutableBytes;
+
+        for (int p = 0; p < 4; p++) {
+            if (!EXTDenseMultiplySetPath(paths[p]))
+                continue;
+
+            NSDictionary *parameters = @{@"characteristic": @(characteristic),
+                                         @"path": pathNames[p],
+                                         @"width": @(n), @"height": @(n)};
+            EXTRunBenchmark(results, @"denseMultiply", parameters, ^{
+                EXTDenseMultiply(leftData, rightData, productData,
+                                 n, n, n, characteristic);
+            });
+        }
+    }
+
+    EXTDenseMultiplySetPath(preferred);
+}
+
+#pragma mark - leibniz
+
+// the shapes -[EXTMultiplicationTables computeLeibniz:with:onPage:] pushes
+// through when the differential on A vanishes: from the differential cospan
+// B <-< J --> Y and the multiplication cospan A|Y <-< K --> Z, it tensors up to
+// A|B <-< A|J --> A|Y, pulls back along K, and composes.  the sizes are those
+// of terms in the polynomial spectral sequences, where J is most of B, K is
+// most of A|Y, and the products land in a term of comparable size.
+static void EXTBenchmarkLeibniz(NSMutableArray *results) {
+    int characteristics[] = {2, 3};
+    int termSizes[] = {4, 12, 24};
+
+    for (int c = 0; c < 2; c++)
+    for (int s = 0; s < 3; s++) {
+        int characteristic = characteristics[c], a = termSizes[s],
+            b = termSizes[s], y = termSizes[s], z = termSizes[s] * 2,
+            jWidth = MAX(1, b - b/4), kWidth = MAX(1, a*y - a*y/4);
+        NSDictionary *parameters = @{@"characteristic": @(characteristic),
+                                     @"termSize": @(termSizes[s])};
+
+        EXTMatrix *j = [EXTRandomMatrix(jWidth, b, characteristic, 30) image],
+                  *partialJ = EXTRandomMatrix((int)j.width, y, characteristic, 30),
+                  *k = [EXTRandomMatrix(kWidth, a*y, characteristic, 5) image],
+                  *muK = EXTRandomMatrix((int)k.width, z, characteristic, 20),
+                  *identity = EXTIdentity(a, characteristic);
+
+        EXTRunBenchmark(results, @"leibniz/tensor", parameters, ^{
+            [[EXTMatrix hadamardProduct:identity with:partialJ] presentation];
+        });
+
+        EXTMatrix *tensored = [EXTMatrix hadamardProduct:identity
+                                                    with:partialJ];
+        EXTRunBenchmark(results, @"leibniz/pullback", parameters, ^{
+            [EXTMatrix formIntersection:tensored with:k];
+        });
+
+        EXTRunBenchmark(results, @"leibniz/step", parameters, ^{
+            EXTMatrix
+                *Idj = [EXTMatrix hadamardProduct:identity with:j],
+                *IdpartialJ = [EXTMatrix hadamardProduct:identity with:partialJ];
+            NSArray *AYspan = [EXTMatrix formIntersection:IdpartialJ with:k];
+            [EXTMatrix newMultiply:Idj by:AYspan[0]];
+            [EXTMatrix newMultiply:muK by:AYspan[1]];
+        });
+    }
+}
+
+#pragma mark -
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        NSString *label = @"";
+
+        for (int i = 1; i < argc; i++) {
+            if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+                EXTBenchmarkMinTime = atof(argv[++i]);
+            else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+                EXTBenchmarkFilter = argv[++i];
+            else if (!strcmp(argv[i], "--label") && i + 1 < argc)
+                label = @(argv[++i]);
+            else {
+                fprintf(stderr, "usage: %s [--min-time seconds] "
+                                "[--filter substring] [--label text]\n",
+                        argv[0]);
+                return 1;
+            }
+        }
+
+        srandom(1729);
+
+        NSMutableArray *results = [NSMutableArray array];
+        EXTBenchmarkKernels(results);
+        EXTBenchmarkDenseProducts(results);
+        EXTBenchmarkLeibniz(results);
+
+        NSDictionary *report = @{@"label": label,
+                                 @"minTime": @(EXTBenchmarkMinTime),
+                                 @"benchmarks": results};
+        NSData *json = [NSJSONSerialization dataWithJSONObject:report
+                                                       options:NSJSONWritingPrettyPrinted
+                                                         error:NULL];
+        fwrite(json.bytes, 1, json.length, stdout);
+        fputc('\n', stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+//
+//  EXTBitMatrix.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// a bit-packed matrix over F_2.  like EXTMatrix, this is stored as a list of
+// column vectors: column i occupies the wordsPerColumn 64-bit words starting
+// at words[i*wordsPerColumn], and row j of that column lives in bit (j % 64)
+// of word (j / 64).  bits past the height of a column are always kept zero, so
+// that whole-word XORs and comparisons can ignore the ragged edge.
+//
+// EXTMatrix converts to and from this whenever it's asked to do linear algebra
+// in characteristic 2; callers shouldn't usually need to touch it directly.
+typedef struct {
+    int width, height;
+    int wordsPerColumn;
+    uint64_t *words;
+} EXTBitMatrix;
+
+// above this many columns on both sides of a product, EXTBitMatrixMultiply
+// switches to the table-driven "method of four russians" path.
+#define EXT_BIT_MATRIX_M4RM_THRESHOLD 64
+
+EXTBitMatrix EXTBitMatrixCreate(int width, int height);
+EXTBitMatrix EXTBitMatrixCreateIdentity(int width);
+EXTBitMatrix EXTBitMatrixCopy(const EXTBitMatrix *matrix);
+void EXTBitMatrixFree(EXTBitMatrix *matrix);
+
+/// packs the columns of an int-valued, column-major matrix of the given height
+/// into the columns firstColumn, firstColumn+1, ... of matrix, keeping parity.
+void EXTBitMatrixSetColumns(EXTBitMatrix *matrix, int firstColumn,
+                            const int *data, int width, int height);
+EXTBitMatrix EXTBitMatrixFromInts(const int *data, int width, int height);
+/// unpacks rows [firstRow, firstRow + rowCount) of every column into data,
+/// column-major with height rowCount.
+void EXTBitMatrixGetRows(const EXTBitMatrix *matrix, int firstRow,
+                         int rowCount, int *data);
+
+static inline uint64_t *EXTBitMatrixColumn(const EXTBitMatrix *matrix,
+                                           int column) {
+    return matrix->words + (size_t)column * matrix->wordsPerColumn;
+}
+
+static inline bool EXTBitMatrixGet(const EXTBitMatrix *matrix,
+                                   int column, int row) {
+    return (EXTBitMatrixColumn(matrix, column)[row >> 6] >> (row & 63)) & 1;
+}
+
+static inline void EXTBitMatrixFlip(EXTBitMatrix *matrix, int column, int row) {
+    EXTBitMatrixColumn(matrix, column)[row >> 6] ^= (1ULL << (row & 63));
+}
+
+bool EXTBitMatrixColumnIsZero(const EXTBitMatrix *matrix, int column);
+
+EXTBitMatrix EXTBitMatrixMultiply(const EXTBitMatrix *left,
+                                  const EXTBitMatrix *right);
+/// the kronecker product, laid out the same way as +[EXTMatrix hadamardProduct:with:]
+EXTBitMatrix EXTBitMatrixKronecker(const EXTBitMatrix *left,
+                                   const EXTBitMatrix *right);
+
+/// gauss-jordan column reduction of the rows [0, limit), in place.  if
+/// transform is non-NULL, the same column operations are applied to it.  if
+/// pivotColumns is non-NULL, it receives (for each row < limit) the column
+/// which was used as that row's pivot, or -1.  returns the number of pivots.
+int EXTBitMatrixColumnReduce(EXTBitMatrix *matrix, EXTBitMatrix *transform,
+                             int limit, int *pivotColumns);
+/// a basis for the kernel of the matrix.
+EXTBitMatrix EXTBitMatrixKernel(const EXTBitMatrix *matrix);
+/// a basis for the image of the matrix.
+EXTBitMatrix EXTBitMatrixImage(const EXTBitMatrix *matrix);
@@ -0,0 +1,301 @@
+//
+//  EXTBitMatrix.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTBitMatrix.h"
+#import "EXTScratch.h"
+
+EXTBitMatrix EXTBitMatrixCreate(int width, int height) {
+    EXTBitMatrix ret;
+
+    ret.width = width;
+    ret.height = height;
+    ret.wordsPerColumn = (height + 63) / 64;
+    ret.words = calloc((size_t)width * ret.wordsPerColumn + 1, sizeof(uint64_t));
+    EXTCountHeapAllocation(sizeof(uint64_t) * width * ret.wordsPerColumn);
+
+    return ret;
+}
+
+EXTBitMatrix EXTBitMatrixCreateIdentity(int width) {
+    EXTBitMatrix ret = EXTBitMatrixCreate(width, width);
+
+    for (int i = 0; i < width; i++)
+        EXTBitMatrixFlip(&ret, i, i);
+
+    return ret;
+}
+
+EXTBitMatrix EXTBitMatrixCopy(const EXTBitMatrix *matrix) {
+    EXTBitMatrix ret = EXTBitMatrixCreate(matrix->width, matrix->height);
+
+    memcpy(ret.words, matrix->words,
+           sizeof(uint64_t) * matrix->width * matrix->wordsPerColumn);
+
+    return ret;
+}
+
+void EXTBitMatrixFree(EXTBitMatrix *matrix) {
+    free(matrix->words);
+    matrix->words = NULL;
+    matrix->width = matrix->height = matrix->wordsPerColumn = 0;
+}
+
+void EXTBitMatrixSetColumns(EXTBitMatrix *matrix, int firstColumn,
+                            const int *data, int width, int height) {
+    for (int i = 0; i < width; i++) {
+        uint64_t *column = EXTBitMatrixColumn(matrix, firstColumn + i);
+        const int *source = data + (size_t)i * height;
+
+        // negative entries are fine: two's complement keeps the parity bit.
+        for (int j = 0; j < height; j++)
+            column[j >> 6] |= ((uint64_t)(source[j] & 1)) << (j & 63);
+    }
+}
+
+EXTBitMatrix EXTBitMatrixFromInts(const int *data, int width, int height) {
+    EXTBitMatrix ret = EXTBitMatrixCreate(width, height);
+
+    EXTBitMatrixSetColumns(&ret, 0, data, width, height);
+
+    return ret;
+}
+
+void EXTBitMatrixGetRows(const EXTBitMatrix *matrix, int firstRow,
+                         int rowCount, int *data) {
+    for (int i = 0; i < matrix->width; i++) {
+        const uint64_t *column = EXTBitMatrixColumn(matrix, i);
+        int *target = data + (size_t)i * rowCount;
+
+        for (int j = 0; j < rowCount; j++) {
+            int row = firstRow + j;
+            target[j] = (int)((column[row >> 6] >> (row & 63)) & 1);
+        }
+    }
+}
+
+bool EXTBitMatrixColumnIsZero(const EXTBitMatrix *matrix, int column) {
+    const uint64_t *words = EXTBitMatrixColumn(matrix, column);
+
+    for (int w = 0; w < matrix->wordsPerColumn; w++)
+        if (words[w])
+            return false;
+
+    return true;
+}
+
+static inline void EXTBitColumnXor(uint64_t *target, const uint64_t *source,
+                                   int words) {
+    for (int w = 0; w < words; w++)
+        target[w] ^= source[w];
+}
+
+#pragma mark - products
+
+// the product is assembled one column at a time: column k of left * right is
+// the sum of those columns of left picked out by the bits of right's column k.
+static void EXTBitMatrixMultiplyNaive(const EXTBitMatrix *left,
+                                      const EXTBitMatrix *right,
+                                      EXTBitMatrix *product) {
+    for (int k = 0; k < right->width; k++) {
+        uint64_t *target = EXTBitMatrixColumn(product, k);
+        const uint64_t *selector = EXTBitMatrixColumn(right, k);
+
+        for (int w = 0; w < right->wordsPerColumn; w++) {
+            uint64_t bits = selector[w];
+
+            while (bits) {
+                int j = w*64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                EXTBitColumnXor(target, EXTBitMatrixColumn(left, j),
+                                product->wordsPerColumn);
+            }
+        }
+    }
+}
+
+// the "method of four russians": chop the columns of left into strips of
+// eight, tabulate all 256 sums of columns within a strip, and then each byte
+// of a column of right selects a single precomputed sum.
+static void EXTBitMatrixMultiplyM4RM(const EXTBitMatrix *left,
+                                     const EXTBitMatrix *right,
+                                     EXTBitMatrix *product) {
+    int words = product->wordsPerColumn;
+    EXTScratchMark mark = EXTScratchSave();
+    uint64_t *table = EXTScratchCalloc((size_t)256 * words + 1, sizeof(uint64_t));
+
+    for (int strip = 0; strip < left->width; strip += 8) {
+        int span = MIN(8, left->width - strip);
+        unsigned mask = (1u << span) - 1;
+
+        // table[i] = table[i without its lowest bit] + that lowest column.
+        for (unsigned i = 1; i <= mask; i++) {
+            uint64_t *entry = table + (size_t)i * words;
+            const uint64_t *previous = table + (size_t)(i & (i - 1)) * words,
+                           *column = EXTBitMatrixColumn(left, strip + __builtin_ctz(i));
+
+            for (int w = 0; w < words; w++)
+                entry[w] = previous[w] ^ column[w];
+        }
+
+        for (int k = 0; k < right->width; k++) {
+            unsigned selector = (unsigned)(EXTBitMatrixColumn(right, k)[strip >> 6] >> (strip & 63)) & mask;
+
+            if (selector)
+                EXTBitColumnXor(EXTBitMatrixColumn(product, k),
+                                table + (size_t)selector * words, words);
+        }
+    }
+
+    EXTScratchRestore(mark);
+}
+
+EXTBitMatrix EXTBitMatrixMultiply(const EXTBitMatrix *left,
+                                  const EXTBitMatrix *right) {
+    EXTBitMatrix product = EXTBitMatrixCreate(right->width, left->height);
+
+    if (left->width >= EXT_BIT_MATRIX_M4RM_THRESHOLD &&
+        right->width >= EXT_BIT_MATRIX_M4RM_THRESHOLD)
+        EXTBitMatrixMultiplyM4RM(left, right, &product);
+    else
+        EXTBitMatrixMultiplyNaive(left, right, &product);
+
+    return product;
+}
+
+// ORs the first bitCount bits of source into target, starting at bit offset.
+static void EXTBitColumnOrAtOffset(uint64_t *target, int targetWords,
+                                   const uint64_t *source, int bitCount,
+                                   int offset) {
+    int shift = offset & 63, base = offset >> 6;
+
+    for (int w = 0; w < (bitCount + 63) / 64; w++) {
+        uint64_t value = source[w];
+        if (!value)
+            continue;
+
+        target[base + w] |= value << shift;
+        if (shift && base + w + 1 < targetWords)
+            target[base + w + 1] |= value >> (64 - shift);
+    }
+}
+
+EXTBitMatrix EXTBitMatrixKronecker(const EXTBitMatrix *left,
+                                   const EXTBitMatrix *right) {
+    EXTBitMatrix ret = EXTBitMatrixCreate(left->width * right->width,
+                                          left->height * right->height);
+
+    for (int i = 0; i < left->width; i++)
+        for (int k = 0; k < left->height; k++) {
+            if (!EXTBitMatrixGet(left, i, k))
+                continue;
+
+            for (int j = 0; j < right->width; j++)
+                EXTBitColumnOrAtOffset(EXTBitMatrixColumn(&ret, i*right->width + j),
+                                       ret.wordsPerColumn,
+                                       EXTBitMatrixColumn(right, j),
+                                       right->height,
+                                       k*right->height);
+        }
+
+    return ret;
+}
+
+#pragma mark - elimination
+
+int EXTBitMatrixColumnReduce(EXTBitMatrix *matrix, EXTBitMatrix *transform,
+                             int limit, int *pivotColumns) {
+    int rank = 0;
+    EXTScratchMark mark = EXTScratchSave();
+    bool *usedColumns = EXTScratchCalloc(matrix->width + 1, sizeof(bool));
+
+    limit = MIN(limit, matrix->height);
+
+    for (int pivotRow = 0; pivotRow < limit; pivotRow++) {
+        int word = pivotRow >> 6, pivotColumn = -1;
+        uint64_t bit = 1ULL << (pivotRow & 63);
+
+        if (pivotColumns)
+            pivotColumns[pivotRow] = -1;
+
+        for (int i = 0; i < matrix->width; i++)
+            if (!usedColumns[i] && (EXTBitMatrixColumn(matrix, i)[word] & bit)) {
+                pivotColumn = i;
+                break;
+            }
+
+        if (pivotColumn == -1)
+            continue;
+
+        usedColumns[pivotColumn] = true;
+        if (pivotColumns)
+            pivotColumns[pivotRow] = pivotColumn;
+        rank++;
+
+        // clear this row out of every other column, used or not.
+        const uint64_t *pivot = EXTBitMatrixColumn(matrix, pivotColumn);
+        for (int i = 0; i < matrix->width; i++) {
+            if (i == pivotColumn ||
+                !(EXTBitMatrixColumn(matrix, i)[word] & bit))
+                continue;
+
+            EXTBitColumnXor(EXTBitMatrixColumn(matrix, i), pivot,
+                            matrix->wordsPerColumn);
+            if (transform)
+                EXTBitColumnXor(EXTBitMatrixColumn(transform, i),
+                                EXTBitMatrixColumn(transform, pivotColumn),
+                                transform->wordsPerColumn);
+        }
+    }
+
+    EXTScratchRestore(mark);
+
+    return rank;
+}
+
+EXTBitMatrix EXTBitMatrixKernel(const EXTBitMatrix *matrix) {
+    EXTBitMatrix reduced = EXTBitMatrixCopy(matrix),
+                 transform = EXTBitMatrixCreateIdentity(matrix->width);
+
+    int rank = EXTBitMatrixColumnReduce(&reduced, &transform,
+                                        matrix->height, NULL);
+
+    // the columns which reduced to zero record the relations we're after.
+    EXTBitMatrix ret = EXTBitMatrixCreate(matrix->width - rank, matrix->width);
+    for (int i = 0, column = 0; i < reduced.width; i++) {
+        if (!EXTBitMatrixColumnIsZero(&reduced, i))
+            continue;
+
+        memcpy(EXTBitMatrixColumn(&ret, column++),
+               EXTBitMatrixColumn(&transform, i),
+               sizeof(uint64_t) * ret.wordsPerColumn);
+    }
+
+    EXTBitMatrixFree(&reduced);
+    EXTBitMatrixFree(&transform);
+
+    return ret;
+}
+
+EXTBitMatrix EXTBitMatrixImage(const EXTBitMatrix *matrix) {
+    EXTBitMatrix reduced = EXTBitMatrixCopy(matrix);
+
+    int rank = EXTBitMatrixColumnReduce(&reduced, NULL, matrix->height, NULL);
+
+    EXTBitMatrix ret = EXTBitMatrixCreate(rank, matrix->height);
+    for (int i = 0, column = 0; i < reduced.width; i++) {
+        if (EXTBitMatrixColumnIsZero(&reduced, i))
+            continue;
+
+        memcpy(EXTBitMatrixColumn(&ret, column++),
+               EXTBitMatrixColumn(&reduced, i),
+               sizeof(uint64_t) * ret.wordsPerColumn);
+    }
+
+    EXTBitMatrixFree(&reduced);
+
+    return ret;
+}
@@ -304,13 +304,7 @@ static void *_selectedToolTagContext = &_selectedToolTagContext;
 
 - (NSArray *)chartView:(EXTChartView *)chartView termCellsInGridRect:(EXTIntRect)gridRect
 {
-    NSMutableArray *result = [NSMutableArray new];
-    for (EXTChartViewModelTermCell *termCell in self.chartViewModel.termCells) {
-        if (EXTIntPointInRect(termCell.gridLocation, gridRect)) {
-            [result addObject:termCell];
-        }
-    }
-    return [result copy];
+    return [self.chartViewModel termCellsInGridRect:gridRect];
 }
 
 - (NSArray *)chartView:(EXTChartView *)chartView differentialsInGridRect:(EXTIntRect)gridRect
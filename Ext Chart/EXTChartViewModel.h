@@ -6,10 +6,10 @@
 //  Copyright (c) 2014 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTChartInteractionType.h"
-#import "EXTDocument.h"
+#import "EXTUtilities.h"
 
 @class EXTSpectralSequence;
 @class EXTTerm;
@@ -51,6 +51,8 @@
 - (EXTChartViewModelTerm *)viewModelTermForModelTerm:(EXTTerm *)term;
 - (EXTChartViewModelDifferential *)viewModelDifferentialForModelDifferential:(EXTDifferential *)differential;
 - (EXTChartViewModelTermCell *)termCellAtGridLocation:(EXTIntPoint)gridLocation;
+/// The term cells on the current page whose grid locations lie in gridRect.
+- (NSArray *)termCellsInGridRect:(EXTIntRect)gridRect;
 @end
 
 
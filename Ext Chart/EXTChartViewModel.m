@@ -8,10 +8,10 @@
 
 #import "EXTChartViewModel.h"
 #import "EXTSpectralSequence.h"
-#import "EXTGrid.h"
 #import "EXTTerm.h"
 #import "EXTDifferential.h"
 #import "EXTPolynomialSSeq.h"
+#import "EXTGridIndex.h"
 #import "NSValue+EXTIntPoint.h"
 
 
@@ -21,6 +21,9 @@
 /// Indexed by @(page). Each element is a dictionary mapping an NSValue-wrapped EXTIntPoint to an EXTChartViewModelTermCell object at that grid location.
 @property (nonatomic, strong) NSMutableDictionary *privateTermCells;
 
+/// Indexed by @(page). Each element is an EXTGridIndex of the EXTChartViewModelTermCell objects in privateTermCells.
+@property (nonatomic, strong) NSMutableDictionary *termCellIndices;
+
 /// Indexed by @(page). Each element is an NSMutableArray of EXTChartViewModelDifferential objects.
 @property (nonatomic, strong) NSMutableDictionary *privateDifferentials;
 
@@ -111,6 +114,7 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
     self = [super init];
     if (self) {
         _privateTermCells = [NSMutableDictionary new];
+        _termCellIndices = [NSMutableDictionary new];
         _privateDifferentials = [NSMutableDictionary new];
         _privateMultAnnotations = [NSMutableDictionary new];
         _modelToViewModelTermMap = [NSMutableDictionary new];
@@ -143,7 +147,7 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
         const EXTIntPoint gridLocation = [self.sequence.locConvertor gridPoint:term.location];
         NSValue *gridLocationValue = [NSValue extValueWithIntPoint:gridLocation];
         EXTChartViewModelTerm *viewModelTerm = [EXTChartViewModelTerm viewModelTermWithModelTerm:term
-                                                                               modelHomologyReps:term.homologyReps[self.currentPage]
+                                                                               modelHomologyReps:[term homologyRepsForPage:self.currentPage]
                                                                                         sequence:self.sequence];
         EXTChartViewModelTermCell *termCell = termCells[gridLocationValue];
         if (!termCell) {
@@ -159,7 +163,11 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
 
     // --- Term cells
 
-    for (EXTChartViewModelTermCell *termCell in termCells.allValues) [termCell sortTerms];
+    EXTGridIndex *termCellIndex = [EXTGridIndex new];
+    for (EXTChartViewModelTermCell *termCell in termCells.allValues) {
+        [termCell sortTerms];
+        [termCellIndex addObject:termCell atPoint:termCell.gridLocation];
+    }
 
     // --- Differentials
     NSMutableArray *differentials = [NSMutableArray new];
@@ -224,6 +232,12 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
         
         NSMutableArray *annotationArray = [NSMutableArray new];
         
+        // assemble every product this rule is about to ask for in one go.
+        NSMutableArray *productPairs = [NSMutableArray array];
+        for (EXTLocation *location in self.sequence.terms.allKeys)
+            [productPairs addObject:@[location, rule[@"location"]]];
+        [self.sequence prepareProductsForPairs:productPairs];
+        
         for (EXTTerm *term in self.sequence.terms.allValues) {
             // otherwise, draw something.
             EXTChartViewModelTerm *startTerm = [modelToViewModelTermMap objectForKey:term.location];
@@ -262,6 +276,7 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
     }
 
     self.privateTermCells[@(self.currentPage)] = termCells;
+    self.termCellIndices[@(self.currentPage)] = termCellIndex;
     self.privateDifferentials[@(self.currentPage)] = differentials;
     self.privateMultAnnotations[@(self.currentPage)] = annotationPairs;
     self.modelToViewModelTermMap[@(self.currentPage)] = modelToViewModelTermMap; // FIXME: Do we need to keep this?
@@ -283,14 +298,12 @@ static NSComparisonResult(^hRepsComparator)(EXTChartViewModelTermHomologyReps *,
 
 - (EXTChartViewModelTermCell *)termCellAtGridLocation:(EXTIntPoint)gridLocation
 {
-    EXTChartViewModelTermCell *result = nil;
-    for (EXTChartViewModelTermCell *termCell in [self.privateTermCells[@(self.currentPage)] allValues]) {
-        if (EXTEqualIntPoints(termCell.gridLocation, gridLocation)) {
-            result = termCell;
-            break;
-        }
-    }
-    return result;
+    return self.privateTermCells[@(self.currentPage)][[NSValue extValueWithIntPoint:gridLocation]];
+}
+
+- (NSArray *)termCellsInGridRect:(EXTIntRect)gridRect
+{
+    return [self.termCellIndices[@(self.currentPage)] objectsInRect:gridRect];
 }
 
 #pragma mark - Computed properties
@@ -0,0 +1,56 @@
+//
+//  EXTChunkedArchive.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "EXTSpectralSequence.h"
+
+// the document format from version 8 on.  a file is a short header followed by
+// a run of chunks, each of which is a type, some flags and a length, and then
+// that many bytes of payload, padded out to a multiple of 8.  the bulk of a
+// spectral sequence (the terms, the differentials page by page, and the
+// multiplication entries) is written out by hand, with matrices as their raw
+// entries; everything else about it goes in one small keyed archive.
+//
+// readers skip chunks of a type they don't know, so new ones can be added
+// without moving the version.  numbers are stored in the byte order of the
+// machine, which is little-endian everywhere we run.
+typedef NS_ENUM(uint32_t, EXTChunkType) {
+    EXTChunkTypeSSeq = 1,               // keyed archive of what's left over
+    EXTChunkTypeTerms = 2,
+    EXTChunkTypeDifferentials = 3,      // one chunk per page
+    EXTChunkTypeMultiplications = 4,
+    EXTChunkTypeDocument = 5,           // for whoever holds the sseq
+};
+
+@interface EXTChunkedArchive : NSObject
+
++(BOOL) isChunkedArchive:(NSData*)data;
+
+// an archive to append chunks to.  with compress set, a chunk's payload is
+// stored through zlib whenever that makes it smaller.
+-(instancetype) initForWritingCompressed:(BOOL)compress;
+-(void) appendChunk:(EXTChunkType)type payload:(NSData*)payload;
+// the archive as it stands.
+@property(readonly) NSData *data;
+
+// reads only the chunk headers; the payloads are left where they are until
+// they're asked for, so data is best mapped in from the file.
+-(instancetype) initForReadingWithData:(NSData*)data error:(NSError**)error;
+-(NSIndexSet*) indexesOfChunksOfType:(EXTChunkType)type;
+// nil if the chunk is damaged.
+-(NSData*) payloadOfChunkAtIndex:(NSUInteger)index;
+
+@end
+
+@interface EXTSpectralSequence (EXTChunkedArchive)
+
+-(void) writeToChunkedArchive:(EXTChunkedArchive*)archive;
++(EXTSpectralSequence*) sSeqFromChunkedArchive:(EXTChunkedArchive*)archive
+                                         error:(NSError**)error;
+
+@end
@@ -0,0 +1,627 @@
+//
+//  EXTChunkedArchive.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTChunkedArchive.h"
+#import "EXTTerm.h"
+#import "EXTDifferential.h"
+#import "EXTMultiplicationTables.h"
+#import "EXTPolynomialSSeq.h"
+
+#include <zlib.h>
+
+#define EXT_CHUNKED_ARCHIVE_VERSION 8
+
+static const char EXTChunkedArchiveMagic[8] = {'E','x','t','C','h','a','r','t'};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} EXTChunkedArchiveHeader;
+
+typedef struct {
+    uint32_t type;
+    uint32_t flags;
+    uint64_t length;        // of the payload as stored, which follows directly
+} EXTChunkHeader;
+
+enum {
+    // the payload is a uint64_t giving its inflated length, then a zlib stream.
+    EXTChunkCompressed = 1 << 0,
+};
+
+static NSError *EXTChunkedArchiveError(NSString *description) {
+    return [NSError errorWithDomain:@"edu.harvard.math.ext-chart"
+                               code:(-1)
+                           userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+@implementation EXTChunkedArchive {
+    NSMutableData *written;
+    BOOL compress;
+
+    NSData *read;
+    NSMutableArray *chunks;     // of @[@(type), @(flags), @(offset), @(length)]
+}
+
++(BOOL) isChunkedArchive:(NSData*)data {
+    return data.length >= sizeof(EXTChunkedArchiveHeader) &&
+           !memcmp(data.bytes, EXTChunkedArchiveMagic,
+                   sizeof(EXTChunkedArchiveMagic));
+}
+
+#pragma mark - writing
+
+-(instancetype) initForWritingCompressed:(BOOL)shouldCompress {
+    if (self = [super init]) {
+        compress = shouldCompress;
+        written = [NSMutableData data];
+
+        EXTChunkedArchiveHeader header = {{0}, EXT_CHUNKED_ARCHIVE_VERSION, 0};
+        memcpy(header.magic, EXTChunkedArchiveMagic, sizeof(header.magic));
+        [written appendBytes:&header length:sizeof(header)];
+    }
+
+    return self;
+}
+
+-(void) appendChunk:(EXTChunkType)type payload:(NSData*)payload {
+    EXTChunkHeader header = {type, 0, payload.length};
+    NSData *stored = payload;
+
+    if (compress && payload.length > 0) {
+        uLongf deflatedLength = compressBound((uLong)payload.length);
+        NSMutableData *deflated =
+            [NSMutableData dataWithLength:sizeof(uint64_t) + deflatedLength];
+        uint64_t inflatedLength = payload.length;
+        memcpy(deflated.mutableBytes, &inflatedLength, sizeof(inflatedLength));
+
+        if (compress2((Bytef*)deflated.mutableBytes + sizeof(uint64_t),
+                      &deflatedLength, payload.bytes, (uLong)payload.length,
+                      Z_DEFAULT_COMPRESSION) == Z_OK &&
+            sizeof(uint64_t) + deflatedLength < payload.length) {
+            deflated.length = sizeof(uint64_t) + deflatedLength;
+            stored = deflated;
+            header.flags |= EXTChunkCompressed;
+            header.length = deflated.length;
+        }
+    }
+
+    static const char padding[8] = {0};
+    [written appendBytes:&header length:sizeof(header)];
+    [written appendData:stored];
+    [written appendBytes:padding length:(8 - stored.length % 8) % 8];
+}
+
+-(NSData*) data {
+    return written ? written : read;
+}
+
+#pragma mark - reading
+
+-(instancetype) initForReadingWithData:(NSData*)data error:(NSError**)error {
+    if (!(self = [super init]))
+        return nil;
+
+    if (![EXTChunkedArchive isChunkedArchive:data]) {
+        if (error)
+            *error = EXTChunkedArchiveError(@"This isn't an Ext Chart document.");
+        return nil;
+    }
+
+    EXTChunkedArchiveHeader header;
+    memcpy(&header, data.bytes, sizeof(header));
+    if (header.version > EXT_CHUNKED_ARCHIVE_VERSION) {
+        if (error)
+            *error = EXTChunkedArchiveError(@"This document was saved by a newer version of Ext Chart.");
+        return nil;
+    }
+
+    read = data;
+    chunks = [NSMutableArray array];
+
+    uint64_t position = sizeof(header);
+    while (position + sizeof(EXTChunkHeader) <= data.length) {
+        EXTChunkHeader chunk;
+        memcpy(&chunk, (const char*)data.bytes + position, sizeof(chunk));
+        position += sizeof(chunk);
+
+        if (chunk.length > data.length - position) {
+            if (error)
+                *error = EXTChunkedArchiveError(@"This document is truncated.");
+            return nil;
+        }
+
+        [chunks addObject:@[@(chunk.type), @(chunk.flags), @(position),
+                            @(chunk.length)]];
+        position += chunk.length + (8 - chunk.length % 8) % 8;
+    }
+
+    return self;
+}
+
+-(NSIndexSet*) indexesOfChunksOfType:(EXTChunkType)type {
+    return [chunks indexesOfObjectsPassingTest:
+                ^BOOL(NSArray *chunk, NSUInteger idx, BOOL *stop) {
+                    return [chunk[0] unsignedIntValue] == type;
+                }];
+}
+
+-(NSData*) payloadOfChunkAtIndex:(NSUInteger)index {
+    NSArray *chunk = chunks[index];
+    uint32_t flags = [chunk[1] unsignedIntValue];
+    uint64_t offset = [chunk[2] unsignedLongLongValue],
+             length = [chunk[3] unsignedLongLongValue];
+
+    // this points into data rather than copying out of it.
+    NSData *stored = [NSData dataWithBytesNoCopy:(char*)read.bytes + offset
+                                          length:(NSUInteger)length
+                                    freeWhenDone:NO];
+    if (!(flags & EXTChunkCompressed))
+        return stored;
+
+    uint64_t inflatedLength;
+    if (length < sizeof(inflatedLength))
+        return nil;
+    memcpy(&inflatedLength, stored.bytes, sizeof(inflatedLength));
+
+    NSMutableData *inflated = [NSMutableData dataWithLength:(NSUInteger)inflatedLength];
+    uLongf actualLength = (uLongf)inflatedLength;
+    if (uncompress(inflated.mutableBytes, &actualLength,
+                   (const Bytef*)stored.bytes + sizeof(inflatedLength),
+                   (uLong)(length - sizeof(inflatedLength))) != Z_OK ||
+        actualLength != inflatedLength)
+        return nil;
+
+    return inflated;
+}
+
+@end
+
+#pragma mark - payloads
+
+// the pieces the payloads are built out of.  a nil object is written as a
+// count or a width of -1.
+
+static void EXTPutInt(NSMutableData *data, int32_t value) {
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void EXTPutString(NSMutableData *data, NSString *string) {
+    if (!string) {
+        EXTPutInt(data, -1);
+        return;
+    }
+
+    NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+    EXTPutInt(data, (int32_t)utf8.length);
+    [data appendData:utf8];
+}
+
+static void EXTPutMatrix(NSMutableData *data, EXTMatrix *matrix) {
+    if (!matrix) {
+        EXTPutInt(data, -1);
+        return;
+    }
+
+    int32_t shape[3] = {(int32_t)matrix.width, (int32_t)matrix.height,
+                        (int32_t)matrix.characteristic};
+    [data appendBytes:shape length:sizeof(shape)];
+    [data appendBytes:[matrix entries]
+               length:sizeof(int) * matrix.width * matrix.height];
+}
+
+static void EXTPutLocation(NSMutableData *data, EXTLocation *location,
+                           int rank) {
+    EXTGrading grading = location.grading;
+    [data appendBytes:grading.coordinates length:sizeof(int32_t) * rank];
+}
+
+static void EXTPutPartials(NSMutableData *data, NSArray *partials) {
+    EXTPutInt(data, (int32_t)partials.count);
+    for (EXTPartialDefinition *partial in partials) {
+        EXTPutInt(data, partial.automaticallyGenerated);
+        EXTPutString(data, partial.description);
+        EXTPutMatrix(data, partial.inclusion);
+        EXTPutMatrix(data, partial.action);
+    }
+}
+
+enum {
+    EXTNamesStrings = 0,
+    EXTNamesTags = 1,           // EXTPolynomialTags, as their exponents
+    EXTNamesArchived = 2,       // anything else, through NSKeyedArchiver
+};
+
+// generators are those of the polynomial spectral sequence being written, if
+// that's what it is.
+static void EXTPutNames(NSMutableData *data, NSArray *names,
+                        NSArray *generators) {
+    if (!names) {
+        EXTPutInt(data, -1);
+        return;
+    }
+
+    BOOL strings = YES, tags = (generators != nil);
+    for (id name in names) {
+        strings = strings && [name isKindOfClass:[NSString class]];
+        tags = tags && [name isKindOfClass:[EXTPolynomialTag class]] &&
+               ((EXTPolynomialTag*)name).generators == generators;
+    }
+
+    EXTPutInt(data, (int32_t)names.count);
+    if (strings) {
+        EXTPutInt(data, EXTNamesStrings);
+        for (NSString *name in names)
+            EXTPutString(data, name);
+    } else if (tags) {
+        EXTPutInt(data, EXTNamesTags);
+        for (EXTPolynomialTag *tag in names) {
+            EXTPutInt(data, tag.length);
+            for (int i = 0; i < tag.length; i++)
+                EXTPutInt(data, [tag exponentOf:i]);
+        }
+    } else {
+        EXTPutInt(data, EXTNamesArchived);
+        NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:names];
+        EXTPutInt(data, (int32_t)archive.length);
+        [data appendData:archive];
+    }
+}
+
+// reads run off the end of a payload at most once: after that, everything
+// comes back zero or nil, and failed is set.
+typedef struct {
+    const char *bytes;
+    size_t length, position;
+    BOOL failed;
+} EXTChunkCursor;
+
+static const void *EXTTake(EXTChunkCursor *cursor, size_t count) {
+    if (cursor->failed || count > cursor->length - cursor->position) {
+        cursor->failed = YES;
+        return NULL;
+    }
+
+    const void *ret = cursor->bytes + cursor->position;
+    cursor->position += count;
+
+    return ret;
+}
+
+static int32_t EXTGetInt(EXTChunkCursor *cursor) {
+    int32_t ret = 0;
+    const void *bytes = EXTTake(cursor, sizeof(ret));
+    if (bytes)
+        memcpy(&ret, bytes, sizeof(ret));
+
+    return ret;
+}
+
+static NSString *EXTGetString(EXTChunkCursor *cursor) {
+    int32_t length = EXTGetInt(cursor);
+    if (length < 0)
+        return nil;
+
+    const void *bytes = EXTTake(cursor, (size_t)length);
+    if (!bytes)
+        return nil;
+
+    return [[NSString alloc] initWithBytes:bytes
+                                    length:(NSUInteger)length
+                                  encoding:NSUTF8StringEncoding];
+}
+
+static EXTMatrix *EXTGetMatrix(EXTChunkCursor *cursor) {
+    int32_t width = EXTGetInt(cursor);
+    if (width < 0)
+        return nil;
+    int32_t height = EXTGetInt(cursor), characteristic = EXTGetInt(cursor);
+
+    size_t count = (size_t)width * (size_t)(height < 0 ? 0 : height);
+    const void *entries = (height < 0 || count > cursor->length / sizeof(int)) ?
+                          NULL : EXTTake(cursor, sizeof(int) * count);
+    if (!entries) {
+        cursor->failed = YES;
+        return nil;
+    }
+
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:height];
+    ret.characteristic = characteristic;
+    memcpy(ret.presentation.mutableBytes, entries, sizeof(int) * count);
+
+    return ret;
+}
+
+static EXTLocation *EXTGetLocation(EXTChunkCursor *cursor,
+                                   Class<EXTLocation> indexClass, int rank) {
+    const void *coordinates = EXTTake(cursor, sizeof(int32_t) * rank);
+    if (!coordinates)
+        return nil;
+
+    EXTGrading grading = EXTGradingMake(rank, coordinates);
+    return [indexClass locationWithGrading:grading];
+}
+
+static NSMutableArray *EXTGetPartials(EXTChunkCursor *cursor) {
+    int32_t count = EXTGetInt(cursor);
+    NSMutableArray *ret = [NSMutableArray array];
+
+    for (int32_t i = 0; i < count && !cursor->failed; i++) {
+        EXTPartialDefinition *partial = [EXTPartialDefinition new];
+        if (!EXTGetInt(cursor))
+            [partial manuallyGenerated];
+        partial.description = EXTGetString(cursor);
+        partial.inclusion = EXTGetMatrix(cursor);
+        partial.action = EXTGetMatrix(cursor);
+        [ret addObject:partial];
+    }
+
+    return ret;
+}
+
+static NSMutableArray *EXTGetNames(EXTChunkCursor *cursor,
+                                   NSArray *generators) {
+    int32_t count = EXTGetInt(cursor);
+    if (count < 0)
+        return nil;
+
+    int32_t kind = EXTGetInt(cursor);
+    if (kind == EXTNamesArchived) {
+        int32_t length = EXTGetInt(cursor);
+        const void *bytes = length < 0 ? NULL : EXTTake(cursor, (size_t)length);
+        if (!bytes) {
+            cursor->failed = YES;
+            return nil;
+        }
+
+        NSArray *names = [NSKeyedUnarchiver unarchiveObjectWithData:
+                            [NSData dataWithBytes:bytes length:(NSUInteger)length]];
+        return [NSMutableArray arrayWithArray:names];
+    }
+
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:(NSUInteger)MAX(count, 0)];
+    for (int32_t i = 0; i < count && !cursor->failed; i++) {
+        if (kind == EXTNamesStrings) {
+            NSString *name = EXTGetString(cursor);
+            if (name)
+                [ret addObject:name];
+        } else if (kind == EXTNamesTags && generators) {
+            int32_t length = EXTGetInt(cursor);
+            const void *exponents = (length < 0 || length > (int32_t)generators.count) ?
+                                    NULL : EXTTake(cursor, sizeof(int32_t) * length);
+            if (!exponents)
+                break;
+            [ret addObject:[EXTPolynomialTag tagWithExponents:exponents
+                                                        count:length
+                                                   generators:generators]];
+        } else {
+            break;
+        }
+    }
+
+    if (ret.count != (NSUInteger)count)
+        cursor->failed = YES;
+
+    return ret;
+}
+
+#pragma mark - the spectral sequence
+
+// the keyed archive of the spectral sequence leaves out what the other chunks
+// carry, by swapping in empty collections for them as it goes, and writes
+// terms (the unit term of the multiplication tables, say) as their locations.
+// on the way back in, this picks out the multiplication tables to fill in.
+@interface EXTChunkedArchiveShell : NSObject <NSKeyedArchiverDelegate,
+                                              NSKeyedUnarchiverDelegate>
+@property(strong) EXTSpectralSequence *sSeq;
+@property(strong) EXTMultiplicationTables *multTables;
+@property(strong) EXTLocation *unitLocation;
+@end
+
+@implementation EXTChunkedArchiveShell
+
+-(id) archiver:(NSKeyedArchiver *)archiver willEncodeObject:(id)object {
+    if (object == self.sSeq.terms)
+        return [NSMutableDictionary dictionary];
+    if (object == self.sSeq.differentials)
+        return [NSMutableArray array];
+
+    if ([object isKindOfClass:[EXTMultiplicationTables class]])
+        self.multTables = object;
+    else if (self.multTables && object == self.multTables.tables)
+        return [NSMutableDictionary dictionary];
+
+    if ([object isKindOfClass:[EXTTerm class]])
+        return ((EXTTerm*)object).location;
+
+    return object;
+}
+
+-(id) unarchiver:(NSKeyedUnarchiver *)unarchiver didDecodeObject:(id)object {
+    if ([object isKindOfClass:[EXTMultiplicationTables class]]) {
+        self.multTables = object;
+        // the spectral sequence looks this up among its terms as soon as it's
+        // decoded, before there are any.
+        id unit = self.multTables.unitTerm;
+        if ([unit respondsToSelector:@selector(grading)])
+            self.unitLocation = unit;
+    }
+
+    return object;
+}
+
+@end
+
+@implementation EXTSpectralSequence (EXTChunkedArchive)
+
+-(void) writeToChunkedArchive:(EXTChunkedArchive*)archive {
+    EXTChunkedArchiveShell *shell = [EXTChunkedArchiveShell new];
+    shell.sSeq = self;
+
+    NSMutableData *data = [NSMutableData data];
+    NSKeyedArchiver *archiver =
+                [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
+    archiver.delegate = shell;
+    [archiver encodeObject:self forKey:@"sseq"];
+    [archiver finishEncoding];
+    [archive appendChunk:EXTChunkTypeSSeq payload:data];
+
+    int rank = [self.indexClass identityLocation].grading.rank;
+    NSArray *generators = [self isKindOfClass:[EXTPolynomialSSeq class]] ?
+                                ((EXTPolynomialSSeq*)self).generators : nil;
+
+    // the terms.
+    data = [NSMutableData data];
+    EXTPutInt(data, rank);
+    EXTPutInt(data, (int32_t)self.terms.count);
+    for (EXTTerm *term in self.terms.allValues) {
+        EXTPutLocation(data, term.location, rank);
+        EXTPutNames(data, term.names, generators);
+        EXTPutMatrix(data, term.cycles[0]);
+        EXTPutMatrix(data, term.boundaries[0]);
+        EXTPutMatrix(data, term.displayBasis);
+        EXTPutNames(data, term.displayNames, generators);
+    }
+    [archive appendChunk:EXTChunkTypeTerms payload:data];
+
+    // the differentials, a page at a time.
+    for (int page = 0; page < self.differentials.count; page++) {
+        NSDictionary *differentialsOnPage = self.differentials[page];
+        if (differentialsOnPage.count == 0)
+            continue;
+
+        data = [NSMutableData data];
+        EXTPutInt(data, page);
+        EXTPutInt(data, (int32_t)differentialsOnPage.count);
+        for (EXTDifferential *differential in differentialsOnPage.allValues) {
+            EXTPutLocation(data, differential.start.location, rank);
+            EXTPutLocation(data, differential.end.location, rank);
+            EXTPutPartials(data, differential.partialDefinitions);
+        }
+        [archive appendChunk:EXTChunkTypeDifferentials payload:data];
+    }
+
+    // and the multiplication entries, which carry their partial definitions.
+    if (shell.multTables.tables.count > 0) {
+        data = [NSMutableData data];
+        EXTPutInt(data, (int32_t)shell.multTables.tables.count);
+        [shell.multTables enumerateEntriesUsingBlock:
+            ^(EXTLocation *loc1, EXTLocation *loc2, EXTMultiplicationEntry *entry) {
+                EXTPutLocation(data, loc1, rank);
+                EXTPutLocation(data, loc2, rank);
+                EXTPutPartials(data, entry.partialDefinitions);
+            }];
+        [archive appendChunk:EXTChunkTypeMultiplications payload:data];
+    }
+}
+
++(EXTSpectralSequence*) sSeqFromChunkedArchive:(EXTChunkedArchive*)archive
+                                         error:(NSError**)error {
+    NSIndexSet *sSeqChunks = [archive indexesOfChunksOfType:EXTChunkTypeSSeq],
+               *termChunks = [archive indexesOfChunksOfType:EXTChunkTypeTerms];
+    NSData *payload = sSeqChunks.count == 1 ?
+                        [archive payloadOfChunkAtIndex:sSeqChunks.firstIndex] : nil;
+    if (!payload || termChunks.count != 1) {
+        if (error)
+            *error = EXTChunkedArchiveError(@"This document has no spectral sequence in it.");
+        return nil;
+    }
+
+    EXTChunkedArchiveShell *shell = [EXTChunkedArchiveShell new];
+    NSKeyedUnarchiver *unarchiver =
+                    [[NSKeyedUnarchiver alloc] initForReadingWithData:payload];
+    unarchiver.delegate = shell;
+    EXTSpectralSequence *ret = [unarchiver decodeObjectForKey:@"sseq"];
+    [unarchiver finishDecoding];
+
+    Class<EXTLocation> indexClass = ret.indexClass;
+    NSArray *generators = [ret isKindOfClass:[EXTPolynomialSSeq class]] ?
+                                ((EXTPolynomialSSeq*)ret).generators : nil;
+
+    // the terms.
+    payload = [archive payloadOfChunkAtIndex:termChunks.firstIndex];
+    EXTChunkCursor cursor = {payload.bytes, payload.length, 0, !payload};
+    int rank = EXTGetInt(&cursor), count = EXTGetInt(&cursor);
+    if (rank != [indexClass identityLocation].grading.rank)
+        cursor.failed = YES;
+
+    for (int i = 0; i < count && !cursor.failed; i++) {
+        EXTTerm *term = [EXTTerm new];
+        term.location = EXTGetLocation(&cursor, indexClass, rank);
+        term.names = EXTGetNames(&cursor, generators);
+        EXTMatrix *cycles = EXTGetMatrix(&cursor),
+                  *boundaries = EXTGetMatrix(&cursor);
+        term.displayBasis = EXTGetMatrix(&cursor);
+        term.displayNames = EXTGetNames(&cursor, generators);
+        if (cursor.failed || !cycles || !boundaries)
+            break;
+
+        term.cycles = [NSMutableArray arrayWithObject:cycles];
+        term.boundaries = [NSMutableArray arrayWithObject:boundaries];
+        term.homologyReps = [NSMutableArray array];
+        [ret.terms setObject:term forKey:term.location];
+    }
+
+    // the differentials, which are linked straight to their terms.
+    NSIndexSet *differentialChunks =
+                [archive indexesOfChunksOfType:EXTChunkTypeDifferentials];
+    for (NSUInteger index = differentialChunks.firstIndex;
+         index != NSNotFound && !cursor.failed;
+         index = [differentialChunks indexGreaterThanIndex:index]) {
+        payload = [archive payloadOfChunkAtIndex:index];
+        cursor = (EXTChunkCursor){payload.bytes, payload.length, 0, !payload};
+
+        int page = EXTGetInt(&cursor);
+        count = EXTGetInt(&cursor);
+        for (int i = 0; i < count && !cursor.failed; i++) {
+            EXTTerm *start = [ret findTerm:EXTGetLocation(&cursor, indexClass, rank)],
+                    *end = [ret findTerm:EXTGetLocation(&cursor, indexClass, rank)];
+            NSArray *partials = EXTGetPartials(&cursor);
+            if (!start || !end) {
+                cursor.failed = YES;
+                break;
+            }
+
+            EXTDifferential *differential =
+                    [EXTDifferential newDifferential:start end:end page:page];
+            [differential.partialDefinitions addObjectsFromArray:partials];
+            [ret addDifferential:differential];
+        }
+    }
+
+    // the multiplication entries.
+    NSIndexSet *multiplicationChunks =
+                [archive indexesOfChunksOfType:EXTChunkTypeMultiplications];
+    if (multiplicationChunks.count > 0 && !cursor.failed) {
+        payload = [archive payloadOfChunkAtIndex:multiplicationChunks.firstIndex];
+        cursor = (EXTChunkCursor){payload.bytes, payload.length, 0, !payload};
+
+        count = EXTGetInt(&cursor);
+        for (int i = 0; i < count && !cursor.failed; i++) {
+            EXTLocation *loc1 = EXTGetLocation(&cursor, indexClass, rank),
+                        *loc2 = EXTGetLocation(&cursor, indexClass, rank);
+            EXTMultiplicationEntry *entry = [EXTMultiplicationEntry new];
+            entry.partialDefinitions = EXTGetPartials(&cursor);
+            if (!cursor.failed)
+                [shell.multTables setEntry:entry for:loc1 with:loc2];
+        }
+    }
+
+    if (cursor.failed) {
+        if (error)
+            *error = EXTChunkedArchiveError(@"This document is damaged.");
+        return nil;
+    }
+
+    if (shell.unitLocation)
+        shell.multTables.unitTerm = [ret findTerm:shell.unitLocation];
+
+    return ret;
+}
+
+@end
@@ -6,7 +6,7 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTSpectralSequence.h"
 
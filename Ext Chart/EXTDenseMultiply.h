@@ -0,0 +1,48 @@
+//
+//  EXTDenseMultiply.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// the product kernel behind +[EXTMatrix newMultiply:by:] away from
+// characteristic 2.  the product is built a block at a time in 64-bit
+// accumulators: column k of left * right is the sum of the columns of left
+// weighted by the entries of column k of right, and each such axpy runs over
+// a block of rows small enough to stay in cache.  zero weights and zero
+// columns of left are skipped outright.
+//
+// in characteristic p, the operands are first reduced into [0, p), so that
+// each term is less than p^2, and a block of accumulators is reduced only
+// once it's soaked up as many terms as it can hold.
+//
+// the axpy itself is vectorized: AVX2 or SSE4.1 on x86, picked at runtime by
+// asking the processor, and NEON on ARM, with a scalar loop for everything
+// else.
+typedef enum : int {
+    EXTDenseMultiplyScalar,
+    EXTDenseMultiplySSE41,
+    EXTDenseMultiplyAVX2,
+    EXTDenseMultiplyNEON,
+} EXTDenseMultiplyPath;
+
+// rows, inner columns and product columns per block.
+#define EXT_DENSE_MULTIPLY_ROW_BLOCK 256
+#define EXT_DENSE_MULTIPLY_INNER_BLOCK 64
+#define EXT_DENSE_MULTIPLY_COLUMN_BLOCK 16
+
+/// product = left * right for int-valued, column-major matrices, where left is
+/// height x inner and right is inner x width.  with a nonzero characteristic,
+/// the entries of the product lie in [0, characteristic); otherwise they're
+/// exact, so long as they fit in an int.
+void EXTDenseMultiply(const int *left, const int *right, int *product,
+                      int height, int inner, int width, int characteristic);
+
+/// the vector path EXTDenseMultiply picked for this machine.
+EXTDenseMultiplyPath EXTDenseMultiplyPreferredPath(void);
+
+/// for testing and benchmarking: forces a particular path, if the machine has
+/// it.  returns whether it does.
+bool EXTDenseMultiplySetPath(EXTDenseMultiplyPath path);
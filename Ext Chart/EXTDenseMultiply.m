@@ -0,0 +1,256 @@
+//
+//  EXTDenseMultiply.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTDenseMultiply.h"
+#import "EXTScratch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXT_DENSE_MULTIPLY_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// accumulator[i] += weight * column[i] for i in [0, count).
+typedef void (*EXTDenseAxpy)(int64_t *accumulator, const int *column,
+                             int64_t weight, int count);
+
+static void EXTDenseAxpyScalar(int64_t *accumulator, const int *column,
+                               int64_t weight, int count) {
+    for (int i = 0; i < count; i++)
+        accumulator[i] += weight * column[i];
+}
+
+#ifdef EXT_DENSE_MULTIPLY_X86
+
+// _mm_mul_epi32 multiplies the low signed halves of 64-bit lanes, so each
+// group of ints is widened to 64 bits on the way in.
+__attribute__((target("sse4.1")))
+static void EXTDenseAxpySSE41(int64_t *accumulator, const int *column,
+                              int64_t weight, int count) {
+    __m128i factor = _mm_set1_epi64x(weight);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i low = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(column + i))),
+                high = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*)(column + i + 2)));
+        __m128i *target = (__m128i*)(accumulator + i);
+
+        _mm_storeu_si128(target, _mm_add_epi64(_mm_loadu_si128(target),
+                                               _mm_mul_epi32(low, factor)));
+        _mm_storeu_si128(target + 1, _mm_add_epi64(_mm_loadu_si128(target + 1),
+                                                   _mm_mul_epi32(high, factor)));
+    }
+
+    EXTDenseAxpyScalar(accumulator + i, column + i, weight, count - i);
+}
+
+__attribute__((target("avx2")))
+static void EXTDenseAxpyAVX2(int64_t *accumulator, const int *column,
+                             int64_t weight, int count) {
+    __m256i factor = _mm256_set1_epi64x(weight);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i low = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(column + i))),
+                high = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(column + i + 4)));
+        __m256i *target = (__m256i*)(accumulator + i);
+
+        _mm256_storeu_si256(target, _mm256_add_epi64(_mm256_loadu_si256(target),
+                                                     _mm256_mul_epi32(low, factor)));
+        _mm256_storeu_si256(target + 1, _mm256_add_epi64(_mm256_loadu_si256(target + 1),
+                                                         _mm256_mul_epi32(high, factor)));
+    }
+
+    EXTDenseAxpyScalar(accumulator + i, column + i, weight, count - i);
+}
+
+#elif defined(__ARM_NEON)
+
+static void EXTDenseAxpyNEON(int64_t *accumulator, const int *column,
+                             int64_t weight, int count) {
+    int32x2_t factor = vdup_n_s32((int32_t)weight);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t entries = vld1q_s32(column + i);
+
+        vst1q_s64(accumulator + i,
+                  vmlal_s32(vld1q_s64(accumulator + i), vget_low_s32(entries), factor));
+        vst1q_s64(accumulator + i + 2,
+                  vmlal_s32(vld1q_s64(accumulator + i + 2), vget_high_s32(entries), factor));
+    }
+
+    EXTDenseAxpyScalar(accumulator + i, column + i, weight, count - i);
+}
+
+#endif
+
+#pragma mark - dispatch
+
+// -1 until the first multiply asks the processor what it can do.
+static int EXTDenseMultiplyCurrentPath = -1;
+
+static bool EXTDenseMultiplyHasPath(EXTDenseMultiplyPath path) {
+    switch (path) {
+        case EXTDenseMultiplyScalar:
+            return true;
+#ifdef EXT_DENSE_MULTIPLY_X86
+        case EXTDenseMultiplySSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case EXTDenseMultiplyAVX2:
+            return __builtin_cpu_supports("avx2");
+#elif defined(__ARM_NEON)
+        case EXTDenseMultiplyNEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+EXTDenseMultiplyPath EXTDenseMultiplyPreferredPath(void) {
+    EXTDenseMultiplyPath candidates[] = {EXTDenseMultiplyAVX2,
+                                         EXTDenseMultiplyNEON,
+                                         EXTDenseMultiplySSE41};
+
+    for (int i = 0; i < 3; i++)
+        if (EXTDenseMultiplyHasPath(candidates[i]))
+            return candidates[i];
+
+    return EXTDenseMultiplyScalar;
+}
+
+bool EXTDenseMultiplySetPath(EXTDenseMultiplyPath path) {
+    if (!EXTDenseMultiplyHasPath(path))
+        return false;
+
+    __atomic_store_n(&EXTDenseMultiplyCurrentPath, (int)path, __ATOMIC_RELAXED);
+    return true;
+}
+
+static EXTDenseAxpy EXTDenseMultiplyAxpy(void) {
+    int path = __atomic_load_n(&EXTDenseMultiplyCurrentPath, __ATOMIC_RELAXED);
+
+    if (path == -1) {
+        path = EXTDenseMultiplyPreferredPath();
+        __atomic_store_n(&EXTDenseMultiplyCurrentPath, path, __ATOMIC_RELAXED);
+    }
+
+    switch ((EXTDenseMultiplyPath)path) {
+#ifdef EXT_DENSE_MULTIPLY_X86
+        case EXTDenseMultiplyAVX2:
+            return EXTDenseAxpyAVX2;
+        case EXTDenseMultiplySSE41:
+            return EXTDenseAxpySSE41;
+#elif defined(__ARM_NEON)
+        case EXTDenseMultiplyNEON:
+            return EXTDenseAxpyNEON;
+#endif
+        default:
+            return EXTDenseAxpyScalar;
+    }
+}
+
+#pragma mark - the product
+
+static inline int EXTDenseReduce(int64_t x, int characteristic) {
+    int64_t remainder = x % characteristic;
+    return (int)(remainder < 0 ? remainder + characteristic : remainder);
+}
+
+void EXTDenseMultiply(const int *left, const int *right, int *product,
+                      int height, int inner, int width, int characteristic) {
+    EXTScratchMark mark = EXTScratchSave();
+
+    // reduce the operands, so that every term is less than characteristic^2.
+    int64_t maxPendingTerms = INT64_MAX;
+    if (characteristic != 0) {
+        int *reducedLeft = EXTScratchAlloc(sizeof(int) * ((size_t)height * inner + 1)),
+            *reducedRight = EXTScratchAlloc(sizeof(int) * ((size_t)inner * width + 1));
+        for (size_t i = 0; i < (size_t)height * inner; i++)
+            reducedLeft[i] = EXTDenseReduce(left[i], characteristic);
+        for (size_t i = 0; i < (size_t)inner * width; i++)
+            reducedRight[i] = EXTDenseReduce(right[i], characteristic);
+        left = reducedLeft;
+        right = reducedRight;
+
+        int64_t largestTerm = (int64_t)(characteristic - 1) * (characteristic - 1);
+        maxPendingTerms = largestTerm ? (INT64_MAX - characteristic) / largestTerm : INT64_MAX;
+    }
+
+    // remember which columns of left vanish.
+    bool *zeroColumns = EXTScratchAlloc(sizeof(bool) * (inner + 1));
+    for (int j = 0; j < inner; j++) {
+        const int *column = left + (size_t)j*height;
+        zeroColumns[j] = true;
+        for (int i = 0; i < height && zeroColumns[j]; i++)
+            zeroColumns[j] = (column[i] == 0);
+    }
+
+    // for large characteristics, an accumulator might not even survive a
+    // whole block's worth of terms.
+    int innerBlock = (int)MIN((int64_t)EXT_DENSE_MULTIPLY_INNER_BLOCK,
+                              maxPendingTerms);
+
+    EXTDenseAxpy axpy = EXTDenseMultiplyAxpy();
+    int64_t *accumulators = EXTScratchAlloc(sizeof(int64_t) *
+                                            (EXT_DENSE_MULTIPLY_ROW_BLOCK *
+                                             EXT_DENSE_MULTIPLY_COLUMN_BLOCK + 1));
+
+    for (int rowStart = 0; rowStart < height;
+         rowStart += EXT_DENSE_MULTIPLY_ROW_BLOCK) {
+        int rows = MIN(EXT_DENSE_MULTIPLY_ROW_BLOCK, height - rowStart);
+
+        for (int columnStart = 0; columnStart < width;
+             columnStart += EXT_DENSE_MULTIPLY_COLUMN_BLOCK) {
+            int columns = MIN(EXT_DENSE_MULTIPLY_COLUMN_BLOCK, width - columnStart);
+            int64_t pendingTerms = 0;
+
+            memset(accumulators, 0, sizeof(int64_t) * rows * columns);
+
+            for (int innerStart = 0; innerStart < inner;
+                 innerStart += innerBlock) {
+                int inners = MIN(innerBlock, inner - innerStart);
+
+                // each pass over this inner block adds at most inners terms
+                // to every accumulator, so make room first.
+                if (pendingTerms + inners > maxPendingTerms) {
+                    for (int i = 0; i < rows * columns; i++)
+                        accumulators[i] %= characteristic;
+                    pendingTerms = 0;
+                }
+                pendingTerms += inners;
+
+                for (int k = 0; k < columns; k++) {
+                    const int *weights = right + (size_t)(columnStart + k)*inner;
+                    int64_t *target = accumulators + (size_t)k*rows;
+
+                    for (int j = innerStart; j < innerStart + inners; j++) {
+                        if (weights[j] == 0 || zeroColumns[j])
+                            continue;
+
+                        axpy(target, left + (size_t)j*height + rowStart,
+                             weights[j], rows);
+                    }
+                }
+            }
+
+            for (int k = 0; k < columns; k++) {
+                int *column = product + (size_t)(columnStart + k)*height + rowStart;
+                const int64_t *source = accumulators + (size_t)k*rows;
+
+                for (int i = 0; i < rows; i++)
+                    column[i] = characteristic ?
+                                    EXTDenseReduce(source[i], characteristic) :
+                                    (int)source[i];
+            }
+        }
+    }
+
+    EXTScratchRestore(mark);
+}
@@ -6,9 +6,8 @@
 //  Copyright 2011 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
-#import "EXTDocument.h"
 #import "EXTMatrix.h"
 #import "EXTTerm.h"
 @class EXTGrid;
@@ -40,6 +39,10 @@
 
 // deal with its
 -(void) assemblePresentation;
+// the presentation is assembled on demand, and kept until the partial
+// definitions or the groups on the start term change.  whoever changes them in
+// place should call this (or -[EXTSpectralSequence invalidateDifferential:]).
+-(void) invalidatePresentation;
 -(void) stripDuplicates;
 
 -(BOOL) checkForSanity;
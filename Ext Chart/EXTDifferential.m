@@ -7,7 +7,6 @@
 //
 
 #import "EXTDifferential.h"
-#import "EXTGrid.h"
 #import "EXTTerm.h"
 
 #pragma mark - Private variables
@@ -87,14 +86,16 @@ static void *_EXTPresentationParametersContext = &_EXTPresentationParametersCont
 
 // quietly assemble the presentation when asked for it :)
 -(EXTMatrix*) presentation {
-    //if (presentationNeedsAssembly) {
+    if (presentationNeedsAssembly)
         [self assemblePresentation];
-    //    presentationNeedsAssembly = false;
-    //}
 
     return _presentation;
 }
 
+-(void) invalidatePresentation {
+    presentationNeedsAssembly = true;
+}
+
 -(void) setPresentation:(EXTMatrix*)presentation {
     _presentation = presentation;
 }
@@ -143,6 +144,7 @@ static void *_EXTPresentationParametersContext = &_EXTPresentationParametersCont
     _presentation = [EXTMatrix assemblePresentation:newPartials
                                     sourceDimension:cycles.width
                                     targetDimension:end.size];
+    presentationNeedsAssembly = false;
     
     if (_presentation.height != end.size ||
         _presentation.width != cycles.width)
@@ -161,14 +163,13 @@ static void *_EXTPresentationParametersContext = &_EXTPresentationParametersCont
     EXTMatrix *workingImage = [EXTMatrix matrixWidth:0 height:self.start.size];
     
     for (EXTPartialDefinition *partial1 in self.partialDefinitions) {
-        EXTMatrix *testMatrix = [inclusionSum copy];
-        testMatrix.characteristic = partial1.inclusion.characteristic;
-        
         [partial1.inclusion modularReduction];
         [partial1.action modularReduction];
         
-        [testMatrix.presentation appendData:partial1.inclusion.presentation];
-        testMatrix.width += partial1.inclusion.width;
+        EXTMatrix *testMatrix =
+            [EXTMatrix directSumWithCommonTargetA:inclusionSum
+                                                B:partial1.inclusion];
+        testMatrix.characteristic = partial1.inclusion.characteristic;
         EXTMatrix *image = [testMatrix image];
         
         if ([image isEqualTo:workingImage])
@@ -8,6 +8,7 @@
 
 #import "EXTDifferentialPaneController.h"
 #import "EXTDifferential.h"
+#import "EXTDocument.h"
 #import "EXTMatrixEditor.h"
 #import "EXTDocumentWindowController.h"
 #import "EXTChartViewController.h"
@@ -261,12 +262,13 @@
     
     // or, if this dimension is smaller than the one we were, we should modify
     // the dimensions of our matrices and lop them off / extend accordingly.
+    int keptColumns = (int)MIN(value, inclusion.width);
     memcpy(newInclusion.presentation.mutableBytes,
            inclusion.presentation.mutableBytes,
-           inclusion.presentation.length);
+           sizeof(int)*keptColumns*inclusion.height);
     memcpy(newAction.presentation.mutableBytes,
            action.presentation.mutableBytes,
-           action.presentation.length);
+           sizeof(int)*keptColumns*action.height);
     
     // store the fresh matrices
     self.actionEditor.representedObject = newAction;
@@ -14,11 +14,12 @@
 #import "EXTDocumentWindowController.h"
 #import "EXTDemos.h"
 #import "EXTDifferential.h"
+#import "EXTChunkedArchive.h"
 #import "NSUserDefaults+EXTAdditions.h"
 #import "NSKeyedArchiver+EXTAdditions.h"
 
 
-#define PRESENT_FILE_VERSION 7
+#define PRESENT_FILE_VERSION 8
 #define MINIMUM_FILE_VERSION_ALLOWED 7
 
 
@@ -60,12 +61,15 @@
 #pragma mark - Document saving and loading
 
 - (NSData *)dataOfType:(NSString *)typeName error:(NSError **)outError {
+    EXTChunkedArchive *archive = [[EXTChunkedArchive alloc] initForWritingCompressed:YES];
+    [_sseq writeToChunkedArchive:archive];
+
+    // what's left is small, and goes in a keyed archive alongside.
     NSMutableData* data = [NSMutableData data];
     NSKeyedArchiver* arch = [[NSKeyedArchiver alloc] initForWritingWithMutableData:data];
 
     [arch encodeInteger:PRESENT_FILE_VERSION forKey:@"fileVersion"];
 
-    [arch encodeObject:_sseq forKey:@"sseq"];
     [arch encodeObject:_marquees forKey:@"marquees"];
 
     [arch encodeObject:_gridColor forKey:@"gridColor"];
@@ -79,11 +83,47 @@
     [arch encodeObject:_multiplicationAnnotations forKey:@"multiplicationAnnotations"];
 
     [arch finishEncoding];
+    [archive appendChunk:EXTChunkTypeDocument payload:data];
+
+    return archive.data;
+}
+
+// the chunks of a document are read straight out of the file, so it's mapped
+// in rather than copied.
+- (BOOL)readFromURL:(NSURL *)url ofType:(NSString *)typeName error:(NSError **)outError {
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:outError];
+    if (!data)
+        return NO;
 
-    return data;
+    return [self readFromData:data ofType:typeName error:outError];
 }
 
 - (BOOL)readFromData:(NSData *)data ofType:(NSString *)typeName error:(NSError **)outError {
+    // documents from before version 8 are one big keyed archive.  these can
+    // still be opened, but they're saved in the new format.
+    if (![EXTChunkedArchive isChunkedArchive:data])
+        return [self readFromKeyedArchiveData:data error:outError];
+
+    EXTChunkedArchive *archive = [[EXTChunkedArchive alloc] initForReadingWithData:data error:outError];
+    if (!archive)
+        return NO;
+
+    EXTSpectralSequence *sseq = [EXTSpectralSequence sSeqFromChunkedArchive:archive error:outError];
+    if (!sseq)
+        return NO;
+    self.sseq = sseq;
+
+    NSIndexSet *documentChunks = [archive indexesOfChunksOfType:EXTChunkTypeDocument];
+    NSData *payload = documentChunks.count == 1 ? [archive payloadOfChunkAtIndex:documentChunks.firstIndex] : nil;
+    if (payload) {
+        NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:payload];
+        [self readAttributesFromUnarchiver:unarchiver version:[unarchiver decodeIntegerForKey:@"fileVersion"]];
+    }
+
+    return YES;
+}
+
+- (BOOL)readFromKeyedArchiveData:(NSData *)data error:(NSError **)outError {
     NSKeyedUnarchiver *unarchiver = [[NSKeyedUnarchiver alloc] initForReadingWithData:data];
 
     int version = [unarchiver decodeIntegerForKey:@"fileVersion"];
@@ -97,7 +137,13 @@
     }
 
     self.sseq = [unarchiver decodeObjectForKey:@"sseq"];
+    [self readAttributesFromUnarchiver:unarchiver version:version];
 
+    return YES;
+}
+
+// everything but the spectral sequence.
+- (void)readAttributesFromUnarchiver:(NSKeyedUnarchiver *)unarchiver version:(NSInteger)version {
     if ([unarchiver containsValueForKey:@"marquees"])
         self.marquees = [unarchiver decodeObjectForKey:@"marquees"];
 
@@ -135,8 +181,6 @@
     
     if ([unarchiver containsValueForKey:@"multiplicationAnnotations"])
         self.multiplicationAnnotations = [unarchiver decodeObjectForKey:@"multiplicationAnnotations"];
-
-    return YES;
 }
 
 #pragma mark - Document features
@@ -153,6 +197,7 @@
     [oldDiffl.partialDefinitions removeAllObjects];
     for (EXTPartialDefinition *p in diffl.partialDefinitions)
         [oldDiffl.partialDefinitions addObject:[p copy]];
+    [self.sseq invalidateDifferential:oldDiffl];
     
     [self updateChangeCount:NSChangeDone];
     
@@ -168,6 +213,7 @@
     
     oldTerm.cycles[0] = term.cycles[0];
     oldTerm.boundaries[0] = term.boundaries[0];
+    [self.sseq invalidateTerm:oldTerm];
     
     [self updateChangeCount:NSChangeDone];
     
@@ -0,0 +1,65 @@
+//
+//  EXTGridIndex.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "EXTGrading.h"
+
+@class EXTMatrix;
+
+// the linear part of an EXTLocationToPoint: the composite of its internal-to-
+// user and user-to-screen matrices, flattened into plain ints, so that putting
+// a grading on the grid costs a handful of multiplies rather than a trip
+// through EXTMatrix.
+typedef struct {
+    int rank;
+    int rows[2][EXT_GRADING_MAX_RANK];
+} EXTGridProjection;
+
+EXTGridProjection EXTGridProjectionCompose(EXTMatrix *userToScreen,
+                                           EXTMatrix *internalToUser);
+
+static inline EXTIntPoint EXTGridProjectionApply(EXTGridProjection projection,
+                                                 EXTGrading grading) {
+    NSInteger x = 0, y = 0;
+    for (int i = 0; i < projection.rank; i++) {
+        x += projection.rows[0][i] * grading.coordinates[i];
+        y += projection.rows[1][i] * grading.coordinates[i];
+    }
+
+    return (EXTIntPoint){x, y};
+}
+
+static inline BOOL EXTGridProjectionEqual(EXTGridProjection a,
+                                          EXTGridProjection b) {
+    if (a.rank != b.rank)
+        return NO;
+
+    for (int i = 0; i < a.rank; i++)
+        if (a.rows[0][i] != b.rows[0][i] || a.rows[1][i] != b.rows[1][i])
+            return NO;
+
+    return YES;
+}
+
+// a bucketed index of objects by grid point.  the plane is cut into square
+// tiles, each holding the occupied points inside it, so that a point query is
+// two lookups and a rectangle query only visits the tiles it overlaps,
+// however many objects are indexed elsewhere.  objects at the same point are
+// returned in the order they were added.
+@interface EXTGridIndex : NSObject
+
+@property (readonly) NSUInteger count;
+
+-(void) addObject:(id)object atPoint:(EXTIntPoint)point;
+-(void) removeObject:(id)object atPoint:(EXTIntPoint)point;
+-(void) removeAllObjects;
+
+-(NSArray*) objectsAtPoint:(EXTIntPoint)point;
+-(NSArray*) objectsInRect:(EXTIntRect)rect;
+
+@end
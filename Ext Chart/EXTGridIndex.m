@@ -0,0 +1,151 @@
+//
+//  EXTGridIndex.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTGridIndex.h"
+#import "EXTMatrix.h"
+
+EXTGridProjection EXTGridProjectionCompose(EXTMatrix *userToScreen,
+                                           EXTMatrix *internalToUser) {
+    EXTMatrix *composite = [EXTMatrix newMultiply:userToScreen
+                                               by:internalToUser];
+    const int *data = [composite entries];
+
+    EXTGridProjection ret = {(int)composite.width, {{0}}};
+    NSCParameterAssert(composite.height == 2 &&
+                       composite.width <= EXT_GRADING_MAX_RANK);
+    for (int i = 0; i < composite.width; i++) {
+        ret.rows[0][i] = data[i*2 + 0];
+        ret.rows[1][i] = data[i*2 + 1];
+    }
+
+    return ret;
+}
+
+// tiles are 16 points on a side, which is about what a chart window shows.
+#define EXT_GRID_TILE_SHIFT 4
+
+static inline NSNumber *EXTGridKey(NSInteger x, NSInteger y) {
+    return @(((int64_t)x << 32) | (uint32_t)y);
+}
+
+static inline EXTIntPoint EXTGridKeyPoint(NSNumber *key) {
+    int64_t packed = key.longLongValue;
+    return (EXTIntPoint){(NSInteger)(packed >> 32), (int32_t)packed};
+}
+
+@implementation EXTGridIndex {
+    // tile key => (point key => objects at that point)
+    NSMutableDictionary *tiles;
+}
+
+@synthesize count;
+
+-(instancetype) init {
+    if (self = [super init]) {
+        tiles = [NSMutableDictionary dictionary];
+        count = 0;
+    }
+
+    return self;
+}
+
+-(void) addObject:(id)object atPoint:(EXTIntPoint)point {
+    NSNumber *tileKey = EXTGridKey(point.x >> EXT_GRID_TILE_SHIFT,
+                                   point.y >> EXT_GRID_TILE_SHIFT),
+             *pointKey = EXTGridKey(point.x, point.y);
+
+    NSMutableDictionary *tile = tiles[tileKey];
+    if (!tile)
+        tiles[tileKey] = tile = [NSMutableDictionary dictionary];
+
+    NSMutableArray *objects = tile[pointKey];
+    if (!objects)
+        tile[pointKey] = objects = [NSMutableArray array];
+
+    [objects addObject:object];
+    count++;
+}
+
+-(void) removeObject:(id)object atPoint:(EXTIntPoint)point {
+    NSNumber *tileKey = EXTGridKey(point.x >> EXT_GRID_TILE_SHIFT,
+                                   point.y >> EXT_GRID_TILE_SHIFT),
+             *pointKey = EXTGridKey(point.x, point.y);
+
+    NSMutableDictionary *tile = tiles[tileKey];
+    NSMutableArray *objects = tile[pointKey];
+    NSUInteger index = [objects indexOfObjectIdenticalTo:object];
+    if (!objects || index == NSNotFound)
+        return;
+
+    [objects removeObjectAtIndex:index];
+    count--;
+
+    // don't leave empty buckets around for the range queries to step through.
+    if (objects.count == 0) {
+        [tile removeObjectForKey:pointKey];
+        if (tile.count == 0)
+            [tiles removeObjectForKey:tileKey];
+    }
+}
+
+-(void) removeAllObjects {
+    [tiles removeAllObjects];
+    count = 0;
+}
+
+-(NSArray*) objectsAtPoint:(EXTIntPoint)point {
+    NSArray *objects =
+        tiles[EXTGridKey(point.x >> EXT_GRID_TILE_SHIFT,
+                         point.y >> EXT_GRID_TILE_SHIFT)][EXTGridKey(point.x,
+                                                                    point.y)];
+
+    return objects ? [objects copy] : @[];
+}
+
+-(NSArray*) objectsInRect:(EXTIntRect)rect {
+    NSMutableArray *ret = [NSMutableArray array];
+    if (rect.size.width <= 0 || rect.size.height <= 0)
+        return ret;
+
+    NSInteger left = rect.origin.x >> EXT_GRID_TILE_SHIFT,
+              bottom = rect.origin.y >> EXT_GRID_TILE_SHIFT,
+              right = (rect.origin.x + rect.size.width - 1) >> EXT_GRID_TILE_SHIFT,
+              top = (rect.origin.y + rect.size.height - 1) >> EXT_GRID_TILE_SHIFT;
+
+    void (^collect)(NSDictionary *) = ^(NSDictionary *tile) {
+        [tile enumerateKeysAndObjectsUsingBlock:^(NSNumber *pointKey,
+                                                  NSArray *objects,
+                                                  BOOL *stop) {
+            if (EXTIntPointInRect(EXTGridKeyPoint(pointKey), rect))
+                [ret addObjectsFromArray:objects];
+        }];
+    };
+
+    // a rectangle covering more tiles than are occupied (zoomed far out, say)
+    // is cheaper to answer by walking the occupied ones.
+    if ((top - bottom + 1) * (right - left + 1) > (NSInteger)tiles.count) {
+        [tiles enumerateKeysAndObjectsUsingBlock:^(NSNumber *tileKey,
+                                                   NSDictionary *tile,
+                                                   BOOL *stop) {
+            EXTIntPoint tilePoint = EXTGridKeyPoint(tileKey);
+            if (tilePoint.x >= left && tilePoint.x <= right &&
+                tilePoint.y >= bottom && tilePoint.y <= top)
+                collect(tile);
+        }];
+    } else {
+        for (NSInteger x = left; x <= right; x++)
+            for (NSInteger y = bottom; y <= top; y++) {
+                NSDictionary *tile = tiles[EXTGridKey(x, y)];
+                if (tile)
+                    collect(tile);
+            }
+    }
+
+    return ret;
+}
+
+@end
@@ -6,7 +6,10 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
+
+#import "EXTGrading.h"
+#import "EXTGridIndex.h"
 
 enum EXTLocationKinds {
     EXTPair_KIND = 0,
@@ -46,6 +49,12 @@ enum EXTLocationKinds {
 -(BOOL) isEqual:(NSObject<EXTLocation>*)a;
 -(NSUInteger) hash;
 
+// the coordinates underneath the location.  two locations of the same class
+// are equal exactly when their gradings are, and the class arithmetic above is
+// the arithmetic of Z^n.  EXTLocationDictionary keys on these.
+-(EXTGrading) grading;
++(NSObject<EXTLocation>*) locationWithGrading:(EXTGrading)grading;
+
 @end
 
 // type utility so that we can pretend to refer to a generic 'EXTLocation' class
@@ -64,6 +73,8 @@ typedef NSObject<EXTLocation> EXTLocation;
 @protocol EXTLocationToPoint <NSObject, NSCopying, NSCoding>
 
 -(EXTIntPoint) gridPoint:(EXTLocation*)loc;
+// the linear map underlying -gridPoint:, for callers placing many gradings.
+-(EXTGridProjection) gridProjection;
 -(EXTIntPoint) followDifflAtGridLocation:(EXTIntPoint)gridLocation
                                     page:(int)page;
 -(EXTLocation*) convertFromString:(NSString*)input;
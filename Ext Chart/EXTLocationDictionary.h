@@ -0,0 +1,31 @@
+//
+//  EXTLocationDictionary.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "EXTLocation.h"
+
+// a mutable dictionary whose keys are EXTLocations, hashed and compared by
+// their gradings in an open-addressed table.  it stands in anywhere an
+// NSMutableDictionary of terms or differentials did, and it archives as one,
+// but it can also be searched by a bare EXTGrading, without building a
+// location to ask with.
+@interface EXTLocationDictionary : NSMutableDictionary
+
+-(id) objectForGrading:(EXTGrading)grading;
+
+// bumped by every insertion, replacement and removal, so that whoever keeps
+// something computed off of the contents can tell when they've changed, even
+// if the count hasn't.
+-(unsigned long) mutationCount;
+
+// an index of the values by where projection puts their keys on the grid.  it
+// is built on the first request, kept up to date by later insertions and
+// removals, and rebuilt only when a different projection is asked for.
+-(EXTGridIndex*) gridIndexForProjection:(EXTGridProjection)projection;
+
+@end
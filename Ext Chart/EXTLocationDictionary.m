@@ -0,0 +1,281 @@
+//
+//  EXTLocationDictionary.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTLocationDictionary.h"
+
+// the table is open-addressed with linear probing, and kept at most three
+// quarters full.  removals shift the rest of their run back, rather than
+// leaving tombstones, so a lookup stops at the first empty slot.
+@implementation EXTLocationDictionary {
+    EXTGrading *gradings;
+    uint64_t *hashes;
+    __strong id *keys, *values;     // a slot is empty when its key is nil
+    NSUInteger capacity, count;     // capacity is zero or a power of two
+    unsigned long mutations;
+
+    EXTGridIndex *gridIndex;        // nil until someone asks for one
+    EXTGridProjection gridProjection;
+}
+
+-(instancetype) init {
+    return [self initWithCapacity:0];
+}
+
+-(instancetype) initWithCapacity:(NSUInteger)numItems {
+    if (self = [super init]) {
+        [self growToFit:numItems];
+    }
+
+    return self;
+}
+
+-(instancetype) initWithObjects:(const id [])objects
+                        forKeys:(const id<NSCopying> [])newKeys
+                          count:(NSUInteger)cnt {
+    if (self = [self initWithCapacity:cnt]) {
+        for (NSUInteger i = 0; i < cnt; i++)
+            [self setObject:objects[i] forKey:newKeys[i]];
+    }
+
+    return self;
+}
+
+-(void) dealloc {
+    [self freeSlots];
+}
+
+-(void) freeSlots {
+    for (NSUInteger i = 0; i < capacity; i++) {
+        keys[i] = nil;
+        values[i] = nil;
+    }
+    free(keys); free(values); free(gradings); free(hashes);
+    keys = values = NULL;
+    gradings = NULL;
+    hashes = NULL;
+    capacity = 0;
+}
+
+// archives (and copies) come out as plain dictionaries.
+-(Class) classForCoder {
+    return [NSMutableDictionary class];
+}
+
+-(Class) classForKeyedArchiver {
+    return [NSMutableDictionary class];
+}
+
+#pragma mark - the table
+
+// the slot holding grading, or else the empty slot where it would go.
+-(NSUInteger) slotForGrading:(EXTGrading)grading hash:(uint64_t)hash {
+    NSUInteger mask = capacity - 1, slot = (NSUInteger)hash & mask;
+
+    while (keys[slot] &&
+           !(hashes[slot] == hash && EXTGradingEqual(gradings[slot], grading)))
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+-(void) growToFit:(NSUInteger)numItems {
+    NSUInteger newCapacity = capacity ? capacity : 8;
+    while (numItems * 4 > newCapacity * 3)
+        newCapacity *= 2;
+    if (newCapacity == capacity)
+        return;
+
+    EXTGrading *oldGradings = gradings;
+    uint64_t *oldHashes = hashes;
+    __strong id *oldKeys = keys, *oldValues = values;
+    NSUInteger oldCapacity = capacity;
+
+    capacity = newCapacity;
+    gradings = calloc(capacity, sizeof(EXTGrading));
+    hashes = calloc(capacity, sizeof(uint64_t));
+    keys = (__strong id *)calloc(capacity, sizeof(id));
+    values = (__strong id *)calloc(capacity, sizeof(id));
+
+    for (NSUInteger i = 0; i < oldCapacity; i++) {
+        if (!oldKeys[i])
+            continue;
+
+        NSUInteger slot = [self slotForGrading:oldGradings[i] hash:oldHashes[i]];
+        gradings[slot] = oldGradings[i];
+        hashes[slot] = oldHashes[i];
+        keys[slot] = oldKeys[i];
+        values[slot] = oldValues[i];
+        oldKeys[i] = nil;
+        oldValues[i] = nil;
+    }
+
+    free(oldKeys); free(oldValues); free(oldGradings); free(oldHashes);
+}
+
+#pragma mark - the grid index
+
+-(EXTGridIndex*) gridIndexForProjection:(EXTGridProjection)projection {
+    if (gridIndex && EXTGridProjectionEqual(gridProjection, projection))
+        return gridIndex;
+
+    gridIndex = [EXTGridIndex new];
+    gridProjection = projection;
+    for (NSUInteger i = 0; i < capacity; i++)
+        if (keys[i])
+            [gridIndex addObject:values[i]
+                         atPoint:EXTGridProjectionApply(projection,
+                                                        gradings[i])];
+
+    return gridIndex;
+}
+
+#pragma mark - NSDictionary primitives
+
+-(NSUInteger) count {
+    return count;
+}
+
+-(unsigned long) mutationCount {
+    return mutations;
+}
+
+-(id) objectForGrading:(EXTGrading)grading {
+    if (count == 0)
+        return nil;
+
+    return values[[self slotForGrading:grading hash:EXTGradingHash(grading)]];
+}
+
+-(id) objectForKey:(id)aKey {
+    // anything that isn't a location (a key path, say) simply isn't here.
+    if (![aKey respondsToSelector:@selector(grading)])
+        return nil;
+
+    return [self objectForGrading:[(EXTLocation*)aKey grading]];
+}
+
+-(NSEnumerator*) keyEnumerator {
+    return [[self allKeys] objectEnumerator];
+}
+
+-(NSArray*) allKeys {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < capacity; i++)
+        if (keys[i])
+            [ret addObject:keys[i]];
+
+    return ret;
+}
+
+-(NSArray*) allValues {
+    NSMutableArray *ret = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < capacity; i++)
+        if (keys[i])
+            [ret addObject:values[i]];
+
+    return ret;
+}
+
+-(NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state
+                                  objects:(id __unsafe_unretained [])buffer
+                                    count:(NSUInteger)len {
+    if (state->state == 0) {
+        state->state = 1;
+        state->mutationsPtr = &mutations;
+        state->extra[0] = 0;
+    }
+
+    NSUInteger slot = state->extra[0], found = 0;
+    for (; slot < capacity && found < len; slot++)
+        if (keys[slot])
+            buffer[found++] = keys[slot];
+
+    state->extra[0] = slot;
+    state->itemsPtr = buffer;
+
+    return found;
+}
+
+#pragma mark - NSMutableDictionary primitives
+
+-(void) setObject:(id)anObject forKey:(id<NSCopying>)aKey {
+    if (!anObject || ![(id)aKey respondsToSelector:@selector(grading)])
+        [NSException raise:NSInvalidArgumentException
+                    format:@"EXTLocationDictionary needs a location key and "
+                           @"an object, not %@ and %@", aKey, anObject];
+
+    [self growToFit:count + 1];
+
+    EXTGrading grading = [(EXTLocation*)aKey grading];
+    uint64_t hash = EXTGradingHash(grading);
+    NSUInteger slot = [self slotForGrading:grading hash:hash];
+
+    if (!keys[slot]) {
+        keys[slot] = [aKey copyWithZone:nil];
+        gradings[slot] = grading;
+        hashes[slot] = hash;
+        count++;
+    }
+
+    if (gridIndex) {
+        EXTIntPoint point = EXTGridProjectionApply(gridProjection, grading);
+        if (values[slot])
+            [gridIndex removeObject:values[slot] atPoint:point];
+        [gridIndex addObject:anObject atPoint:point];
+    }
+    values[slot] = anObject;
+    mutations++;
+}
+
+-(void) removeObjectForKey:(id)aKey {
+    if (count == 0 || ![aKey respondsToSelector:@selector(grading)])
+        return;
+
+    EXTGrading grading = [(EXTLocation*)aKey grading];
+    NSUInteger mask = capacity - 1,
+               hole = [self slotForGrading:grading hash:EXTGradingHash(grading)];
+    if (!keys[hole])
+        return;
+
+    [gridIndex removeObject:values[hole]
+                    atPoint:EXTGridProjectionApply(gridProjection, grading)];
+    keys[hole] = nil;
+    values[hole] = nil;
+    count--;
+    mutations++;
+
+    // pull back anything further along the run which the hole would otherwise
+    // hide from its home slot.
+    for (NSUInteger slot = (hole + 1) & mask; keys[slot];
+         slot = (slot + 1) & mask) {
+        NSUInteger home = (NSUInteger)hashes[slot] & mask;
+        BOOL reachable = (hole <= slot) ? (hole < home && home <= slot) :
+                                          (hole < home || home <= slot);
+        if (reachable)
+            continue;
+
+        gradings[hole] = gradings[slot];
+        hashes[hole] = hashes[slot];
+        keys[hole] = keys[slot];
+        values[hole] = values[slot];
+        keys[slot] = nil;
+        values[slot] = nil;
+        hole = slot;
+    }
+}
+
+-(void) removeAllObjects {
+    for (NSUInteger i = 0; i < capacity; i++) {
+        keys[i] = nil;
+        values[i] = nil;
+    }
+    count = 0;
+    mutations++;
+    [gridIndex removeAllObjects];
+}
+
+@end
@@ -6,10 +6,9 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 @class EXTMatrix;
-@class EXTTerm;
 
 // this class models "partial definitions" of a matrix.  for instance, we
 // have inference code that determines the differential on the image of a cup
@@ -31,15 +30,58 @@
 
 @end
 
+// the outcome of a column reduction which keeps track of what it did: the
+// reduced matrix is the original one times the transform, and the pivot of
+// row j of the reduced matrix lives in column pivotColumns[j], or in no column
+// at all if that entry is -1.
+@interface EXTColumnReduction : NSObject
+
+@property (strong) EXTMatrix *reduced;
+@property (strong) EXTMatrix *transform;
+@property (strong) NSArray *pivotColumns;
+@property (assign) int rank;
+
+@end
+
 @interface EXTMatrix : NSObject <NSCoding>
 
 @property(assign) NSUInteger characteristic;
 @property(assign) NSUInteger height, width;
 @property(strong) NSMutableData *presentation;
+/// the entries, column-major, for reading only.  a copy shares its entries
+/// with its original until one of them asks for the presentation, which might
+/// be written to, so anything that only reads should come through here.
+-(const int*) entries;
 
 +(EXTMatrix*) matrixWidth:(int)newWidth height:(int)newHeight;
+/// an empty matrix with room set aside for this many columns, for building up
+/// with -appendColumnsOf:.
++(EXTMatrix*) matrixHeight:(int)newHeight capacity:(int)columns;
 -(EXTMatrix*) copy;
-
+/// the matrix whose (columns[e], rows[e]) entry is values[e], for the count
+/// entries given in any order, with those landing on the same spot summed.  it
+/// is stored sparse when few enough of the sums are nonzero.
++(EXTMatrix*) matrixWidth:(int)newWidth
+                   height:(int)newHeight
+                  entries:(size_t)count
+                  columns:(const int*)columns
+                     rows:(const int*)rows
+                   values:(const int*)values
+           characteristic:(NSUInteger)characteristic;
+/// visits the nonzero entries column by column, without disturbing how they're
+/// stored.
+-(void) enumerateNonzeroEntriesUsingBlock:(void (^)(int column, int row,
+                                                    int value))block;
+
+/// sets the columns of other to the right of those of this matrix.
+-(void) appendColumnsOf:(EXTMatrix*)other;
+/// the columns [first, first + count), sharing storage with this matrix, so
+/// that writes to either show up in the other.  the view is good until this
+/// matrix's presentation is resized or replaced.
+-(EXTMatrix*) columnsFrom:(int)first count:(int)count;
+
+/// the kronecker product of left and right, which is held off as an
+/// EXTKroneckerMatrix until somebody needs its entries.
 +(EXTMatrix*) hadamardProduct:(EXTMatrix*)left with:(EXTMatrix*)right;
 +(NSArray*) hadamardVectors:(NSArray*)left with:(NSArray*)right;
 +(EXTMatrix*) includeEvenlySpacedBasis:(int)startDim
@@ -56,6 +98,9 @@
 /// produces a right-inverse to an onto matrix
 -(EXTMatrix*) invertOntoMap;
 -(EXTMatrix*) columnReduce;
+/// column-reduces the rows [0, limit), applying the same column operations
+/// to an identity block as it goes to record the transform.
+-(EXTColumnReduction*) columnReductionWithLimit:(int)limit;
 -(EXTMatrix*) modularReduction;
 -(EXTMatrix*) kernel;
 -(EXTMatrix*) image;
@@ -79,10 +124,22 @@
 +(NSDictionary*) findOrdersOf:(EXTMatrix*)B in:(EXTMatrix*)Z;
 +(int) rankOfMap:(EXTMatrix*)map intoQuotientByTheInclusion:(EXTMatrix*)incl;
 
-// TODO: this signature may not be optimal. do we really want to introduce
-// a dependancy on EXTTerm?
--(NSDictionary*) homologyToHomologyKeysFrom:(EXTTerm*)source
-                                         to:(EXTTerm*)target
-                                     onPage:(int)page;
+@end
+
+// a kronecker product A (x) B that hasn't been written out.  the tensor
+// products of spectral sequences and the leibniz rule both push these through
+// products, reductions and intersections, and each of those can get by on the
+// factors alone: (A (x) B) N is a pair of products with A and B, an image or
+// kernel of A (x) B is built from images and kernels of A and B, and so on.
+// anything else forms the product the first time it touches the presentation.
+@interface EXTKroneckerMatrix : EXTMatrix
+
+/// the factors, or nil once the product has been formed, which another thread
+/// may do at any time.
+@property(strong,readonly) EXTMatrix *left, *right;
+
+/// copies left and right, so that later changes to them don't leak in.
++(EXTKroneckerMatrix*) kroneckerProductOf:(EXTMatrix*)left
+                                     with:(EXTMatrix*)right;
 
 @end
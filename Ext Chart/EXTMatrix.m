@@ -7,7 +7,12 @@
 //
 
 #import "EXTMatrix.h"
-#import "EXTTerm.h"
+#import "EXTBitMatrix.h"
+#import "EXTPrimeField.h"
+#import "EXTSmithForm.h"
+#import "EXTDenseMultiply.h"
+#import "EXTSparseMatrix.h"
+#import "EXTScratch.h"
 
 // little class to keep track of partial subdefinitions of a parent matrix
 @implementation EXTPartialDefinition {
@@ -81,10 +86,333 @@
 
 @end
 
+@implementation EXTColumnReduction
+@end
+
+// the matrices holding one presentation between them: a matrix and its copies.
+@interface EXTPresentationHolders : NSObject {
+@public
+    int count;
+}
+@end
+
+@implementation EXTPresentationHolders
+@end
+
+@interface EXTMatrix ()
+/// consumes matrix, keeping it as the storage if it's sparse enough and
+/// spreading it out into a presentation otherwise.
++(EXTMatrix*) matrixWithSparseMatrix:(EXTSparseMatrix*)matrix
+                      characteristic:(NSUInteger)characteristic;
+/// a sparse copy of the matrix, however it happens to be stored.
+-(EXTSparseMatrix) sparseCopy;
+-(size_t) nonzeroCount;
+/// writes out the entries, column-major, without disturbing how they're stored.
+-(void) getInts:(int*)data;
+/// the entries, column-major, read without disturbing how they're stored:
+/// either the presentation itself or a copy in scratch space, so callers
+/// should hold a mark.
+-(const int*) readOnlyEntries;
+/// drops the entries of this matrix in favor of those of other, which has the
+/// same shape and gives them up.
+-(void) takeEntriesOf:(EXTMatrix*)other;
++(EXTMatrix*) formedKroneckerProductOf:(EXTMatrix*)left
+                                  with:(EXTMatrix*)right
+                        characteristic:(NSUInteger)characteristic;
+@end
+
+@interface EXTKroneckerMatrix ()
+/// left * right computed off the factors of whichever of the two is an
+/// unformed kronecker product, or nil if neither is.
++(EXTMatrix*) productOf:(EXTMatrix*)left
+                   with:(EXTMatrix*)right
+         characteristic:(NSUInteger)characteristic;
+/// the pullback of two unformed kronecker products which share a factor, or
+/// nil if they don't.
++(NSArray*) intersectionOf:(EXTMatrix*)left with:(EXTMatrix*)right;
+/// the factors as they stand, taken together under the lock that -form drops
+/// them under, or NO once the product has been formed.  readers take them
+/// once and work only from what they took, since another thread may form the
+/// product in the meantime.
+-(BOOL) getLeft:(EXTMatrix * __strong *)leftFactor
+          right:(EXTMatrix * __strong *)rightFactor;
+@end
+
+
+#pragma mark - scratch space
+
+// a zeroed matrix whose entries live in this thread's scratch arena.  it's
+// only good until the enclosing EXTScratchRestore, so it mustn't escape the
+// routine that made it.
+static EXTMatrix* EXTScratchMatrix(int width, int height,
+                                   NSUInteger characteristic) {
+    EXTMatrix *ret = [EXTMatrix new];
+    ret.width = width; ret.height = height;
+    ret.characteristic = characteristic;
+    ret.presentation =
+        [NSMutableData dataWithBytesNoCopy:EXTScratchCalloc((size_t)width*height,
+                                                            sizeof(int))
+                                    length:sizeof(int)*width*height
+                              freeWhenDone:NO];
+    
+    return ret;
+}
+
+#pragma mark - characteristic 2
+
+// over F_2 we hand the linear algebra off to the bit-packed routines in
+// EXTBitMatrix, which work a whole word of rows at a time.  these two
+// functions ferry matrices back and forth.
+//
+// XXX: the matrices themselves, and so the pages stored in the terms, still
+// keep a whole int per entry, and every kernel pays for packing and unpacking
+// on the way in and out.  storing characteristic 2 matrices packed to begin
+// with would cut the memory of the stored pages by a factor of 32 and let
+// these two go, but it means teaching the presentation and everything that
+// reads it about a second layout.
+static EXTBitMatrix EXTBitMatrixFromMatrix(EXTMatrix *matrix) {
+    EXTScratchMark mark = EXTScratchSave();
+    EXTBitMatrix ret = EXTBitMatrixFromInts([matrix readOnlyEntries],
+                                            (int)matrix.width,
+                                            (int)matrix.height);
+    EXTScratchRestore(mark);
+    
+    return ret;
+}
+
+// consumes bits.
+static EXTMatrix* EXTMatrixFromBitMatrix(EXTBitMatrix *bits) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:bits->width height:bits->height];
+    ret.characteristic = 2;
+    
+    EXTBitMatrixGetRows(bits, 0, bits->height, ret.presentation.mutableBytes);
+    EXTBitMatrixFree(bits);
+    
+    return ret;
+}
+
+#pragma mark - odd prime characteristic
+
+// the field we're working over, if the characteristic is an odd prime.  the
+// even prime has its own routines above.
+static const EXTPrimeField *EXTOddPrimeFieldOf(EXTMatrix *matrix) {
+    if (matrix.characteristic == 2)
+        return NULL;
+    
+    return EXTPrimeFieldForCharacteristic(matrix.characteristic);
+}
 
+static bool EXTMatrixIsOverField(EXTMatrix *matrix) {
+    return matrix.characteristic == 2 || EXTOddPrimeFieldOf(matrix);
+}
+
+// returns the matrix [matrix; identity], for tracking column operations.  it
+// lives in scratch space.
+static EXTMatrix* EXTMatrixStackedOnIdentity(EXTMatrix *matrix) {
+    EXTMatrix *ret = EXTScratchMatrix((int)matrix.width,
+                                      (int)(matrix.height + matrix.width),
+                                      matrix.characteristic);
+    
+    int *retData = ret.presentation.mutableBytes;
+    const int *data = [matrix entries];
+    for (int i = 0; i < matrix.width; i++) {
+        memcpy(retData + i*ret.height, data + i*matrix.height,
+               sizeof(int)*matrix.height);
+        retData[i*ret.height + matrix.height + i] = 1;
+    }
+    
+    return ret;
+}
+
+// returns the block of rows [firstRow, firstRow + rowCount) of a matrix.
+static EXTMatrix* EXTMatrixRowBlock(EXTMatrix *matrix, int firstRow,
+                                    int rowCount) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)matrix.width height:rowCount];
+    ret.characteristic = matrix.characteristic;
+    
+    int *retData = ret.presentation.mutableBytes;
+    const int *data = [matrix entries];
+    for (int i = 0; i < matrix.width; i++)
+        memcpy(retData + i*rowCount, data + i*matrix.height + firstRow,
+               sizeof(int)*rowCount);
+    
+    return ret;
+}
+
+#pragma mark - sparse matrices
+
+static NSMutableData* EXTDataFromSparseMatrix(const EXTSparseMatrix *matrix) {
+    EXTCountHeapAllocation(sizeof(int) * matrix->width * matrix->height);
+    NSMutableData *ret = [NSMutableData dataWithLength:(sizeof(int) *
+                                                        matrix->width *
+                                                        matrix->height)];
+    EXTSparseMatrixGetInts(matrix, ret.mutableBytes);
+    
+    return ret;
+}
+
+// whether a matrix of this shape and with this many nonzero entries should be
+// handed to the sparse routines rather than the dense ones (or, in
+// characteristic 2, the bit-packed ones).
+static bool EXTSparseRoutinesFavored(size_t nonzeros, NSUInteger width,
+                                     NSUInteger height,
+                                     NSUInteger characteristic) {
+    size_t ratio = (characteristic == 2) ? EXT_SPARSE_MATRIX_BIT_RATIO :
+                                           EXT_SPARSE_MATRIX_RATIO;
+    
+    return nonzeros * ratio <= width * height;
+}
+
+// the field over which the sparse routines should reduce this matrix, or NULL
+// if they shouldn't.
+static const EXTPrimeField *EXTSparseFieldOf(EXTMatrix *matrix) {
+    const EXTPrimeField *field =
+                    EXTPrimeFieldForCharacteristic(matrix.characteristic);
+    
+    if (!field || !EXTSparseRoutinesFavored([matrix nonzeroCount],
+                                            matrix.width, matrix.height,
+                                            matrix.characteristic))
+        return NULL;
+    
+    return field;
+}
 
+#pragma mark - general characteristic
 
-@implementation EXTMatrix
+// the inverse of a modulo n, in [0, n), or 0 if a isn't a unit mod n.
+static int EXTUnitInverse(int a, int n) {
+    int gcd = 0, inverse = 0, t = 0;
+    a %= n;
+    if (a < 0)
+        a += n;
+    
+    EXTComputeGCD(&a, &n, &gcd, &inverse, &t);
+    if (gcd != 1 || n == 1)
+        return 0;
+    
+    inverse %= n;
+    return inverse < 0 ? inverse + n : inverse;
+}
+
+// gauss-jordan column reduction over Z or Z/n of the rows [0, limit) of a
+// matrix, in place.  in each row, euclid's algorithm runs across the unused
+// columns: the one with the smallest entry is subtracted off of the others
+// until it's the only one left, holding the gcd of the row.  it becomes the
+// pivot column, and is subtracted off of the used columns too.  these are all
+// unimodular moves, and they act on entire columns, so rows beyond the limit
+// just ride along and can be used to record the transform.  if pivotColumns is
+// non-NULL, it receives (for each row < limit) the pivot column of that row,
+// or -1.  returns the number of pivots.
+static int EXTIntegralColumnReduce(EXTMatrix *matrix, int limit,
+                                   int *pivotColumns) {
+    int width = (int)matrix.width, height = (int)matrix.height, rank = 0;
+    int *data = matrix.presentation.mutableBytes;
+    EXTScratchMark mark = EXTScratchSave();
+    bool *usedColumns = EXTScratchCalloc(width + 1, sizeof(bool));
+    
+    for (int pivotRow = 0; pivotRow < limit; pivotRow++) {
+        int pivotColumn = -1;
+        
+        while (true) {
+            pivotColumn = -1;
+            for (int j = 0; j < width; j++) {
+                int entry = data[j*height + pivotRow];
+                if (!usedColumns[j] && entry != 0 &&
+                    (pivotColumn == -1 ||
+                     abs(entry) < abs(data[pivotColumn*height + pivotRow])))
+                    pivotColumn = j;
+            }
+            
+            if (pivotColumn == -1)
+                break;
+            
+            int *pivot = data + pivotColumn*height;
+            bool isAlone = true;
+            for (int j = 0; j < width; j++) {
+                int *column = data + j*height;
+                if (usedColumns[j] || j == pivotColumn || column[pivotRow] == 0)
+                    continue;
+                
+                int factor = column[pivotRow] / pivot[pivotRow];
+                for (int i = 0; i < height; i++)
+                    column[i] -= factor * pivot[i];
+                
+                if (column[pivotRow] != 0)
+                    isAlone = false;
+            }
+            
+            // if necessary, put the matrix back in its modular equivalence
+            // class.  this only ever shrinks the remainders.
+            [matrix modularReduction];
+            
+            if (isAlone)
+                break;
+        }
+        
+        if (pivotColumns)
+            pivotColumns[pivotRow] = pivotColumn;
+        if (pivotColumn == -1)
+            continue;
+        
+        usedColumns[pivotColumn] = true;
+        rank++;
+        
+        // the earlier pivot columns can only be reduced modulo this pivot,
+        // unless it's a unit mod n, in which case they can be cleared.  over
+        // Z, the units are +-1, which dividing by clears anyway.
+        int *pivot = data + pivotColumn*height,
+            modulus = (int)matrix.characteristic,
+            inverse = modulus ? EXTUnitInverse(pivot[pivotRow], modulus) : 0;
+        for (int j = 0; j < width; j++) {
+            int *column = data + j*height;
+            if (!usedColumns[j] || j == pivotColumn || column[pivotRow] == 0)
+                continue;
+            
+            if (inverse) {
+                int64_t factor = (int64_t)column[pivotRow] * inverse % modulus;
+                for (int i = 0; i < height; i++)
+                    column[i] = (int)((column[i] - factor * pivot[i]) % modulus);
+                continue;
+            }
+            
+            int factor = column[pivotRow] / pivot[pivotRow];
+            for (int i = 0; i < height; i++)
+                column[i] -= factor * pivot[i];
+        }
+        
+        [matrix modularReduction];
+    }
+    
+    EXTScratchRestore(mark);
+    
+    return rank;
+}
+
+@implementation EXTMatrix {
+    // when this is non-NULL, it holds the entries of the matrix, and
+    // presentation stays nil until somebody asks for it.
+    EXTSparseMatrix *sparse;
+    
+    // a view's presentation points into the storage of another matrix, which
+    // this keeps alive.
+    NSData *owner;
+    
+    // a copy shares the presentation of its original, and holders counts the
+    // matrices sharing it.  reading through -entries leaves it shared; asking
+    // for the presentation, which might mean a write, gives the matrix a copy
+    // of its own, unless it's the last holder left, which can write in place.
+    // a matrix which has lent its storage out to views can't share it, since
+    // the views write straight in.
+    BOOL sharesPresentation, lendsPresentation;
+    EXTPresentationHolders *holders;
+    
+    // the storage this matrix last traded in for a copy of its own, kept alive
+    // for any thread still reading it through -entries.  only the latest is
+    // kept, since a reader is long done with a buffer by the time the matrix
+    // has been copied and swapped out again, and it's let go of as soon as the
+    // matrix is given new storage outright.
+    NSData *retired;
+}
 
 // XXX: somehow change the presentation getter to recompute the presentation off
 // of the partial definitions --- but ideally not every time we need to access
@@ -93,6 +421,188 @@
 @synthesize height, width;
 @synthesize presentation;
 
+-(void) dealloc {
+    [self discardSparseMatrix];
+    [self leavePresentationHolders];
+}
+
+-(void) discardSparseMatrix {
+    if (!sparse)
+        return;
+    
+    EXTSparseMatrixFree(sparse);
+    free(sparse);
+    sparse = NULL;
+}
+
+// stops sharing the presentation with the other holders, without copying it.
+-(void) leavePresentationHolders {
+    if (!sharesPresentation)
+        return;
+    
+    __atomic_sub_fetch(&holders->count, 1, __ATOMIC_ACQ_REL);
+    holders = nil;
+    __atomic_store_n(&sharesPresentation, NO, __ATOMIC_RELEASE);
+}
+
+// once the entries have been spread out, whoever asks for them might write to
+// them, so the sparse form has to go.  this is the one place where reading a
+// matrix changes it, and matrices are read from several threads at once by
+// -[EXTSpectralSequence computeGroupsForPage:], so it happens under a lock.
+-(void) spreadSparseMatrix {
+    if (!__atomic_load_n(&sparse, __ATOMIC_ACQUIRE))
+        return;
+    
+    @synchronized (self) {
+        EXTSparseMatrix *spread = sparse;
+        if (spread) {
+            presentation = EXTDataFromSparseMatrix(spread);
+            __atomic_store_n(&sparse, NULL, __ATOMIC_RELEASE);
+            EXTSparseMatrixFree(spread);
+            free(spread);
+        }
+    }
+}
+
+-(const int*) entries {
+    [self spreadSparseMatrix];
+    
+    return presentation.mutableBytes;
+}
+
+// whoever asks for the presentation might write to it, so a shared one is
+// swapped for a copy of its own first, unless every other holder has already
+// gone its own way.  a holder only leaves once its copy is taken, so the last
+// one never writes in place under a copy in progress.
+-(NSMutableData*) presentation {
+    [self spreadSparseMatrix];
+    
+    if (__atomic_load_n(&sharesPresentation, __ATOMIC_ACQUIRE)) {
+        @synchronized (self) {
+            if (sharesPresentation &&
+                __atomic_load_n(&holders->count, __ATOMIC_ACQUIRE) > 1) {
+                EXTCountHeapAllocation(presentation.length);
+                retired = presentation;
+                presentation = [NSMutableData dataWithData:presentation];
+            }
+            [self leavePresentationHolders];
+        }
+    }
+    
+    return presentation;
+}
+
+-(void) setPresentation:(NSMutableData*)newPresentation {
+    [self discardSparseMatrix];
+    [self leavePresentationHolders];
+    presentation = newPresentation;
+    retired = nil;
+}
+
++(EXTMatrix*) matrixWithSparseMatrix:(EXTSparseMatrix*)matrix
+                      characteristic:(NSUInteger)characteristic {
+    EXTMatrix *ret = [EXTMatrix new];
+    ret.width = matrix->width;
+    ret.height = matrix->height;
+    ret.characteristic = characteristic;
+    
+    if (EXTSparseMatrixNonzeros(matrix) * EXT_SPARSE_MATRIX_RATIO <=
+        (size_t)matrix->width * matrix->height) {
+        EXTCountHeapAllocation(sizeof(EXTSparseMatrix));
+        ret->sparse = malloc(sizeof(EXTSparseMatrix));
+        *ret->sparse = *matrix;
+    } else {
+        ret.presentation = EXTDataFromSparseMatrix(matrix);
+        EXTSparseMatrixFree(matrix);
+    }
+    
+    return ret;
+}
+
++(EXTMatrix*) matrixWidth:(int)newWidth
+                   height:(int)newHeight
+                  entries:(size_t)count
+                  columns:(const int*)columns
+                     rows:(const int*)rows
+                   values:(const int*)values
+           characteristic:(NSUInteger)characteristic {
+    EXTSparseMatrix matrix =
+        EXTSparseMatrixFromTriples(newWidth, newHeight, count, columns, rows,
+                                   values, (int)characteristic);
+    
+    return [EXTMatrix matrixWithSparseMatrix:&matrix
+                              characteristic:characteristic];
+}
+
+-(void) enumerateNonzeroEntriesUsingBlock:(void (^)(int column, int row,
+                                                    int value))block {
+    EXTSparseMatrix matrix = [self sparseCopy];
+    
+    for (int i = 0; i < matrix.width; i++)
+        for (size_t e = matrix.columnStarts[i]; e < matrix.columnStarts[i+1]; e++)
+            block(i, matrix.rows[e], matrix.values[e]);
+    
+    EXTSparseMatrixFree(&matrix);
+}
+
+// the readers of sparse below take the same lock as -presentation, which may
+// spread the sparse entries out and free them from under another thread.
+-(EXTSparseMatrix) sparseCopy {
+    @synchronized (self) {
+        if (sparse)
+            return EXTSparseMatrixCopy(sparse);
+    }
+    
+    return EXTSparseMatrixFromInts(presentation.mutableBytes, (int)width,
+                                   (int)height);
+}
+
+-(size_t) nonzeroCount {
+    @synchronized (self) {
+        if (sparse)
+            return EXTSparseMatrixNonzeros(sparse);
+    }
+    
+    return EXTSparseMatrixCountNonzeros(presentation.mutableBytes, (int)width,
+                                        (int)height);
+}
+
+-(void) getInts:(int*)data {
+    @synchronized (self) {
+        if (sparse) {
+            EXTSparseMatrixGetInts(sparse, data);
+            return;
+        }
+    }
+    
+    memcpy(data, presentation.mutableBytes, sizeof(int)*width*height);
+}
+
+-(const int*) readOnlyEntries {
+    if (!__atomic_load_n(&sparse, __ATOMIC_ACQUIRE))
+        return presentation.mutableBytes;
+    
+    int *ret = EXTScratchAlloc(sizeof(int)*width*height);
+    [self getInts:ret];
+    
+    return ret;
+}
+
+-(void) takeEntriesOf:(EXTMatrix*)other {
+    [self discardSparseMatrix];
+    [self leavePresentationHolders];
+    presentation = other->presentation;
+    sparse = other->sparse;
+    sharesPresentation = other->sharesPresentation;
+    holders = other->holders;
+    
+    other->presentation = nil;
+    other->sparse = NULL;
+    other->sharesPresentation = NO;
+    other->holders = nil;
+    retired = nil;
+}
+
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     if (self = [super init]) {
         characteristic = [aDecoder decodeIntForKey:@"characteristic"];
@@ -108,11 +618,17 @@
     [aCoder encodeInt:characteristic forKey:@"characteristic"];
     [aCoder encodeInt:height forKey:@"height"];
     [aCoder encodeInt:width forKey:@"width"];
-    [aCoder encodeObject:presentation forKey:@"presentation"];
+    @synchronized (self) {
+        [aCoder encodeObject:(sparse ? EXTDataFromSparseMatrix(sparse) :
+                                       presentation)
+                      forKey:@"presentation"];
+    }
 }
 
+// entries are compared modulo the characteristic.  neither matrix is written
+// to, so this is safe on matrices which other threads are reading.
 -(BOOL) isEqual:(id)object {
-    if ([object class] != [EXTMatrix class])
+    if (![object isKindOfClass:[EXTMatrix class]])
         return false;
     
     EXTMatrix *mat = (EXTMatrix*)object;
@@ -122,29 +638,27 @@
         (mat.characteristic != self.characteristic))
         return false;
     
-    int *selfPresentation = self.presentation.mutableBytes,
-        *matPresentation = mat.presentation.mutableBytes;
+    EXTScratchMark mark = EXTScratchSave();
+    const int *selfData = [self readOnlyEntries],
+              *matData = [mat readOnlyEntries];
+    int modulus = (int)self.characteristic;
+    size_t count = (size_t)self.width*self.height;
     
-    for (int i = 0; i < self.width; i++)
-        for (int j = 0; j < self.height; j++) {
-            int s = selfPresentation[i*self.height+j],
-                m = matPresentation[i*mat.height+j];
-            
-            if (s >= self.characteristic && self.characteristic != 0) {
-                s %= self.characteristic;
-                selfPresentation[i*self.height+j] = s;
-            }
-            
-            if (m >= self.characteristic && self.characteristic != 0) {
-                m %= self.characteristic;
-                matPresentation[i*mat.height+j] = m;
-            }
-            
-            if (s != m)
-                return false;
+    bool ret = true;
+    for (size_t i = 0; i < count && ret; i++) {
+        int s = selfData[i], m = matData[i];
+        
+        if (modulus) {
+            s %= modulus; if (s < 0) s += modulus;
+            m %= modulus; if (m < 0) m += modulus;
         }
+        
+        ret = (s == m);
+    }
     
-    return true;
+    EXTScratchRestore(mark);
+    
+    return ret;
 }
 
 // initializes an EXTMatrix object and allocates all the NSMutableArrays
@@ -157,11 +671,45 @@
     [obj setWidth:newWidth];
     [obj setCharacteristic:0];
     
+    EXTCountHeapAllocation(sizeof(int)*newHeight*newWidth);
     obj.presentation = [NSMutableData dataWithLength:(sizeof(int)*newHeight*newWidth)];
     
     return obj;
 }
 
++(EXTMatrix*) matrixHeight:(int)newHeight capacity:(int)columns {
+    EXTMatrix *ret = [EXTMatrix new];
+    ret.height = newHeight;
+    
+    EXTCountHeapAllocation(sizeof(int)*newHeight*columns);
+    ret.presentation = [NSMutableData dataWithCapacity:(sizeof(int)*newHeight*columns)];
+    
+    return ret;
+}
+
+-(void) appendColumnsOf:(EXTMatrix*)other {
+    [self.presentation appendBytes:[other entries]
+                            length:sizeof(int)*other.width*other.height];
+    width += other.width;
+}
+
+-(EXTMatrix*) columnsFrom:(int)first count:(int)count {
+    EXTMatrix *ret = [EXTMatrix new];
+    ret.width = count; ret.height = height;
+    ret.characteristic = characteristic;
+    
+    NSMutableData *data = self.presentation;
+    lendsPresentation = YES;
+    ret.presentation =
+        [NSMutableData dataWithBytesNoCopy:((int*)data.mutableBytes +
+                                            (size_t)first*height)
+                                    length:sizeof(int)*count*height
+                              freeWhenDone:NO];
+    ret->owner = data;
+    
+    return ret;
+}
+
 +(NSArray*) hadamardVectors:(NSArray*)left with:(NSArray*)right {
     EXTMatrix *leftMat = [EXTMatrix matrixWidth:1 height:left.count],
               *rightMat = [EXTMatrix matrixWidth:1 height:right.count];
@@ -187,23 +735,46 @@
 }
 
 +(EXTMatrix*) hadamardProduct:(EXTMatrix*)left with:(EXTMatrix*)right {
+    return [EXTKroneckerMatrix kroneckerProductOf:left with:right];
+}
+
++(EXTMatrix*) formedKroneckerProductOf:(EXTMatrix*)left
+                                  with:(EXTMatrix*)right
+                        characteristic:(NSUInteger)characteristic {
+    // the product has exactly as many nonzero entries as its factors do
+    // between them, so a sparse factor -- an identity, say -- means a sparse
+    // product, which we never spread out.
+    if (EXTSparseRoutinesFavored([left nonzeroCount] * [right nonzeroCount],
+                                 left.width * right.width,
+                                 left.height * right.height, characteristic)) {
+        EXTSparseMatrix leftSparse = [left sparseCopy],
+                        rightSparse = [right sparseCopy],
+                        product = EXTSparseMatrixKronecker(&leftSparse,
+                                                           &rightSparse,
+                                                           (int)characteristic);
+        EXTSparseMatrixFree(&leftSparse);
+        EXTSparseMatrixFree(&rightSparse);
+        
+        return [EXTMatrix matrixWithSparseMatrix:&product
+                                  characteristic:characteristic];
+    }
+    
     EXTMatrix *ret = [EXTMatrix matrixWidth:(left.width*right.width)
                                      height:(left.height*right.height)];
-    if (left.characteristic == right.characteristic)
-        ret.characteristic = left.characteristic;
-    else {
-        int a = left.characteristic,
-            b = right.characteristic,
-            gcd = 0;
-        
-        EXTComputeGCD(&a, &b, &gcd, NULL, NULL);
+    ret.characteristic = characteristic;
+    
+    if (ret.characteristic == 2) {
+        EXTBitMatrix leftBits = EXTBitMatrixFromMatrix(left),
+                     rightBits = EXTBitMatrixFromMatrix(right),
+                     product = EXTBitMatrixKronecker(&leftBits, &rightBits);
+        EXTBitMatrixFree(&leftBits);
+        EXTBitMatrixFree(&rightBits);
         
-        ret.characteristic = gcd;
+        return EXTMatrixFromBitMatrix(&product);
     }
     
-    int *retData = ret.presentation.mutableBytes,
-        *leftData = left.presentation.mutableBytes,
-        *rightData = right.presentation.mutableBytes;
+    int *retData = ret.presentation.mutableBytes;
+    const int *leftData = [left entries], *rightData = [right entries];
     
     for (int i = 0; i < left.width; i++) {
         for (int j = 0; j < right.width; j++) {
@@ -225,26 +796,34 @@
                                 endDim:(int)endDim
                                 offset:(int)offset
                                spacing:(int)spacing {
-    EXTMatrix *ret = [EXTMatrix matrixWidth:startDim height:endDim];
-    
-    int *data = ret.presentation.mutableBytes;
+    EXTSparseMatrix inclusion = EXTSparseMatrixCreateIdentity(startDim);
     
-    // poke some 1s into the right places :)
+    // poke the 1s into the right rows :)
+    inclusion.height = endDim;
     for (int i = 0; i < startDim; i++)
-        data[(offset+spacing*i)*ret.height+i] = 1;
+        inclusion.rows[i] = offset + spacing*i;
     
-    return ret;
+    return [EXTMatrix matrixWithSparseMatrix:&inclusion characteristic:0];
 }
 
 // allocates and initializes a new matrix 
 +(EXTMatrix*) copyTranspose:(EXTMatrix *)input {
-    EXTMatrix *ret = [EXTMatrix new];
-    ret.width = input.height; ret.height = input.width;
+    if (EXTSparseRoutinesFavored([input nonzeroCount], input.width,
+                                 input.height, 0)) {
+        EXTSparseMatrix matrix = [input sparseCopy],
+                        transpose = EXTSparseMatrixTranspose(&matrix);
+        EXTSparseMatrixFree(&matrix);
+        
+        return [EXTMatrix matrixWithSparseMatrix:&transpose
+                                  characteristic:input.characteristic];
+    }
+    
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)input.height
+                                     height:(int)input.width];
     ret.characteristic = input.characteristic;
-    ret.presentation = [NSMutableData dataWithLength:input.presentation.length];
     
-    int *inputBytes = input.presentation.mutableBytes,
-        *retBytes = ret.presentation.mutableBytes;
+    const int *inputBytes = [input entries];
+    int *retBytes = ret.presentation.mutableBytes;
     
     for (int i = 0; i < input.width; i++)
         for (int j = 0; j < input.height; j++)
@@ -258,6 +837,13 @@
     if (self.characteristic == 0)
         return self;
     
+    @synchronized (self) {
+        if (sparse) {
+            EXTSparseMatrixReduce(sparse, (int)self.characteristic);
+            return self;
+        }
+    }
+    
     int *data = self.presentation.mutableBytes;
     
     for (int i = 0; i < width; i++)
@@ -271,194 +857,171 @@
 -(EXTMatrix*) copy {
     EXTMatrix *copy = [EXTMatrix new];
     copy.width = width; copy.height = height;
-    copy.presentation = [NSMutableData dataWithData:self.presentation];
+    @synchronized (self) {
+        if (sparse) {
+            EXTCountHeapAllocation(sizeof(EXTSparseMatrix));
+            copy->sparse = malloc(sizeof(EXTSparseMatrix));
+            *copy->sparse = EXTSparseMatrixCopy(sparse);
+        }
+    }
+    if (!copy->sparse) {
+        @synchronized (self) {
+            if (!owner && !lendsPresentation && !sparse) {
+                if (!sharesPresentation) {
+                    holders = [EXTPresentationHolders new];
+                    holders->count = 1;
+                    __atomic_store_n(&sharesPresentation, YES, __ATOMIC_RELEASE);
+                }
+                __atomic_add_fetch(&holders->count, 1, __ATOMIC_ACQ_REL);
+                copy->presentation = presentation;
+                copy->holders = holders;
+                copy->sharesPresentation = YES;
+            }
+        }
+    }
+    if (!copy->sparse && !copy->sharesPresentation) {
+        EXTCountHeapAllocation(sizeof(int)*width*height);
+        copy.presentation =
+            [NSMutableData dataWithBytes:[self entries]
+                                  length:sizeof(int)*width*height];
+    }
     copy.characteristic = self.characteristic;
     
     return copy;
 }
 
--(NSArray*) columnReduceWithRightFactor:(bool)dealWithFactor
-                               andLimit:(int)limit {
-    EXTMatrix *ret = [self copy],
-              *rightFactor = nil;
-    if (dealWithFactor)
-        rightFactor = [EXTMatrix identity:self.width];
+// column-reduces a copy of a matrix over F_p, reporting the pivot column of
+// each row in pivotColumns (which should have room for self.height entries).
+// returns the reduced matrix, or nil if the characteristic isn't prime.  the
+// reduced matrix may live in scratch space, so callers should hold a mark.
+-(EXTMatrix*) fieldReductionWithPivotColumns:(int*)pivotColumns
+                                        rank:(int*)rank {
+    const EXTPrimeField *sparseField = EXTSparseFieldOf(self);
+    if (sparseField) {
+        EXTSparseMatrix reduced = [self sparseCopy];
+        *rank = EXTSparseMatrixColumnReduce(sparseField, &reduced,
+                                            (int)self.height, pivotColumns);
+        return [EXTMatrix matrixWithSparseMatrix:&reduced
+                                  characteristic:self.characteristic];
+    }
     
-    int *retData = ret.presentation.mutableBytes;
+    if (self.characteristic == 2) {
+        EXTBitMatrix bits = EXTBitMatrixFromMatrix(self);
+        *rank = EXTBitMatrixColumnReduce(&bits, NULL, (int)self.height,
+                                         pivotColumns);
+        return EXTMatrixFromBitMatrix(&bits);
+    }
     
-    // manually allocated data
-    bool *usedColumns = calloc(sizeof(bool), width);
-    int *row = calloc(sizeof(int), width),
-        *rowToBezout = calloc(sizeof(int), width),
-        *bezout = calloc(sizeof(int), width);
+    const EXTPrimeField *field = EXTOddPrimeFieldOf(self);
+    if (!field)
+        return nil;
     
-    for (int pivotRow = 0, pivotColumn = 0;
-         pivotRow < limit;
-         pivotRow++) {
-        
-        int j, firstNonzeroEntry = -1;
-        memset(row, 0, width*sizeof(int));
-        memset(rowToBezout, 0, width*sizeof(int));
-        
-        // save this row for analysis.
-        for (int k = 0; k < width; k++) {
-            row[k] = retData[k*ret.height + pivotRow];
-            
-            if (usedColumns[k])
-                rowToBezout[k] = 0;
-            else
-                rowToBezout[k] = retData[k*ret.height+pivotRow];
-            
-            if (firstNonzeroEntry == -1 && row[k] != 0)
-                firstNonzeroEntry = k;
-        }
-        
-        if (firstNonzeroEntry == -1)
-            continue;
-        
-        // compute the bezout vector for this row.
-        memset(bezout, 0, width*sizeof(int));
-        int gcd = rowToBezout[firstNonzeroEntry];
-        for (int k = 0; k < firstNonzeroEntry; k++)
-            bezout[k] = 0;
-        bezout[firstNonzeroEntry] = 1;
-        
-        for (NSInteger index = firstNonzeroEntry + 1;
-             index < width;
-             index++) {
-            
-            // don't look at this column if it's already been used.
-            if (usedColumns[index]) {
-                bezout[index] = 0;
-                continue;
-            }
-            
-            // if this can't contribute anything, don't even bother with it.
-            if (row[index] == 0) {
-                bezout[index] = 0;
-                continue;
-            }
-            
-            int a = gcd,
-                b = row[index],
-                newGcd = 0,
-                r = 0,
-                s = 0;
-            
-            EXTComputeGCD(&a, &b, &newGcd, &r, &s);
-            
-            if (abs(gcd) == abs(newGcd)) {
-                bezout[index] = 0;
-                continue;
-            }
-            
-            gcd = newGcd;
-            bezout[index] = s;
-            for (NSInteger j = 0; j < index; j++)
-                bezout[j] = bezout[j] * r;
-        }
-        
-        // find the first nonzero entry in this row, right of where we're at
-        int highStrikerValue = 0, highStrikerKey = width;
-        for (j = 0; j < width; j++) {
-            if (usedColumns[j])
-                continue;
-            if (0 != bezout[j]) {
-                if (abs(row[j]) > highStrikerValue) {
-                    highStrikerKey = j;
-                    highStrikerValue = abs(row[j]);
-                }
-            }
-        }
+    EXTMatrix *ret = EXTScratchMatrix((int)width, (int)height, characteristic);
+    [self getInts:ret.presentation.mutableBytes];
+    *rank = EXTPrimeFieldColumnReduce(field, ret.presentation.mutableBytes,
+                                      (int)ret.width, (int)ret.height,
+                                      (int)ret.height, pivotColumns);
+    
+    return ret;
+}
+
+-(EXTColumnReduction*) columnReductionWithLimit:(int)limit {
+    limit = MIN(limit, (int)self.height);
+    
+    EXTColumnReduction *ret = [EXTColumnReduction new];
+    EXTScratchMark mark = EXTScratchSave();
+    int *pivotColumns = EXTScratchAlloc(sizeof(int)*(limit + 1));
+    const EXTPrimeField *sparseField = EXTSparseFieldOf(self);
+    
+    if (sparseField) {
+        EXTSparseMatrix matrix = [self sparseCopy],
+                        augmented = EXTSparseMatrixStackedOnIdentity(&matrix);
+        EXTSparseMatrixFree(&matrix);
         
-        // if we found a nonzero entry, then this is the new pivot column.
-        // if we didn't, then we should skip this row entirely.
-        if (highStrikerKey == width)
-            continue;
-        else {
-            pivotColumn = highStrikerKey;
-            usedColumns[highStrikerKey] = true;
-        }
+        ret.rank = EXTSparseMatrixColumnReduce(sparseField, &augmented, limit,
+                                               pivotColumns);
         
-        // if we've made it here, then we have a new pivot location, and we're
-        // tasked with clearing the rest of the row of nonzero entries.
-        //
-        // start by replacing this column with the Bezout-weighted sum of the
-        // old columns.
-        for (int i = 0; i < ret.height; i++) {
-            int newVal = 0;
-            for (int j = 0; j < width; j++)
-                newVal += bezout[j] * retData[ret.height*j+i];
-            retData[ret.height*pivotColumn+i] = newVal;
-        }
+        EXTSparseMatrix reduced = EXTSparseMatrixRowBlock(&augmented, 0,
+                                                          (int)self.height),
+                        transform = EXTSparseMatrixRowBlock(&augmented,
+                                                            (int)self.height,
+                                                            (int)self.width);
+        EXTSparseMatrixFree(&augmented);
         
-        EXTMatrix *rightmostFactor = nil;
-        int *rightmostData = nil;
-        if (dealWithFactor) {
-            rightmostFactor = [EXTMatrix identity:self.width];
-            rightmostData = rightmostFactor.presentation.mutableBytes;
-            for (int j = 0; j < width; j++)
-                rightmostData[pivotColumn*rightmostFactor.height+j] = bezout[j];
-        }
+        ret.reduced = [EXTMatrix matrixWithSparseMatrix:&reduced
+                                         characteristic:self.characteristic];
+        ret.transform = [EXTMatrix matrixWithSparseMatrix:&transform
+                                           characteristic:self.characteristic];
+    } else if (self.characteristic == 2) {
+        EXTBitMatrix reduced = EXTBitMatrixFromMatrix(self),
+                     transform = EXTBitMatrixCreateIdentity((int)self.width);
+        ret.rank = EXTBitMatrixColumnReduce(&reduced, &transform, limit,
+                                            pivotColumns);
+        ret.reduced = EXTMatrixFromBitMatrix(&reduced);
+        ret.transform = EXTMatrixFromBitMatrix(&transform);
+    } else {
+        // column operations act on whole columns, so running them on
+        // [self; identity] with pivots restricted to the rows of self leaves
+        // the transform in the bottom block.
+        EXTMatrix *augmented = EXTMatrixStackedOnIdentity(self);
+        const EXTPrimeField *field = EXTOddPrimeFieldOf(self);
         
-        // then iterate through the other columns...
-        for (j = 0; j < width; j++) {
-            //NSMutableArray *workingColumn = ret.presentation[j],
-            //               *factorColumn = rightmostFactor.presentation[j];
-            
-            // skip the column if this row is already zeroed out.
-            if (retData[j*ret.height+pivotRow] == 0)
-                continue;
-            
-            // XXX: I think that this is lethal behavior; we can't use this to
-            // run -invert if we don't do this part of the factorization too.
-            //
-            // also skip the column if it's already been used & so is stuck.
-            //if ([usedColumns[j] intValue])
-            //    continue;
-            
-            // skip the present pivot column too.
-            if (pivotColumn == j)
-                continue;
-            
-            // NOTE: this is *always* an integer, because the pivotRow entry of
-            // our pivotColumn now contains the gcd of all the pivotRow values.
-            int factor = 0;
-            if (retData[pivotColumn*ret.height+pivotRow] != 0)
-                factor = retData[j*ret.height+pivotRow] /
-                                    retData[pivotColumn*ret.height+pivotRow];
-            
-            // ... and for each entry in this column, subtract.
-            for (int i = 0; i < height; i++) {
-                retData[j*ret.height+i] -= factor * retData[pivotColumn*ret.height+i];
-            }
-            
-            if (dealWithFactor) {
-                for (int i = 0; i < width; i++) {
-                    rightmostData[j*rightmostFactor.height+i] -= factor * bezout[i];
-                }
-            }
-        }
-        
-        // if necessary, put the matrix back in its modular equivalence class.
-        [ret modularReduction];
+        if (field)
+            ret.rank = EXTPrimeFieldColumnReduce(field,
+                                        augmented.presentation.mutableBytes,
+                                        (int)augmented.width,
+                                        (int)augmented.height,
+                                        limit, pivotColumns);
+        else
+            ret.rank = EXTIntegralColumnReduce(augmented, limit, pivotColumns);
         
-        if (dealWithFactor)
-            rightFactor = [EXTMatrix newMultiply:rightFactor by:rightmostFactor];
+        ret.reduced = EXTMatrixRowBlock(augmented, 0, (int)self.height);
+        ret.transform = EXTMatrixRowBlock(augmented, (int)self.height,
+                                          (int)self.width);
+    }
+    
+    NSMutableArray *pivots = [NSMutableArray arrayWithCapacity:limit];
+    for (int j = 0; j < limit; j++)
+        pivots[j] = @(pivotColumns[j]);
+    ret.pivotColumns = pivots;
+    
+    EXTScratchRestore(mark);
+    
+    return ret;
+}
+
+-(NSArray*) columnReduceWithRightFactor:(bool)dealWithFactor
+                               andLimit:(int)limit {
+    if (dealWithFactor) {
+        EXTColumnReduction *reduction = [self columnReductionWithLimit:limit];
+        return @[reduction.reduced, reduction.transform];
     }
     
-    // manually deallocate data
-    free(usedColumns);
-    free(rowToBezout);
-    free(row);
-    free(bezout);
-    usedColumns = NULL;
-    rowToBezout = row = bezout = NULL;
+    limit = MIN(limit, (int)self.height);
     
-    if (dealWithFactor)
-        return @[ret, rightFactor];
+    const EXTPrimeField *sparseField = EXTSparseFieldOf(self);
+    if (sparseField) {
+        EXTSparseMatrix reduced = [self sparseCopy];
+        EXTSparseMatrixColumnReduce(sparseField, &reduced, limit, NULL);
+        return @[[EXTMatrix matrixWithSparseMatrix:&reduced
+                                    characteristic:self.characteristic]];
+    }
+    
+    if (self.characteristic == 2) {
+        EXTBitMatrix reduced = EXTBitMatrixFromMatrix(self);
+        EXTBitMatrixColumnReduce(&reduced, NULL, limit, NULL);
+        return @[EXTMatrixFromBitMatrix(&reduced)];
+    }
+    
+    EXTMatrix *ret = [self copy];
+    const EXTPrimeField *field = EXTOddPrimeFieldOf(self);
+    if (field)
+        EXTPrimeFieldColumnReduce(field, ret.presentation.mutableBytes,
+                                  (int)ret.width, (int)ret.height, limit, NULL);
     else
-        return @[ret];
+        EXTIntegralColumnReduce(ret, limit, NULL);
+    
+    return @[ret];
 }
 
 // runs gaussian column reduction on a matrix over Z.  useful for finding a
@@ -469,48 +1032,74 @@
 
 // returns a basis for the kernel of a matrix
 -(EXTMatrix*) kernel {
-    // vertically augment the matrix by an identity matrix
-    EXTMatrix *augmentedMatrix = [EXTMatrix matrixWidth:self.width height:(self.height + self.width)];
-    augmentedMatrix.characteristic = self.characteristic;
-    
-    int *data = self.presentation.mutableBytes,
-        *augmentedData = augmentedMatrix.presentation.mutableBytes;
-    
-    for (int i = 0; i < self.width; i++) {
-        // copy over the top of the matrix
-        for (int j = 0; j < self.height; j++)
-            augmentedData[i*augmentedMatrix.height + j] = data[i*self.height + j];
+    const EXTPrimeField *sparseField = EXTSparseFieldOf(self);
+    if (sparseField) {
+        EXTSparseMatrix matrix = [self sparseCopy],
+                        kernel = EXTSparseMatrixKernel(sparseField, &matrix);
+        EXTSparseMatrixFree(&matrix);
+        
+        return [EXTMatrix matrixWithSparseMatrix:&kernel
+                                  characteristic:self.characteristic];
     }
-    for (int i = 0; i < self.width; i++)
-        augmentedData[i*augmentedMatrix.height + i + self.height] = 1;
-    
-    // column-reduce the augmented matrix
-    EXTMatrix *reducedMatrix = [augmentedMatrix columnReduce];
-    
-    // read off the augmented columns corresponding to zero columns in the orig
-    EXTMatrix *ret = [EXTMatrix matrixWidth:0 height:self.width];
-    
-    int *reducedData = reducedMatrix.presentation.mutableBytes;
     
-    for (int i = 0; i < reducedMatrix.width; i++) {
-        // test to see if the original column is full of zeroes
-        bool skipme = false;
-        for (int j = 0; j < self.height; j++)
-            if (reducedData[i*reducedMatrix.height+j] != 0)
-                skipme = true;
-        if (skipme)   // if we found nonzero entries...
-            continue; // ... skip this column.
+    if (self.characteristic == 2) {
+        EXTBitMatrix bits = EXTBitMatrixFromMatrix(self),
+                     kernel = EXTBitMatrixKernel(&bits);
+        EXTBitMatrixFree(&bits);
         
-        // otherwise, there's something here to copy.
-        // 1) stretch the return matrix
-        ret.width += 1;
-        [ret.presentation increaseLengthBy:(sizeof(int)*self.width)];
+        return EXTMatrixFromBitMatrix(&kernel);
+    }
+    
+    const EXTPrimeField *field = EXTOddPrimeFieldOf(self);
+    if (field) {
+        EXTScratchMark mark = EXTScratchSave();
+        EXTMatrix *augmented = EXTMatrixStackedOnIdentity(self);
+        int *augmentedData = augmented.presentation.mutableBytes;
+        int rank = EXTPrimeFieldColumnReduce(field, augmentedData,
+                                             (int)augmented.width,
+                                             (int)augmented.height,
+                                             (int)self.height, NULL);
         
+        // the columns whose top part vanished carry the kernel underneath.
+        EXTMatrix *ret = [EXTMatrix matrixWidth:(int)(self.width - rank)
+                                         height:(int)self.width];
+        ret.characteristic = self.characteristic;
         int *retData = ret.presentation.mutableBytes;
+        for (int i = 0, column = 0; i < augmented.width; i++) {
+            int *augmentedColumn = augmentedData + i*augmented.height;
+            bool isZero = true;
+            for (int j = 0; j < self.height && isZero; j++)
+                isZero = (augmentedColumn[j] == 0);
+            if (!isZero)
+                continue;
+            
+            memcpy(retData + (column++)*ret.height,
+                   augmentedColumn + self.height, sizeof(int)*ret.height);
+        }
+        
+        EXTScratchRestore(mark);
         
-        // 2) copy the new column vector
-        for (int j = self.height; j < reducedMatrix.height; j++)
-            retData[(ret.width-1)*ret.height+(j-self.height)] = reducedData[i*reducedMatrix.height+j];
+        return ret;
+    }
+    
+    // the columns which reduced to zero record the relations we're after.
+    EXTColumnReduction *reduction = [self columnReductionWithLimit:(int)self.height];
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)(self.width - reduction.rank)
+                                     height:(int)self.width];
+    ret.characteristic = self.characteristic;
+    
+    int *retData = ret.presentation.mutableBytes,
+        *reducedData = reduction.reduced.presentation.mutableBytes,
+        *transformData = reduction.transform.presentation.mutableBytes;
+    for (int i = 0, column = 0; i < self.width; i++) {
+        bool isZero = true;
+        for (int j = 0; j < self.height && isZero; j++)
+            isZero = (reducedData[i*self.height + j] == 0);
+        if (!isZero)
+            continue;
+        
+        memcpy(retData + (column++)*ret.height,
+               transformData + i*self.width, sizeof(int)*ret.height);
     }
     
     // that's a basis for the kernel!
@@ -519,8 +1108,56 @@
 
 // returns a basis for the image of a matrix
 -(EXTMatrix*) image {
+    const EXTPrimeField *sparseField = EXTSparseFieldOf(self);
+    if (sparseField) {
+        EXTSparseMatrix matrix = [self sparseCopy],
+                        image = EXTSparseMatrixImage(sparseField, &matrix);
+        EXTSparseMatrixFree(&matrix);
+        
+        return [EXTMatrix matrixWithSparseMatrix:&image
+                                  characteristic:self.characteristic];
+    }
+    
+    if (self.characteristic == 2) {
+        EXTBitMatrix bits = EXTBitMatrixFromMatrix(self),
+                     image = EXTBitMatrixImage(&bits);
+        EXTBitMatrixFree(&bits);
+        
+        return EXTMatrixFromBitMatrix(&image);
+    }
+    
+    if (EXTOddPrimeFieldOf(self)) {
+        EXTScratchMark mark = EXTScratchSave();
+        int rank = 0;
+        int *pivotColumns = EXTScratchAlloc(sizeof(int)*(self.height + 1));
+        EXTMatrix *reduced = [self fieldReductionWithPivotColumns:pivotColumns
+                                                             rank:&rank];
+        
+        // over a field the pivot columns are exactly the nonzero ones, and
+        // keeping them in column order matches the general routine below.
+        bool *isPivot = EXTScratchCalloc(self.width + 1, sizeof(bool));
+        for (int j = 0; j < self.height; j++)
+            if (pivotColumns[j] != -1)
+                isPivot[pivotColumns[j]] = true;
+        
+        EXTMatrix *ret = [EXTMatrix matrixWidth:rank height:(int)self.height];
+        ret.characteristic = self.characteristic;
+        int *retData = ret.presentation.mutableBytes,
+            *reducedData = reduced.presentation.mutableBytes;
+        for (int i = 0, column = 0; i < reduced.width; i++)
+            if (isPivot[i])
+                memcpy(retData + (column++)*ret.height,
+                       reducedData + i*reduced.height, sizeof(int)*ret.height);
+        
+        EXTScratchRestore(mark);
+        
+        return ret;
+    }
+    
     EXTMatrix *reduced = [self columnReduce];
-    EXTMatrix *ret = [EXTMatrix matrixWidth:0 height:self.height];
+    EXTMatrix *ret = [EXTMatrix matrixHeight:(int)self.height
+                                    capacity:(int)reduced.width];
+    ret.characteristic = self.characteristic;
     
     int *reducedData = reduced.presentation.mutableBytes;
     
@@ -536,13 +1173,7 @@
             continue; // so skip it.
         
         // and, if it's not all zeroes, we should add it to the collection.
-        // 1) expand the array
-        ret.width += 1;
-        [ret.presentation increaseLengthBy:(sizeof(int)*reduced.height)];
-        int *retData = ret.presentation.mutableBytes;
-        // 2) copy the image vector over
-        for (int j = 0; j < reduced.height; j++)
-            retData[(ret.width-1)*ret.height+j] = reducedData[i*reduced.height+j];
+        [ret appendColumnsOf:[reduced columnsFrom:i count:1]];
     }
     
     return ret;
@@ -553,7 +1184,7 @@
     if (left.width != right.height)
         NSLog(@"Mismatched multiplication.");
     
-    EXTMatrix *product = [EXTMatrix matrixWidth:right.width height:left.height];
+    NSUInteger characteristic;
     {
         int a = left.characteristic,
             b = right.characteristic,
@@ -561,12 +1192,55 @@
         
         EXTComputeGCD(&a, &b, &gcd, NULL, NULL);
         
-        product.characteristic = gcd;
+        characteristic = gcd;
     }
     
-    int *leftData = left.presentation.mutableBytes,
-        *rightData = right.presentation.mutableBytes,
-        *productData = product.presentation.mutableBytes;
+    EXTMatrix *structured = [EXTKroneckerMatrix productOf:left with:right
+                                           characteristic:characteristic];
+    if (structured)
+        return structured;
+    
+    // the work is proportional to the nonzero entries of left, one pass over
+    // them for each entry of right.
+    if (left.width == right.height &&
+        EXTSparseRoutinesFavored([left nonzeroCount], left.width, left.height,
+                                 characteristic)) {
+        EXTSparseMatrix leftSparse = [left sparseCopy],
+                        rightSparse = [right sparseCopy],
+                        product = EXTSparseMatrixMultiply(&leftSparse,
+                                                          &rightSparse,
+                                                          (int)characteristic);
+        EXTSparseMatrixFree(&leftSparse);
+        EXTSparseMatrixFree(&rightSparse);
+        
+        return [EXTMatrix matrixWithSparseMatrix:&product
+                                  characteristic:characteristic];
+    }
+    
+    if (characteristic == 2 && left.width == right.height) {
+        EXTBitMatrix leftBits = EXTBitMatrixFromMatrix(left),
+                     rightBits = EXTBitMatrixFromMatrix(right),
+                     productBits = EXTBitMatrixMultiply(&leftBits, &rightBits);
+        EXTBitMatrixFree(&leftBits);
+        EXTBitMatrixFree(&rightBits);
+        
+        return EXTMatrixFromBitMatrix(&productBits);
+    }
+    
+    EXTMatrix *product = [EXTMatrix matrixWidth:right.width height:left.height];
+    product.characteristic = characteristic;
+    
+    if (left.width == right.height) {
+        EXTDenseMultiply([left entries], [right entries],
+                         product.presentation.mutableBytes,
+                         (int)left.height, (int)left.width, (int)right.width,
+                         product.characteristic);
+        
+        return product;
+    }
+    
+    const int *leftData = [left entries], *rightData = [right entries];
+    int *productData = product.presentation.mutableBytes;
     
     for (int k = 0; k < [right width]; k++)
         for (int i = 0; i < [left height]; i++)
@@ -597,45 +1271,48 @@
 }
 
 +(EXTMatrix*) identity:(int)width {
-    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:width];
-    
-    int *retData = ret.presentation.mutableBytes;
-    
-    for (int i = 0; i < width; i++)
-        retData[i*ret.height+i] = 1;
+    EXTSparseMatrix identity = EXTSparseMatrixCreateIdentity(width);
     
-    return ret;
+    return [EXTMatrix matrixWithSparseMatrix:&identity characteristic:0];
 }
 
 -(EXTMatrix*) invert {
     if (height != width)
         return nil;
     
-    // augment the matrix by the identity
-    EXTMatrix *temp = [self copy];
-    [temp.presentation increaseLengthBy:(sizeof(int)*height*width)];
-    
-    int *tempData = temp.presentation.mutableBytes;
-    for (int i = 0; i < temp.height; i++)
-        tempData[(temp.width + i)*(temp.height) + i] = 1;
-    temp.width *= 2;
-    
-    // TODO: are these two calls to copyTranspose wasteful?
-    // perform column reduction
-    EXTMatrix *flip = [EXTMatrix copyTranspose:temp];
-    [flip columnReduce];
-    EXTMatrix *unflip = [EXTMatrix copyTranspose:flip];
+    // reduction turns an invertible matrix into a permutation matrix scaled by
+    // units, so its inverse is the transform with columns put back in pivot
+    // order and divided by those units.
+    EXTColumnReduction *reduction = [self columnReductionWithLimit:(int)height];
+    if (reduction.rank != width)
+        return nil;
     
-    // peel off the inverse from the augmented portion
-    // XXX: some kind of error checking would be nice
-    EXTMatrix *ret = [EXTMatrix matrixWidth:self.width height:self.width];
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)width height:(int)width];
     ret.characteristic = self.characteristic;
     
     int *retData = ret.presentation.mutableBytes,
-        *unflipData = unflip.presentation.mutableBytes;
-    for (int i = 0; i < self.width; i++) {
-        for (int j = 0; j < self.height; j++)
-            retData[i*self.height + j] = unflipData[(i+self.width)*(self.height)+j];
+        *reducedData = reduction.reduced.presentation.mutableBytes,
+        *transformData = reduction.transform.presentation.mutableBytes;
+    for (int j = 0; j < height; j++) {
+        int pivotColumn = [reduction.pivotColumns[j] intValue],
+            pivot = reducedData[pivotColumn*height + j],
+            modulus = (int)self.characteristic,
+            inverse = 0;
+        
+        // over Z/n the pivot only needs to be a unit mod n: then the
+        // reduction has cleared the rest of its row.  otherwise the row
+        // doesn't generate the unit ideal, and there's no inverse.
+        if (modulus == 0)
+            inverse = (pivot == 1 || pivot == -1) ? pivot : 0;
+        else
+            inverse = EXTUnitInverse(pivot, modulus);
+        if (!inverse)
+            return nil;
+        
+        for (int i = 0; i < width; i++) {
+            int64_t entry = (int64_t)inverse * transformData[pivotColumn*width + i];
+            retData[j*width + i] = (int)((modulus == 0) ? entry : entry % modulus);
+        }
     }
     
     return ret;
@@ -646,8 +1323,8 @@
     temp.characteristic = self.characteristic;
     
     // vertically augment by an identity matrix
-    int *tempData = temp.presentation.mutableBytes,
-        *selfData = self.presentation.mutableBytes;
+    int *tempData = temp.presentation.mutableBytes;
+    const int *selfData = [self entries];
     for (int i = 0; i < self.width; i++)
         for (int j = 0; j < self.height; j++)
             tempData[i*temp.height+j] = selfData[i*self.height+j];
@@ -684,13 +1361,23 @@
         
         // now copy the augmented part of this column into the return matrix.
         for (int j = 0; j < self.width; j++)
-            retData[ret.height*activeRow+j] = reducedData[reducedMat.height*activeRow+j+self.height];
+            retData[ret.height*activeRow+j] = reducedData[reducedMat.height*i+j+self.height];
     }
     
     return ret;
 }
 
 -(int) rank {
+    if (EXTMatrixIsOverField(self)) {
+        EXTScratchMark mark = EXTScratchSave();
+        int rank = 0;
+        int *pivotColumns = EXTScratchAlloc(sizeof(int)*(self.height + 1));
+        [self fieldReductionWithPivotColumns:pivotColumns rank:&rank];
+        EXTScratchRestore(mark);
+        
+        return rank;
+    }
+    
     EXTMatrix *image = [self image];
     
     return image.width;
@@ -731,8 +1418,8 @@
     
     int *bigData = bigMatrix.presentation.mutableBytes;
     for (EXTPartialDefinition *partial in partialDefinitions) {
-        int *inclusionData = partial.inclusion.presentation.mutableBytes,
-            *actionData = partial.action.presentation.mutableBytes;
+        const int *inclusionData = [partial.inclusion entries],
+                  *actionData = [partial.action entries];
         for (int i = 0; i < partial.inclusion.width; i++) {
             for (int j = 0; j < partial.inclusion.height; j++)
                 bigData[bigMatrix.height*(i+bigMatrix.width) + j] = inclusionData[partial.inclusion.height*i + j];
@@ -786,41 +1473,136 @@
     return ret;
 }
 
-// given a cospan A --> C <-- B, this routine forms the pullback span.
+// given a cospan A --> C <-- B, this routine forms the pullback span.  the
+// nullspace of [P, -Q] is a vertical sum [I; J] of the two inclusions we
+// want, since the nullspace of P (+) -Q are the pairs (x; y) such that
+// Px - Qy = 0 <~~~~> Px = Qy.  rather than forming that nullspace and then
+// splitting it apart, we column-reduce the top rows of [P, -Q; identity] in a
+// single pass and read the two inclusions straight off of the bottom rows of
+// the columns whose top part vanished.  neither P nor Q is touched, so this
+// is safe to call on the same matrices from several threads at once.
 +(NSArray*) formIntersection:(EXTMatrix*)left with:(EXTMatrix*)right {
-    // perform cleanup to put us in a good state.
-    [left modularReduction];
-    [right modularReduction];
-    
-    // form the matrix [P, -Q]
-    EXTMatrix *negRight = [right scale:-1];
-    EXTMatrix *sum = [left copy];
-    [sum.presentation appendData:negRight.presentation];
-    sum.width += right.width;
-    
-    // the nullspace of [P, -Q] is a vertical sum [I; J] of the two inclusions
-    // we want, since the nullspace of P (+) -Q are the pairs (x; y) such that
-    // Px - Qy = 0 <~~~~> Px = Qy.
-    EXTMatrix *nullspace = [sum kernel];
-    
-    EXTMatrix *leftinclusion = [EXTMatrix matrixWidth:nullspace.width
-                                               height:left.width],
-              *rightinclusion = [EXTMatrix matrixWidth:nullspace.width
-                                                height:right.width];
+    if (left.height != right.height) {
+        NSLog(@"formIntersection heights mismatch.");
+        return nil;
+    }
+    
+    NSArray *structured = [EXTKroneckerMatrix intersectionOf:left with:right];
+    if (structured)
+        return structured;
+    
+    int height = (int)left.height, leftWidth = (int)left.width,
+        rightWidth = (int)right.width, width = leftWidth + rightWidth;
+    NSUInteger characteristic = left.characteristic;
+    EXTScratchMark mark = EXTScratchSave();
+    
+    // over F_2, -Q = Q, so we can pack [P, Q] directly and split its kernel.
+    if (characteristic == 2 && right.characteristic == 2) {
+        EXTBitMatrix sum = EXTBitMatrixCreate(width, height);
+        EXTBitMatrixSetColumns(&sum, 0, [left readOnlyEntries], leftWidth,
+                               height);
+        EXTBitMatrixSetColumns(&sum, leftWidth, [right readOnlyEntries],
+                               rightWidth, height);
+        EXTBitMatrix nullspace = EXTBitMatrixKernel(&sum);
+        EXTBitMatrixFree(&sum);
+        EXTScratchRestore(mark);
+        
+        EXTMatrix *leftinclusion = [EXTMatrix matrixWidth:nullspace.width
+                                                   height:leftWidth],
+                  *rightinclusion = [EXTMatrix matrixWidth:nullspace.width
+                                                    height:rightWidth];
+        leftinclusion.characteristic = rightinclusion.characteristic = 2;
+        
+        EXTBitMatrixGetRows(&nullspace, 0, leftWidth,
+                            leftinclusion.presentation.mutableBytes);
+        EXTBitMatrixGetRows(&nullspace, leftWidth, rightWidth,
+                            rightinclusion.presentation.mutableBytes);
+        EXTBitMatrixFree(&nullspace);
+        
+        return @[leftinclusion, rightinclusion];
+    }
+    
+    const EXTPrimeField *field = EXTPrimeFieldForCharacteristic(characteristic);
+    if (field && EXTSparseRoutinesFavored([left nonzeroCount] +
+                                          [right nonzeroCount],
+                                          width, height, characteristic)) {
+        EXTSparseMatrix leftSparse = [left sparseCopy],
+                        rightSparse = [right sparseCopy],
+                        leftInclusion, rightInclusion;
+        EXTSparseMatrixPullback(field, &leftSparse, &rightSparse,
+                                &leftInclusion, &rightInclusion);
+        EXTSparseMatrixFree(&leftSparse);
+        EXTSparseMatrixFree(&rightSparse);
+        EXTScratchRestore(mark);
+        
+        return @[[EXTMatrix matrixWithSparseMatrix:&leftInclusion
+                                    characteristic:left.characteristic],
+                 [EXTMatrix matrixWithSparseMatrix:&rightInclusion
+                                    characteristic:right.characteristic]];
+    }
+    
+    EXTMatrix *augmented = EXTScratchMatrix(width, height + width,
+                                            characteristic);
+    int *augmentedData = augmented.presentation.mutableBytes;
+    const int *leftData = [left readOnlyEntries],
+              *rightData = [right readOnlyEntries];
+    int modulus = (int)characteristic;
+    for (int i = 0; i < width; i++) {
+        int *column = augmentedData + (size_t)i*augmented.height;
+        
+        if (i < leftWidth)
+            for (int j = 0; j < height; j++) {
+                int entry = leftData[(size_t)i*height + j];
+                column[j] = modulus ? entry % modulus : entry;
+            }
+        else
+            for (int j = 0; j < height; j++) {
+                int entry = -rightData[(size_t)(i - leftWidth)*height + j];
+                column[j] = modulus ? entry % modulus : entry;
+            }
+        
+        column[height + i] = 1;
+    }
+    
+    if (field)
+        EXTPrimeFieldColumnReduce(field, augmentedData, width,
+                                  (int)augmented.height, height, NULL);
+    else
+        EXTIntegralColumnReduce(augmented, height, NULL);
+    
+    bool *vanished = EXTScratchAlloc(sizeof(bool)*(width + 1));
+    int nullity = 0;
+    for (int i = 0; i < width; i++) {
+        int *column = augmentedData + (size_t)i*augmented.height;
+        vanished[i] = true;
+        for (int j = 0; j < height && vanished[i]; j++)
+            vanished[i] = (column[j] == 0);
+        nullity += vanished[i];
+    }
+    
+    EXTMatrix *leftinclusion = [EXTMatrix matrixWidth:nullity
+                                               height:leftWidth],
+              *rightinclusion = [EXTMatrix matrixWidth:nullity
+                                                height:rightWidth];
     leftinclusion.characteristic = left.characteristic;
     rightinclusion.characteristic = right.characteristic;
     
-    int *nullData = nullspace.presentation.mutableBytes,
-        *leftInclData = leftinclusion.presentation.mutableBytes,
+    int *leftInclData = leftinclusion.presentation.mutableBytes,
         *rightInclData = rightinclusion.presentation.mutableBytes;
-    for (int i = 0; i < nullspace.width; i++) {
-        for (int j = 0; j < left.width; j++)
-            leftInclData[i*leftinclusion.height+j] = nullData[i*nullspace.height+j];
+    for (int i = 0, column = 0; i < width; i++) {
+        if (!vanished[i])
+            continue;
         
-        for (int j = 0; j < right.width; j++)
-            rightInclData[i*rightinclusion.height+j] = nullData[i*nullspace.height+left.width+j];
+        int *bottom = augmentedData + (size_t)i*augmented.height + height;
+        memcpy(leftInclData + (size_t)column*leftWidth, bottom,
+               sizeof(int)*leftWidth);
+        memcpy(rightInclData + (size_t)column*rightWidth, bottom + leftWidth,
+               sizeof(int)*rightWidth);
+        column++;
     }
     
+    EXTScratchRestore(mark);
+    
     return @[leftinclusion, rightinclusion];
 }
 
@@ -832,9 +1614,8 @@
     EXTMatrix *ret = [EXTMatrix matrixWidth:a.width height:a.height];
     ret.characteristic = a.characteristic;
     
-    int *retData = ret.presentation.mutableBytes,
-        *aData = a.presentation.mutableBytes,
-        *bData = b.presentation.mutableBytes;
+    int *retData = ret.presentation.mutableBytes;
+    const int *aData = [a entries], *bData = [b entries];
     for (int i = 0; i < ret.width; i++)
         for (int j = 0; j < ret.height; j++)
             retData[i*ret.height+j] = aData[i*ret.height+j] + bData[i*ret.height+j];
@@ -850,7 +1631,7 @@
         
         for (int j = 0; j < height; j++) {
             output = [output stringByAppendingFormat:@"%d, ",
-                      ((int*)presentation.mutableBytes)[i*height+j]];
+                      [self entries][i*height+j]];
         }
         
         ret = [NSString stringWithFormat:@"%@| %@|",ret, output];
@@ -864,6 +1645,17 @@
 // quotient Z/B in the sequence B --> Z --> Z/B in terms of the classification
 // theorem for finitely generated modules over a Euclidean domain.
 +(NSDictionary*) findOrdersOf:(EXTMatrix*)B in:(EXTMatrix*)Z {
+    if (EXTMatrixIsOverField(Z))
+        return [EXTMatrix fieldOrdersOf:B in:Z];
+    
+    if (Z.characteristic == 0) {
+        NSDictionary *ret = [EXTMatrix integralOrdersOf:B in:Z];
+        if (ret)
+            return ret;
+        
+        EXTLog(@"Couldn't present Z/B exactly; falling back to int arithmetic.");
+    }
+    
     // start by forming the pullback square.
     NSArray *pair = [EXTMatrix formIntersection:Z with:B];
     EXTMatrix *left = pair[0], *right = pair[1];
@@ -972,6 +1764,63 @@
     return ret;
 }
 
+// over a field Z/B is free, so we need only a complement to B inside Z.  the
+// pullback of B --> C <-- Z presents B in the coordinates of Z, and the rows
+// without pivots in its reduced form index standard basis vectors spanning a
+// complement.  as with the general routine, each generator gets order 0.
++(NSDictionary*) fieldOrdersOf:(EXTMatrix*)B in:(EXTMatrix*)Z {
+    EXTMatrix *coordinates = [EXTMatrix formIntersection:Z with:B][0];
+    
+    EXTScratchMark mark = EXTScratchSave();
+    int rank = 0;
+    int *pivotColumns = EXTScratchAlloc(sizeof(int)*(coordinates.height + 1));
+    [coordinates fieldReductionWithPivotColumns:pivotColumns rank:&rank];
+    
+    NSMutableDictionary *ret =
+        [NSMutableDictionary dictionaryWithCapacity:(Z.width - rank)];
+    const int *zData = [Z entries];
+    for (int j = 0; j < Z.width; j++) {
+        if (pivotColumns[j] != -1)
+            continue;
+        
+        NSMutableArray *column = [NSMutableArray arrayWithCapacity:Z.height];
+        for (int i = 0; i < Z.height; i++)
+            column[i] = @(zData[j*Z.height + i]);
+        
+        ret[column] = @0;
+    }
+    
+    EXTScratchRestore(mark);
+    
+    return ret;
+}
+
+// over the integers, EXTSmithForm does the work without int overflow.  it
+// returns nil if B doesn't live in Z or the answer won't fit in 64 bits.
++(NSDictionary*) integralOrdersOf:(EXTMatrix*)B in:(EXTMatrix*)Z {
+    if (B.height != Z.height)
+        return nil;
+    
+    EXTSmithForm form;
+    if (!EXTSmithFormOfQuotient([B entries], (int)B.width,
+                                [Z entries], (int)Z.width,
+                                (int)Z.height, &form))
+        return nil;
+    
+    NSMutableDictionary *ret = [NSMutableDictionary dictionaryWithCapacity:form.count];
+    for (int i = 0; i < form.count; i++) {
+        NSMutableArray *column = [NSMutableArray arrayWithCapacity:form.length];
+        for (int j = 0; j < form.length; j++)
+            column[j] = @(form.generators[(size_t)i*form.length + j]);
+        
+        ret[column] = @(form.orders[i]);
+    }
+    
+    EXTSmithFormFree(&form);
+    
+    return ret;
+}
+
 +(int) rankOfMap:(EXTMatrix*)map intoQuotientByTheInclusion:(EXTMatrix*)incl {
     NSArray *span = [EXTMatrix formIntersection:map with:incl];
     EXTMatrix *reducedMatrix = [(EXTMatrix*)span[0] columnReduce];
@@ -998,9 +1847,8 @@
     // this is something of a kludge.
     ret.characteristic = a.characteristic;
     
-    int *retData = ret.presentation.mutableBytes,
-        *aData = a.presentation.mutableBytes,
-        *bData = b.presentation.mutableBytes;
+    int *retData = ret.presentation.mutableBytes;
+    const int *aData = [a entries], *bData = [b entries];
     
     for (int i = 0; i < a.width; i++)
         for (int j = 0; j < a.height; j++)
@@ -1019,10 +1867,10 @@
     }
     
     EXTMatrix *ret = [EXTMatrix matrixWidth:(a.width + b.width) height:a.height];
+    ret.characteristic = a.characteristic;
     
-    int *retData = ret.presentation.mutableBytes,
-        *aData = a.presentation.mutableBytes,
-        *bData = b.presentation.mutableBytes;
+    int *retData = ret.presentation.mutableBytes;
+    const int *aData = [a entries], *bData = [b entries];
     
     memcpy(retData, aData, sizeof(int)*a.width*a.height);
     memcpy(retData + a.width*a.height, bData, sizeof(int)*b.width*b.height);
@@ -1030,50 +1878,434 @@
     return ret;
 }
 
--(NSDictionary*) homologyToHomologyKeysFrom:(EXTTerm*)source
-                                         to:(EXTTerm*)target
-                                     onPage:(int)page {
-    EXTMatrix *hSource = [EXTMatrix matrixWidth:((NSDictionary*)source.homologyReps[page]).count height:source.size],
-              *hTarget = [EXTMatrix matrixWidth:((NSDictionary*)target.homologyReps[page]).count height:target.size];
+@end
+
+#pragma mark - kronecker products
+
+// the source holds an inner x outer grid of blocks of chunk ints, with the
+// inner index varying fastest.  this writes the same blocks out to target
+// with the outer index varying fastest instead.
+static void EXTTransposeChunks(const int *source, int *target, size_t chunk,
+                               int inner, int outer) {
+    for (int y = 0; y < outer; y++)
+        for (int x = 0; x < inner; x++)
+            memcpy(target + ((size_t)x*outer + y)*chunk,
+                   source + ((size_t)y*inner + x)*chunk, sizeof(int)*chunk);
+}
+
+static EXTMatrix* EXTMatrixWithTransposedChunks(EXTMatrix *matrix, int width,
+                                                int height, size_t chunk,
+                                                int inner, int outer,
+                                                NSUInteger characteristic) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:height];
+    ret.characteristic = characteristic;
+    EXTTransposeChunks([matrix entries], ret.presentation.mutableBytes, chunk,
+                       inner, outer);
     
-    NSArray *hSourceKeys = ((NSDictionary*)source.homologyReps[page]).allKeys,
-            *hTargetKeys = ((NSDictionary*)target.homologyReps[page]).allKeys;
+    return ret;
+}
+
+// the same entries in the same column-major order, read as a matrix of
+// another shape.
+static EXTMatrix* EXTMatrixReshaped(EXTMatrix *matrix, int width, int height) {
+    EXTMatrix *ret = [EXTMatrix new];
+    ret.width = width; ret.height = height;
+    ret.characteristic = matrix.characteristic;
+    ret.presentation = matrix.presentation;
     
-    // build source and target
-    int *hSourceData = hSource.presentation.mutableBytes;
-    for (int i = 0; i < hSource.width; i++) {
-        NSArray *vector = hSourceKeys[i];
-        for (int j = 0; j < hSource.height; j++)
-            hSourceData[i*hSource.height + j] = [vector[j] intValue];
+    return ret;
+}
+
+// the matrix [a, b], where the two have the same height.
+static EXTMatrix* EXTMatrixConcatenated(EXTMatrix *a, EXTMatrix *b) {
+    EXTSparseMatrix left = [a sparseCopy], right = [b sparseCopy],
+                    sum = EXTSparseMatrixConcatenate(&left, &right);
+    EXTSparseMatrixFree(&left);
+    EXTSparseMatrixFree(&right);
+    
+    return [EXTMatrix matrixWithSparseMatrix:&sum
+                              characteristic:a.characteristic];
+}
+
+// column c of (A (x) B) N is the column B X_c A^T flattened, where X_c is
+// column c of N cut up into a bw x aw matrix.  with the X_c stacked on top of
+// one another, a single product applies A^T to all of them; with the results
+// set side by side, a single product applies B.
+static EXTMatrix* EXTKroneckerTimesMatrix(EXTMatrix *A, EXTMatrix *B,
+                                          EXTMatrix *N,
+                                          NSUInteger characteristic) {
+    int aw = (int)A.width, ah = (int)A.height, bw = (int)B.width,
+        count = (int)N.width;
+    
+    EXTMatrix *stacked = EXTMatrixWithTransposedChunks(N, aw, bw*count, bw,
+                                                       aw, count,
+                                                       characteristic),
+              *partial = [EXTMatrix newMultiply:stacked
+                                             by:[EXTMatrix copyTranspose:A]],
+              *sideBySide = EXTMatrixWithTransposedChunks(partial, ah*count,
+                                                          bw, bw, count, ah,
+                                                          characteristic);
+    
+    return EXTMatrixReshaped([EXTMatrix newMultiply:B by:sideBySide], count,
+                             (int)(ah*B.height));
+}
+
+// dually, M (A (x) B) is built out of the products M_k B, where M_k is the
+// k-th block of bh columns of M, recombined by A.  both steps are again a
+// single product once the blocks are shuffled around.
+static EXTMatrix* EXTMatrixTimesKronecker(EXTMatrix *M, EXTMatrix *A,
+                                          EXTMatrix *B,
+                                          NSUInteger characteristic) {
+    int ah = (int)A.height, bw = (int)B.width, bh = (int)B.height,
+        m = (int)M.height;
+    
+    EXTMatrix *stacked = EXTMatrixWithTransposedChunks(M, bh, m*ah, m, bh, ah,
+                                                       characteristic),
+              *partial = [EXTMatrix newMultiply:stacked by:B],
+              *flattened = EXTMatrixWithTransposedChunks(partial, ah, m*bw, m,
+                                                         ah, bw,
+                                                         characteristic);
+    
+    return EXTMatrixReshaped([EXTMatrix newMultiply:flattened by:A],
+                             (int)(A.width*bw), m);
+}
+
+// over a field, ker(A (x) B) = ker A (x) W + C (x) ker B, where W is the
+// source of B and C is any complement to ker A.  reducing A splits the
+// columns of the transform into a basis for ker A and one for such a C.
+static EXTMatrix* EXTKroneckerKernel(EXTMatrix *A, EXTMatrix *B) {
+    EXTColumnReduction *reduction = [A columnReductionWithLimit:(int)A.height];
+    int aw = (int)A.width, ah = (int)A.height;
+    
+    EXTMatrix *kernel = [EXTMatrix matrixWidth:(aw - reduction.rank)
+                                        height:aw],
+              *complement = [EXTMatrix matrixWidth:reduction.rank height:aw];
+    kernel.characteristic = complement.characteristic = A.characteristic;
+    
+    int *reducedData = reduction.reduced.presentation.mutableBytes,
+        *transformData = reduction.transform.presentation.mutableBytes,
+        *kernelData = kernel.presentation.mutableBytes,
+        *complementData = complement.presentation.mutableBytes;
+    for (int i = 0, kernelColumn = 0, complementColumn = 0; i < aw; i++) {
+        bool isZero = true;
+        for (int j = 0; j < ah && isZero; j++)
+            isZero = (reducedData[i*ah + j] == 0);
+        
+        int *target = isZero ? kernelData + (kernelColumn++)*aw :
+                               complementData + (complementColumn++)*aw;
+        memcpy(target, transformData + i*aw, sizeof(int)*aw);
     }
     
-    NSArray *hSourcePair = [EXTMatrix formIntersection:source.cycles[page] with:hSource];
-    EXTMatrix *hSourceInCycles = [EXTMatrix newMultiply:hSourcePair[0]
-                                                     by:[(EXTMatrix*)hSourcePair[1] invert]];
+    EXTMatrix *identity = [EXTMatrix identity:(int)B.width];
+    identity.characteristic = B.characteristic;
     
-    int *hTargetData = hTarget.presentation.mutableBytes;
-    for (int i = 0; i < hTarget.width; i++) {
-        NSArray *vector = hTargetKeys[i];
-        for (int j = 0; j < hTarget.height; j++)
-            hTargetData[i*hTarget.height + j] = [vector[j] intValue];
+    return EXTMatrixConcatenated(
+                [EXTKroneckerMatrix kroneckerProductOf:kernel with:identity],
+                [EXTKroneckerMatrix kroneckerProductOf:complement
+                                                  with:[B kernel]]);
+}
+
+@implementation EXTKroneckerMatrix
+
+@synthesize left, right;
+
++(EXTKroneckerMatrix*) kroneckerProductOf:(EXTMatrix*)leftFactor
+                                     with:(EXTMatrix*)rightFactor {
+    EXTKroneckerMatrix *ret = [EXTKroneckerMatrix new];
+    ret->left = [leftFactor copy];
+    ret->right = [rightFactor copy];
+    ret.width = leftFactor.width * rightFactor.width;
+    ret.height = leftFactor.height * rightFactor.height;
+    
+    NSUInteger characteristic = leftFactor.characteristic;
+    if (leftFactor.characteristic != rightFactor.characteristic) {
+        int a = leftFactor.characteristic,
+            b = rightFactor.characteristic,
+            gcd = 0;
+        
+        EXTComputeGCD(&a, &b, &gcd, NULL, NULL);
+        
+        characteristic = gcd;
     }
+    ret.characteristic = characteristic;
     
-    NSArray *pair = [EXTMatrix formIntersection:[EXTMatrix newMultiply:self by:hSourceInCycles]
-                                           with:[EXTMatrix directSumWithCommonTargetA:hTarget B:target.boundaries[page]]];
+    return ret;
+}
+
+// the factors follow the characteristic around, so that whatever is computed
+// off of them lands in the right ring.
+-(void) setCharacteristic:(NSUInteger)newCharacteristic {
+    @synchronized (self) {
+        [super setCharacteristic:newCharacteristic];
+        left.characteristic = newCharacteristic;
+        right.characteristic = newCharacteristic;
+    }
+}
+
+-(BOOL) getLeft:(EXTMatrix * __strong *)leftFactor
+          right:(EXTMatrix * __strong *)rightFactor {
+    @synchronized (self) {
+        *leftFactor = left;
+        *rightFactor = right;
+    }
     
-    EXTMatrix *lift = [EXTMatrix newMultiply:pair[1] by:[(EXTMatrix*)pair[0] invertOntoMap]];
+    return *leftFactor != nil;
+}
+
+// as with the sparse form, writing out the product on first touch happens
+// under a lock, since it can be touched from several threads at once.
+-(void) form {
+    if (!left)
+        return;
+    
+    @synchronized (self) {
+        if (!left)
+            return;
+        
+        [self takeEntriesOf:[EXTMatrix formedKroneckerProductOf:left
+                                                           with:right
+                                                 characteristic:self.characteristic]];
+        left = nil;
+        right = nil;
+    }
+}
+
+-(NSMutableData*) presentation {
+    [self form];
     
-    NSMutableDictionary *assignment = [NSMutableDictionary dictionaryWithCapacity:hSourceKeys.count];
-    for (int i = 0; i < hSourceKeys.count; i++)
-        for (int j = 0; j < hTargetKeys.count; j++) {
-            if (((int*)lift.presentation.mutableBytes)[i*lift.height+j] == 0)
-                continue;
-            if ([[assignment allValues] indexOfObject:hTargetKeys[j]] != NSNotFound)
+    return [super presentation];
+}
+
+-(const int*) entries {
+    [self form];
+    
+    return [super entries];
+}
+
+-(void) setPresentation:(NSMutableData*)newPresentation {
+    @synchronized (self) {
+        left = nil;
+        right = nil;
+        [super setPresentation:newPresentation];
+    }
+}
+
+-(EXTSparseMatrix) sparseCopy {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r])
+        return [super sparseCopy];
+    
+    EXTSparseMatrix leftSparse = [l sparseCopy],
+                    rightSparse = [r sparseCopy],
+                    product = EXTSparseMatrixKronecker(&leftSparse,
+                                                       &rightSparse,
+                                                       (int)self.characteristic);
+    EXTSparseMatrixFree(&leftSparse);
+    EXTSparseMatrixFree(&rightSparse);
+    
+    return product;
+}
+
+-(size_t) nonzeroCount {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r])
+        return [super nonzeroCount];
+    
+    return [l nonzeroCount] * [r nonzeroCount];
+}
+
+-(void) getInts:(int*)data {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r]) {
+        [super getInts:data];
+        return;
+    }
+    
+    EXTSparseMatrix leftSparse = [l sparseCopy],
+                    rightSparse = [r sparseCopy],
+                    product = EXTSparseMatrixKronecker(&leftSparse,
+                                                       &rightSparse,
+                                                       (int)self.characteristic);
+    EXTSparseMatrixGetInts(&product, data);
+    EXTSparseMatrixFree(&leftSparse);
+    EXTSparseMatrixFree(&rightSparse);
+    EXTSparseMatrixFree(&product);
+}
+
+-(const int*) readOnlyEntries {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r])
+        return [super readOnlyEntries];
+    
+    int *ret = EXTScratchAlloc(sizeof(int)*self.width*self.height);
+    [self getInts:ret];
+    
+    return ret;
+}
+
+-(EXTMatrix*) copy {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r])
+        return [super copy];
+    
+    EXTKroneckerMatrix *ret = [EXTKroneckerMatrix kroneckerProductOf:l with:r];
+    ret.characteristic = self.characteristic;
+    
+    return ret;
+}
+
+// reducing the factors has to finish before anybody forms the product off of
+// them, so this holds the lock throughout.
+-(EXTMatrix*) modularReduction {
+    @synchronized (self) {
+        if (left) {
+            [left modularReduction];
+            [right modularReduction];
+            
+            return self;
+        }
+    }
+    
+    return [super modularReduction];
+}
+
+-(void) encodeWithCoder:(NSCoder *)aCoder {
+    [self form];
+    [super encodeWithCoder:aCoder];
+}
+
+// archives don't know about unformed products.
+-(Class) classForCoder {
+    return [EXTMatrix class];
+}
+
+#pragma mark structured linear algebra
+
+-(int) rank {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r] || !EXTMatrixIsOverField(self))
+        return [super rank];
+    
+    return [l rank] * [r rank];
+}
+
+-(EXTMatrix*) image {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r] || !EXTMatrixIsOverField(self))
+        return [super image];
+    
+    return [EXTKroneckerMatrix kroneckerProductOf:[l image] with:[r image]];
+}
+
+-(EXTMatrix*) kernel {
+    EXTMatrix *l, *r;
+    if (![self getLeft:&l right:&r] || !EXTMatrixIsOverField(self))
+        return [super kernel];
+    
+    return EXTKroneckerKernel(l, r);
+}
+
++(EXTMatrix*) productOf:(EXTMatrix*)leftMatrix
+                   with:(EXTMatrix*)rightMatrix
+         characteristic:(NSUInteger)characteristic {
+    if (leftMatrix.width != rightMatrix.height)
+        return nil;
+    
+    // the factors of whichever of the two is unformed, as A (x) B on the left
+    // and C (x) D on the right.
+    EXTMatrix *A = nil, *B = nil, *C = nil, *D = nil;
+    BOOL l = [leftMatrix isKindOfClass:[EXTKroneckerMatrix class]] &&
+             [(EXTKroneckerMatrix*)leftMatrix getLeft:&A right:&B],
+         r = [rightMatrix isKindOfClass:[EXTKroneckerMatrix class]] &&
+             [(EXTKroneckerMatrix*)rightMatrix getLeft:&C right:&D];
+    
+    // (A (x) B)(C (x) D) = AC (x) BD, when the shapes line up.
+    if (l && r && A.width == C.height && B.width == D.height) {
+        EXTKroneckerMatrix *ret =
+            [EXTKroneckerMatrix kroneckerProductOf:[EXTMatrix newMultiply:A by:C]
+                                              with:[EXTMatrix newMultiply:B by:D]];
+        ret.characteristic = characteristic;
+        
+        return ret;
+    }
+    
+    // the sparse routines never spread either operand out, so when both are
+    // sparse, they do better still.
+    EXTMatrix *structured = l ? leftMatrix : r ? rightMatrix : nil,
+              *other = l ? rightMatrix : leftMatrix;
+    if (!structured ||
+        (EXTSparseRoutinesFavored([structured nonzeroCount], structured.width,
+                                  structured.height, characteristic) &&
+         EXTSparseRoutinesFavored([other nonzeroCount], other.width,
+                                  other.height, characteristic)))
+        return nil;
+    
+    if (l)
+        return EXTKroneckerTimesMatrix(A, B, rightMatrix, characteristic);
+    
+    return EXTMatrixTimesKronecker(leftMatrix, C, D, characteristic);
+}
+
+// when P = A (x) B and Q = C (x) B share their right factor, [P, -Q] is
+// [A, -C] (x) B, so the pullback comes from the kernel of a smaller kronecker
+// product, split back up.  a shared left factor works the same way, except
+// that the rows of the kernel of B (x) [A, -C] come interleaved.
++(NSArray*) intersectionOf:(EXTMatrix*)leftMatrix with:(EXTMatrix*)rightMatrix {
+    if (![leftMatrix isKindOfClass:[EXTKroneckerMatrix class]] ||
+        ![rightMatrix isKindOfClass:[EXTKroneckerMatrix class]])
+        return nil;
+    
+    EXTKroneckerMatrix *P = (EXTKroneckerMatrix*)leftMatrix,
+                       *Q = (EXTKroneckerMatrix*)rightMatrix;
+    EXTMatrix *PLeft, *PRight, *QLeft, *QRight;
+    if (![P getLeft:&PLeft right:&PRight] || ![Q getLeft:&QLeft right:&QRight] ||
+        P.characteristic != Q.characteristic || !EXTMatrixIsOverField(P))
+        return nil;
+    
+    bool sharesRight = [PRight isEqual:QRight];
+    if (!sharesRight && ![PLeft isEqual:QLeft])
+        return nil;
+    
+    EXTMatrix *A = sharesRight ? PLeft : PRight,
+              *C = sharesRight ? QLeft : QRight,
+              *B = sharesRight ? PRight : PLeft,
+              *difference = EXTMatrixConcatenated(A, [C scale:-1]),
+              *nullspace = sharesRight ? EXTKroneckerKernel(difference, B) :
+                                         EXTKroneckerKernel(B, difference);
+    int aw = (int)A.width, cw = (int)C.width, bw = (int)B.width;
+    
+    EXTMatrix *leftInclusion = [EXTMatrix matrixWidth:(int)nullspace.width
+                                               height:aw*bw],
+              *rightInclusion = [EXTMatrix matrixWidth:(int)nullspace.width
+                                                height:cw*bw];
+    leftInclusion.characteristic = rightInclusion.characteristic =
+                                                            P.characteristic;
+    
+    int *nullData = nullspace.presentation.mutableBytes,
+        *leftData = leftInclusion.presentation.mutableBytes,
+        *rightData = rightInclusion.presentation.mutableBytes;
+    for (int i = 0; i < nullspace.width; i++)
+        for (int row = 0; row < nullspace.height; row++) {
+            int entry = nullData[i*nullspace.height + row];
+            if (!entry)
                 continue;
-            assignment[hSourceKeys[i]] = hTargetKeys[j];
+            
+            if (sharesRight) {
+                int outer = row / bw, inner = row % bw;
+                if (outer < aw)
+                    leftData[i*aw*bw + outer*bw + inner] = entry;
+                else
+                    rightData[i*cw*bw + (outer - aw)*bw + inner] = entry;
+            } else {
+                int outer = row / (aw + cw), inner = row % (aw + cw);
+                if (inner < aw)
+                    leftData[i*aw*bw + outer*aw + inner] = entry;
+                else
+                    rightData[i*cw*bw + outer*cw + inner - aw] = entry;
+            }
         }
     
-    return assignment;
+    return @[leftInclusion, rightInclusion];
 }
 
 @end
@@ -123,6 +123,17 @@
             *endTerm = nil;
     NSMutableDictionary *allOutputTerms = [NSMutableDictionary new];
     
+    // h_ij is the generator at position i, and we'll want to know where
+    // h_i(j+1) sits to apply Sq^0 to it.  (it's -1 if it isn't a generator.)
+    NSArray *generators = self.generators;
+    NSDictionary *generatorIndices = [self generatorIndices];
+    int generatorCount = (int)generators.count, sq0Index[MAX(generatorCount, 1)];
+    for (int i = 0; i < generatorCount; i++) {
+        EXTMayTag *hij = generators[i][@"name"];
+        NSNumber *next = generatorIndices[[EXTMayTag tagWithI:hij.i J:(hij.j+1)]];
+        sq0Index[i] = next ? next.intValue : -1;
+    }
+    
     for (int termIndex = 0; termIndex < startTerm.size; termIndex++) {
         // on this pass of the loop, we're going to deal with the term
         // contributed by the [termIndex] component of the vector we were fed
@@ -131,12 +142,18 @@
         if (!([vector[termIndex] intValue] & 0x1))
             continue;
         
-        // otherwise, pull up all the factors associated to this term.
+        // otherwise, pull up all the factors associated to this term: tags[i]
+        // is the position of a generator dividing it, and exponents[i] is its
+        // power.
         EXTPolynomialTag *tag = startTerm.names[termIndex];
-        NSArray *tags = tag.tags.allKeys;
-        NSMutableArray *counters = [NSMutableArray arrayWithCapacity:tags.count];
-        for (int i = 0; i < tags.count; i++)
-            counters[i] = @0;
+        int factorCount = 0, tags[MAX(tag.length, 1)],
+            exponents[MAX(tag.length, 1)], counters[MAX(tag.length, 1)];
+        for (int i = 0; i < tag.length; i++)
+            if ([tag exponentOf:i] != 0) {
+                tags[factorCount] = i;
+                exponents[factorCount] = [tag exponentOf:i];
+                counters[factorCount++] = 0;
+            }
         
         // initialize the counter with the left-most stuffing
         int leftover = order;
@@ -146,9 +163,9 @@
         do {
             // start by initializing the leftmost buckets
             int i;
-            for (i = 0; i < tags.count && leftover > 0; i++) {
-                int bucketSize = [tag.tags[tags[i]] intValue];
-                counters[i] = @(leftover < bucketSize ? leftover : bucketSize);
+            for (i = 0; i < factorCount && leftover > 0; i++) {
+                int bucketSize = exponents[i];
+                counters[i] = leftover < bucketSize ? leftover : bucketSize;
                 leftover -= bucketSize;
             }
             
@@ -156,7 +173,7 @@
             // just quit.  NOTE that this is NEVER an issue with just one term,
             // because the grading on the May SS is such that the third degree
             // keeps track of EXACTLY how many factors any monomial enjoys.
-            if (i == tags.count && leftover > 0)
+            if (i == factorCount && leftover > 0)
                 return nil;
             
             // at each term, perform the assigned number of Sq^1s, and apply
@@ -166,42 +183,36 @@
             // first, note that 2 | (n r) exactly when r&(n-r) is true. :) so,
             // if that's ever true then we can just skip this summand entirely.
             bool zeroMod2 = false;
-            for (int i = 0; i < counters.count; i++) {
-                int r = [counters[i] intValue],
-                    n = [tag.tags[tags[i]] intValue];
+            for (int i = 0; i < factorCount; i++) {
+                int r = counters[i],
+                    n = exponents[i];
                 zeroMod2 |= r & (n - r);
             }
             
+            // a summand involving an h_i(j+1) we don't have can't be found in
+            // any term, so it's dropped here rather than after the search.
+            bool unknownFactor = false;
+            for (int i = 0; i < factorCount; i++)
+                unknownFactor |= (exponents[i] != counters[i] &&
+                                  sq0Index[tags[i]] == -1);
+            
             // if we're not 0 mod 2, then we're 1 mod 2.  this means this term
             // has the opportunity to contribute to the broader result, and we
             // update our dictionary allOutputTerms to reflect it.
-            if (!zeroMod2) {
-                EXTPolynomialTag *targetTag = [EXTPolynomialTag new];
-                
+            if (!zeroMod2 && !unknownFactor) {
                 // start by building the tag we're going to be looking up
-                for (int i = 0; i < counters.count; i++) {
-                    EXTMayTag *hij = tags[i],
-                              *hinext = [EXTMayTag tagWithI:hij.i J:(hij.j+1)];
-                    int n = [tag.tags[tags[i]] intValue],
-                        r = [counters[i] intValue];
-                    NSNumber *oldSq0Exp = targetTag.tags[hinext],
-                             *oldSq1Exp = targetTag.tags[hij];
-                    
-                    if (oldSq0Exp)
-                        oldSq0Exp = @([oldSq0Exp integerValue] + n-r);
-                    else
-                        oldSq0Exp = @(n-r);
-                    
-                    if (oldSq1Exp)
-                        oldSq1Exp = @([oldSq1Exp intValue] + 2*r);
-                    else
-                        oldSq1Exp = @(2*r);
-                    
-                    if ([oldSq0Exp intValue] != 0)
-                        targetTag.tags[hinext] = oldSq0Exp;
-                    if ([oldSq1Exp intValue] != 0)
-                        targetTag.tags[hij] = oldSq1Exp;
+                int targetExponents[MAX(generatorCount, 1)];
+                memset(targetExponents, 0, sizeof(targetExponents));
+                for (int i = 0; i < factorCount; i++) {
+                    int n = exponents[i], r = counters[i];
+                    if (n - r != 0)
+                        targetExponents[sq0Index[tags[i]]] += n - r;
+                    targetExponents[tags[i]] += 2*r;
                 }
+                EXTPolynomialTag *targetTag =
+                    [EXTPolynomialTag tagWithExponents:targetExponents
+                                                 count:generatorCount
+                                            generators:generators];
                 
                 // if this tag exists in the dictionary, we must discard it,
                 // since 1 + 1 = 0 mod 2.
@@ -216,8 +227,8 @@
             // now we move to the next bucket.  start by finding the leftmost
             // nonzero bucket.
             int leftmost = 0;
-            for (; leftmost < counters.count && [counters[leftmost] intValue] == 0; leftmost++);
-            if (leftmost == counters.count) {
+            for (; leftmost < factorCount && counters[leftmost] == 0; leftmost++);
+            if (leftmost == factorCount) {
                 leftover = order; // force the cartan loop to quit.
                 continue;
             }
@@ -226,20 +237,20 @@
             // the right-hand part of this is used for a carry, and the left-
             // hand part is used for 'leftovers' to minimally reinitialize
             // the leftmost segment of the counters.
-            leftover = [counters[leftmost] intValue] - 1;
-            counters[leftmost] = @0;
+            leftover = counters[leftmost] - 1;
+            counters[leftmost] = 0;
             // continually try to perform carries until we hit a not-maxed bucket
             int carryBuckets = leftmost+1;
-            for (; carryBuckets < counters.count; carryBuckets++) {
-                if ([counters[carryBuckets] isEqual:[tag.tags objectForKey:tags[carryBuckets]]]) {
-                    leftover += [counters[carryBuckets] intValue];
-                    counters[carryBuckets] = @0;
+            for (; carryBuckets < factorCount; carryBuckets++) {
+                if (counters[carryBuckets] == exponents[carryBuckets]) {
+                    leftover += counters[carryBuckets];
+                    counters[carryBuckets] = 0;
                 } else {
-                    counters[carryBuckets] = @(1 + [counters[carryBuckets] intValue]);
+                    counters[carryBuckets] += 1;
                     break;
                 }
             }
-            if (carryBuckets == counters.count)
+            if (carryBuckets == factorCount)
                 leftover += 1;
         } while (leftover != order); // cartan loop
     } // term summand loop
@@ -253,8 +264,9 @@
         // i got this convention from 3.2.3 in the green book. might not be
         // consistent but i don't think that will get in the way. this is a
         // highly localized calculation.
-        for (EXTMayTag *subfactor in factor.tags) {
-            int power = [factor.tags[subfactor] intValue];
+        for (int k = 0; k < factor.length; k++) {
+            EXTMayTag *subfactor = generators[k][@"name"];
+            int power = [factor exponentOf:k];
             a += 1*power;
             b += power*((1 << subfactor.j)*((1<<subfactor.i)-1));
             mayFiltration += power*subfactor.i;
@@ -267,7 +279,7 @@
                 continue;
             
             // then also check that this summand has survived to this location
-            if ([term.names indexOfObject:factor] == NSNotFound)
+            if (![self indicesOfNamesInTerm:term][factor])
                 continue;
             
             strippedOutputTerms = [NSMutableDictionary new];
@@ -307,10 +319,11 @@
 -(EXTTriple*)computeLocationForTag:(EXTPolynomialTag *)tag {
     EXTTriple *ret = [EXTTriple identityLocation];
     
-    for (EXTMayTag *factor in tag.tags) {
+    for (int k = 0; k < tag.length; k++) {
+        EXTMayTag *factor = tag.generators[k][@"name"];
         EXTTriple *hij = [EXTTriple tripleWithA:1 B:((1 << factor.j)*((1 << factor.i) - 1)) C:factor.i];
         
-        ret = [EXTTriple addLocation:ret to:[EXTTriple scale:hij by:[tag.tags[factor] intValue]]];
+        ret = [EXTTriple addLocation:ret to:[EXTTriple scale:hij by:[tag exponentOf:k]]];
     }
     
     return ret;
@@ -340,13 +353,13 @@
     // check that this vector actually lies in the well-defined part of the
     // partial differentials!  (+) all the inclusion matrices together and take
     // a pullback to see if it's nonzero.
-    EXTMatrix *bigInclusion = [EXTMatrix matrixWidth:0 height:underlyingDiff.start.names.count];
+    int bigWidth = 0;
+    for (EXTPartialDefinition *partial in underlyingDiff.partialDefinitions)
+        bigWidth += partial.inclusion.width;
+    EXTMatrix *bigInclusion = [EXTMatrix matrixHeight:underlyingDiff.start.names.count capacity:bigWidth];
     bigInclusion.characteristic = 2;
-    for (EXTPartialDefinition *partial in underlyingDiff.partialDefinitions) {
-        [bigInclusion.presentation increaseLengthBy:partial.inclusion.presentation.length];
-        memcpy(((int*)bigInclusion.presentation.mutableBytes)+bigInclusion.width*bigInclusion.height, partial.inclusion.presentation.mutableBytes, partial.inclusion.presentation.length);
-        bigInclusion.width = bigInclusion.width + partial.inclusion.width;
-    }
+    for (EXTPartialDefinition *partial in underlyingDiff.partialDefinitions)
+        [bigInclusion appendColumnsOf:partial.inclusion];
     EXTMatrix *smallInclusion = [EXTMatrix matrixWidth:1 height:underlyingDiff.start.names.count];
     smallInclusion.characteristic = 2;
     for (int i = 0; i < inVector.count; i++)
@@ -413,6 +426,7 @@
     partial.action.characteristic = 2;
     partial.description = [NSString stringWithFormat:@"Nakamura's lemma applied along Sq^%d on E_%d^%@", order, page, location];
     [diff.partialDefinitions addObject:partial];
+    [self invalidateDifferential:diff];
 
     return diff;
 }
@@ -430,7 +444,9 @@
         return (bool) (loc.b <= width);
     };
     
-    // start by adding the polynomial terms h_{i,j}
+    // start by adding the polynomial terms h_{i,j}, at first only to the zeroth
+    // power.
+    NSMutableDictionary *bounds = [NSMutableDictionary dictionary];
     for (int i = 1; ; i++) {
         
         // if we've passed outside of the width or left A(n), then quit.
@@ -448,13 +464,19 @@
             
             int limit = ((i == 1) && (j == 0)) ? width : width/(B-1);
             
-            [sseq addPolyClass:[EXTMayTag tagWithI:i J:j]
+            EXTMayTag *tag = [EXTMayTag tagWithI:i J:j];
+            [sseq addPolyClass:tag
                       location:[EXTTriple tripleWithA:A B:B C:C]
-                          upTo:limit
+                          upTo:0
                    onCondition:(bool (^)(EXTLocation*))condition];
+            bounds[tag] = @(limit);
         }
     }
     
+    // then grow them all out to their limits in one pass.
+    [sseq resizePolyClasses:bounds
+                onCondition:(bool (^)(EXTLocation*))condition];
+    
     [sseq buildDifferentials];
     
     return sseq;
@@ -489,12 +511,11 @@
             EXTMayTag *tagLeft = [EXTMayTag tagWithI:k J:(i-k+j)],
             *tagRight = [EXTMayTag tagWithI:(i-k) J:j];
             
-            NSDictionary *leftEntry = nil, *rightEntry = nil;
-            for (NSDictionary *workingEntry in self.generators)
-                if ([[workingEntry objectForKey:@"name"] isEqual:tagLeft])
-                    leftEntry = workingEntry;
-                else if ([[workingEntry objectForKey:@"name"] isEqual:tagRight])
-                    rightEntry = workingEntry;
+            NSNumber *leftIndex = [self generatorIndices][tagLeft],
+                     *rightIndex = [self generatorIndices][tagRight];
+            NSDictionary
+                *leftEntry = leftIndex ? self.generators[leftIndex.intValue] : nil,
+                *rightEntry = rightIndex ? self.generators[rightIndex.intValue] : nil;
             EXTMatrix *product =
                 [self productWithLeft:[leftEntry objectForKey:@"location"]
                                 right:[rightEntry objectForKey:@"location"]];
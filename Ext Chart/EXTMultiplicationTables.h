@@ -6,7 +6,7 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTMatrix.h"
 #import "EXTSpectralSequence.h"
@@ -19,6 +19,14 @@
 
 @property(strong) EXTMatrix *presentation;
 @property(strong) NSMutableArray *partialDefinitions;
+// bumped whenever the partial definitions change.  the assembled presentation
+// is kept until this moves or the terms involved change size.
+@property(readonly) NSUInteger version;
+
+// whoever edits the partial definitions (or their matrices) in place, rather
+// than through -[EXTMultiplicationTables addPartialDefinition:to:with:], should
+// call this, and -[EXTSpectralSequence invalidateProductsOf:with:] too.
+-(void) invalidatePresentation;
 
 @end
 
@@ -38,7 +46,13 @@
 -(instancetype) init;
 +(instancetype) multiplicationTables:(EXTSpectralSequence*)sseq;
 
+// the matrix is cached on its entry and shared between callers, so it
+// shouldn't be written to.
 -(EXTMatrix*) getMatrixFor:(EXTLocation*)loc1 with:(EXTLocation*)loc2;
+// assembles, across every core, the matrices for each of the pairs
+// @[loc1, loc2] which aren't already cached, so that the -getMatrixFor:with:
+// calls that follow are lookups.
+-(void) assembleMatricesForPairs:(NSArray*)pairs;
 
 -(void) addPartialDefinition:(EXTPartialDefinition*)partial
                           to:(EXTLocation*)loc1
@@ -48,6 +62,14 @@
                                     with:(EXTLocation*)loc2;
 -(EXTMultiplicationEntry*) performSoftLookup:(EXTLocation*)loc1
                                         with:(EXTLocation*)loc2;
+// these get at the entries without sizing them against the terms, for
+// readers and writers of documents.
+-(void) setEntry:(EXTMultiplicationEntry*)entry
+             for:(EXTLocation*)loc1
+            with:(EXTLocation*)loc2;
+-(void) enumerateEntriesUsingBlock:(void (^)(EXTLocation *loc1,
+                                             EXTLocation *loc2,
+                                             EXTMultiplicationEntry *entry))block;
 
 -(NSMutableArray*) multiplyClass:(NSMutableArray*)class1 at:(EXTLocation*)loc1
                             with:(NSMutableArray*)class2 at:(EXTLocation*)loc2;
@@ -55,5 +77,9 @@
 -(void) computeLeibniz:(EXTLocation*)loc1
                   with:(EXTLocation*)loc2
                 onPage:(int)page;
+-(void) addLeibnizPartialsFor:(EXTLocation*)loc1
+                         with:(EXTLocation*)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential*)dsum;
 
 @end
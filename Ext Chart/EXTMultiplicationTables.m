@@ -10,6 +10,8 @@
 #import "EXTTerm.h"
 #import "EXTDifferential.h"
 
+#include <dispatch/dispatch.h>
+
 
 @interface EXTMultiplicationKey : NSObject <NSCopying, NSCoding>
 
@@ -77,8 +79,21 @@
 
 
 
-@implementation EXTMultiplicationEntry
-@synthesize presentation, partialDefinitions;
+@interface EXTMultiplicationEntry ()
+-(BOOL) isAssembledWidth:(int)width height:(int)height;
+-(void) storeAssembly:(EXTMatrix*)assembly width:(int)width height:(int)height;
+@end
+
+@implementation EXTMultiplicationEntry {
+    // what the presentation was assembled from: the version of the partial
+    // definitions, how many of them there were (which catches appends made
+    // straight to the array), and the dimensions of the terms.
+    NSUInteger assembledVersion, assembledCount;
+    int assembledWidth, assembledHeight;
+    BOOL assembled;
+}
+
+@synthesize presentation, partialDefinitions, version;
 
 -(EXTMultiplicationEntry*) init {
     if (self = [super init]) {
@@ -96,6 +111,32 @@
     return self;
 }
 
+-(void) setPartialDefinitions:(NSMutableArray*)newPartialDefinitions {
+    partialDefinitions = newPartialDefinitions;
+    [self invalidatePresentation];
+}
+
+-(void) invalidatePresentation {
+    version++;
+}
+
+-(BOOL) isAssembledWidth:(int)width height:(int)height {
+    return assembled &&
+           assembledVersion == version &&
+           assembledCount == partialDefinitions.count &&
+           assembledWidth == width &&
+           assembledHeight == height;
+}
+
+-(void) storeAssembly:(EXTMatrix*)assembly width:(int)width height:(int)height {
+    presentation = assembly;
+    assembled = YES;
+    assembledVersion = version;
+    assembledCount = partialDefinitions.count;
+    assembledWidth = width;
+    assembledHeight = height;
+}
+
 - (void)encodeWithCoder:(NSCoder *)aCoder {
     [aCoder encodeObject:partialDefinitions forKey:@"partialDefinitions"];
 }
@@ -195,36 +236,113 @@
     return ret;
 }
 
+-(void) setEntry:(EXTMultiplicationEntry*)entry
+             for:(EXTLocation*)loc1
+            with:(EXTLocation*)loc2 {
+    [tables setObject:entry forKey:[EXTMultiplicationKey newWith:loc1 and:loc2]];
+    [self.sSeq invalidateProductsOf:loc1 with:loc2];
+}
+
+-(void) enumerateEntriesUsingBlock:(void (^)(EXTLocation *loc1,
+                                             EXTLocation *loc2,
+                                             EXTMultiplicationEntry *entry))block {
+    [tables enumerateKeysAndObjectsUsingBlock:
+        ^(EXTMultiplicationKey *key, EXTMultiplicationEntry *entry, BOOL *stop) {
+            block(key.left, key.right, entry);
+        }];
+}
+
 -(void) addPartialDefinition:(EXTPartialDefinition*)partial
                           to:(EXTLocation*)loc1
                         with:(EXTLocation*)loc2 {
     EXTMultiplicationEntry *entry = [self performLookup:loc1 with:loc2];
     [entry.partialDefinitions addObject:partial];
+    [entry invalidatePresentation];
+    [self.sSeq invalidateProductsOf:loc1 with:loc2];
     
     return;
 }
 
-// TODO: for the moment, note that this is order-sensitive.
--(EXTMatrix*) getMatrixFor:(EXTLocation*)loc1 with:(EXTLocation*)loc2 {
-    EXTMultiplicationEntry *entry = [self performLookup:loc1 with:loc2];
+// the dimensions of the matrix for the product of the terms at loc1 and loc2.
+-(void) getWidth:(int*)width
+          height:(int*)height
+             for:(EXTLocation*)loc1
+            with:(EXTLocation*)loc2 {
     Class<EXTLocation> locClass = [loc1 class];
     EXTTerm *term1 = [self.sSeq findTerm:loc1],
     *term2 = [self.sSeq findTerm:loc2],
     *targetterm = [self.sSeq findTerm:[locClass addLocation:loc1 to:loc2]];
     
-    int width, height;
     if (!term1 || !term2 || !targetterm) {
-        width = height = 0;
+        *width = *height = 0;
     } else {
-        width = [term1 names].count * [term2 names].count;
-        height = [targetterm names].count;
+        *width = [term1 names].count * [term2 names].count;
+        *height = [targetterm names].count;
     }
+}
+
+// TODO: for the moment, note that this is order-sensitive.
+-(EXTMatrix*) getMatrixFor:(EXTLocation*)loc1 with:(EXTLocation*)loc2 {
+    EXTMultiplicationEntry *entry = [self performLookup:loc1 with:loc2];
     
-    entry.presentation = [EXTMatrix assemblePresentation:entry.partialDefinitions sourceDimension:width targetDimension:height];
+    int width, height;
+    [self getWidth:&width height:&height for:loc1 with:loc2];
+    
+    if (![entry isAssembledWidth:width height:height])
+        [entry storeAssembly:[EXTMatrix assemblePresentation:entry.partialDefinitions sourceDimension:width targetDimension:height]
+                       width:width
+                      height:height];
     
     return entry.presentation;
 }
 
+// the lookups, which may add entries to the tables, happen up front; then the
+// stale entries are assembled in parallel, each reading only its own partial
+// definitions; then the results are stored, one after another.
+-(void) assembleMatricesForPairs:(NSArray*)pairs {
+    NSMutableArray *stale = [NSMutableArray array];
+    NSMutableSet *seen = [NSMutableSet set];
+    NSMutableData *dimensions = [NSMutableData data];
+    
+    for (NSArray *pair in pairs) {
+        EXTMultiplicationEntry *entry = [self performLookup:pair[0]
+                                                       with:pair[1]];
+        int size[2];
+        [self getWidth:&size[0] height:&size[1] for:pair[0] with:pair[1]];
+        if ([entry isAssembledWidth:size[0] height:size[1]] ||
+            [seen containsObject:entry])
+            continue;
+        
+        [seen addObject:entry];
+        [stale addObject:entry];
+        [dimensions appendBytes:size length:sizeof(size)];
+    }
+    
+    NSUInteger count = stale.count;
+    const int *sizes = dimensions.bytes;
+    __strong EXTMatrix **assemblies =
+                    (__strong EXTMatrix **)calloc(count, sizeof(EXTMatrix*));
+    dispatch_apply(count,
+                   dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                   ^(size_t i) {
+        @autoreleasepool {
+            EXTMultiplicationEntry *entry = stale[i];
+            assemblies[i] =
+                [EXTMatrix assemblePresentation:entry.partialDefinitions
+                                sourceDimension:sizes[2*i]
+                                targetDimension:sizes[2*i+1]];
+        }
+    });
+    
+    for (NSUInteger i = 0; i < count; i++) {
+        [stale[i] storeAssembly:assemblies[i]
+                          width:sizes[2*i]
+                         height:sizes[2*i+1]];
+        assemblies[i] = nil;
+    }
+    free(assemblies);
+}
+
 // return the hadamard product, so to speak, of two vectors.
 +(NSMutableArray*) conglomerateVector:(NSMutableArray*)vec1
                                  with:(NSMutableArray*)vec2 {
@@ -258,11 +376,19 @@
     return [productRule actOn:hadamardVector];
 }
 
-// compute the action of the differentials on each factor in the product
-// decomposition: d(xy) = dx y + x dy.
 -(void) computeLeibniz:(EXTLocation *)loc1
                   with:(EXTLocation *)loc2
                 onPage:(int)page {
+    [self.sSeq computeLeibniz:loc1 with:loc2 onPage:page];
+}
+
+// compute the action of the differentials on each factor in the product
+// decomposition: d(xy) = dx y + x dy, and append it to dsum, the differential
+// found by -[EXTSpectralSequence leibnizDifferentialFor:with:onPage:].
+-(void) addLeibnizPartialsFor:(EXTLocation *)loc1
+                         with:(EXTLocation *)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential *)dsum {
     EXTLocation *sumLoc = [[loc1 class] addLocation:loc1 to:loc2],
              *targetLoc = [[loc1 class] followDiffl:sumLoc page:page];
     EXTTerm *sumterm = [self.sSeq findTerm:sumLoc],
@@ -271,27 +397,8 @@
                   *B = [self.sSeq findTerm:loc2];
     EXTDifferential *d1 = [self.sSeq findDifflWithSource:loc1 onPage:page],
                     *d2 = [self.sSeq findDifflWithSource:loc2 onPage:page];
-    
-    // if we don't have differentials to work with, then skip this entirely.
-    // XXX: i'm not sure this condition is quite right.
     BOOL d1Zero = [sSeq isInZeroRanges:[[loc1 class] followDiffl:loc1 page:page]],
          d2Zero = [sSeq isInZeroRanges:[[loc2 class] followDiffl:loc2 page:page]];
-    if ((!d1 && !d1Zero) ||
-        (!d2 && !d2Zero) ||
-        !targetterm ||
-        [sSeq isInZeroRanges:sumLoc] ||
-        !sumterm ||
-        [sSeq isInZeroRanges:targetLoc])
-        return;
-        
-    // if we're here, then we have all the fixin's we need to construct some
-    // more partial differential definitions.  let's find a place to put them.
-    EXTDifferential *dsum = [self.sSeq findDifflWithSource:sumterm.location
-                                                    onPage:page];
-    if (!dsum) {
-        dsum = [EXTDifferential differential:sumterm end:targetterm page:page];
-        [sSeq addDifferential:dsum];
-    }
     
     // depending upon whether a differential lands in the zero range, we need to
     // take various actions.  TODO: it would be great if there were some way of
@@ -446,8 +553,6 @@
         }
     }
     
-    [dsum stripDuplicates];
-    
     return;
 }
 
@@ -0,0 +1,46 @@
+//
+//  EXTPageStore.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// an append-only file of records, mapped into memory for reading.  the groups a
+// term computes on each page are written here once and then only read back, so
+// nothing is ever rewritten in place: a page that's recomputed is appended
+// again, and the old record is simply no longer referred to.
+//
+// matrices are written as their raw entries, and anything else (the homology
+// representatives, say) through NSKeyedArchiver.
+@interface EXTPageStore : NSObject
+
+// a store in a fresh file under the temporary directory, which is unlinked as
+// soon as it's opened, so the space goes away with the store.
++(EXTPageStore*) temporaryStore;
+// truncates whatever is at path.
+-(instancetype) initWithPath:(NSString*)path;
+
+// the offset of the record, for -objectAtOffset:.
+-(uint64_t) appendObject:(id<NSCoding>)object;
+// a fresh object read out of the record at offset.  safe to call from several
+// threads at once, and alongside appends.
+-(id) objectAtOffset:(uint64_t)offset;
+
+@property (readonly) uint64_t length;
+
+@end
+
+// a mutable array whose entries past the first are kept in a page store, which
+// stands in for the per-page arrays of an EXTTerm.  the first entry (the E_0
+// groups, which get edited in place) and the last (which the next page is
+// computed from) stay in memory; the rest are read back from the store when
+// they're asked for, and dropped again once nobody holds onto them.
+@interface EXTPagedArray : NSMutableArray
+
+@property (strong, readonly) EXTPageStore *store;
+
+-(instancetype) initWithArray:(NSArray*)array store:(EXTPageStore*)store;
+
+@end
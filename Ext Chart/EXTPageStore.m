@@ -0,0 +1,314 @@
+//
+//  EXTPageStore.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTPageStore.h"
+#import "EXTMatrix.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// every record starts with one of these, and is padded out to a multiple of 8.
+typedef struct {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t length;        // of the payload, which follows directly
+} EXTPageRecordHeader;
+
+enum {
+    EXTPageRecordMatrix = 1,    // width, height, characteristic, then entries
+    EXTPageRecordArchive = 2,   // an NSKeyedArchiver archive
+};
+
+@implementation EXTPageStore {
+    int fd;
+    uint64_t length;
+
+    // the mapping covers the file as it was when it was last (re)made, and is
+    // remade when a read runs past it.
+    void *mapping;
+    uint64_t mappedLength;
+}
+
+@synthesize length;
+
++(EXTPageStore*) temporaryStore {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                        [NSString stringWithFormat:@"ExtChart-pages-%@",
+                                                   [NSUUID UUID].UUIDString]];
+    EXTPageStore *ret = [[EXTPageStore alloc] initWithPath:path];
+    unlink(path.fileSystemRepresentation);
+
+    return ret;
+}
+
+-(instancetype) initWithPath:(NSString*)path {
+    if (self = [super init]) {
+        fd = open(path.fileSystemRepresentation, O_RDWR | O_CREAT | O_TRUNC,
+                  0600);
+        if (fd < 0) {
+            NSLog(@"EXTPageStore couldn't open %@.", path);
+            return nil;
+        }
+
+        length = 0;
+        mapping = NULL;
+        mappedLength = 0;
+    }
+
+    return self;
+}
+
+-(void) dealloc {
+    if (mapping)
+        munmap(mapping, (size_t)mappedLength);
+    if (fd >= 0)
+        close(fd);
+}
+
+#pragma mark - writing
+
+-(uint64_t) appendType:(uint32_t)type
+                 parts:(const void * const *)parts
+               lengths:(const size_t *)lengths
+                 count:(int)count {
+    EXTPageRecordHeader header = {type, 0, 0};
+    for (int i = 0; i < count; i++)
+        header.length += lengths[i];
+
+    static const char padding[8] = {0};
+    size_t padded = (size_t)((8 - header.length % 8) % 8);
+
+    @synchronized (self) {
+        uint64_t offset = length, position = length;
+
+        BOOL ok = pwrite(fd, &header, sizeof(header), (off_t)position) ==
+                  sizeof(header);
+        position += sizeof(header);
+        for (int i = 0; ok && i < count; i++) {
+            ok = pwrite(fd, parts[i], lengths[i], (off_t)position) ==
+                 (ssize_t)lengths[i];
+            position += lengths[i];
+        }
+        ok = ok && pwrite(fd, padding, padded, (off_t)position) ==
+                   (ssize_t)padded;
+
+        if (!ok)
+            [NSException raise:NSInternalInconsistencyException
+                        format:@"EXTPageStore couldn't write a record."];
+
+        length = position + padded;
+        return offset;
+    }
+}
+
+-(uint64_t) appendObject:(id<NSCoding>)object {
+    if ([(id)object isKindOfClass:[EXTMatrix class]]) {
+        EXTMatrix *matrix = (EXTMatrix*)object;
+        int32_t shape[4] = {(int32_t)matrix.width, (int32_t)matrix.height,
+                            (int32_t)matrix.characteristic, 0};
+        const void *parts[2] = {shape, [matrix entries]};
+        size_t lengths[2] = {sizeof(shape),
+                             sizeof(int) * matrix.width * matrix.height};
+
+        return [self appendType:EXTPageRecordMatrix
+                          parts:parts
+                        lengths:lengths
+                          count:2];
+    }
+
+    NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:object];
+    const void *parts[1] = {archive.bytes};
+    size_t lengths[1] = {archive.length};
+
+    return [self appendType:EXTPageRecordArchive
+                      parts:parts
+                    lengths:lengths
+                      count:1];
+}
+
+#pragma mark - reading
+
+// call with the lock held.
+-(const char*) bytesAt:(uint64_t)offset length:(uint64_t)count {
+    if (offset + count > length)
+        return NULL;
+
+    if (offset + count > mappedLength) {
+        if (mapping)
+            munmap(mapping, (size_t)mappedLength);
+
+        mapping = mmap(NULL, (size_t)length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = NULL;
+            mappedLength = 0;
+            return NULL;
+        }
+        mappedLength = length;
+    }
+
+    return (const char*)mapping + offset;
+}
+
+-(id) objectAtOffset:(uint64_t)offset {
+    @synchronized (self) {
+        const EXTPageRecordHeader *header =
+            (const EXTPageRecordHeader*)[self bytesAt:offset
+                                               length:sizeof(EXTPageRecordHeader)];
+        if (!header)
+            return nil;
+
+        uint64_t payloadLength = header->length;
+        uint32_t type = header->type;
+        const char *payload = [self bytesAt:offset + sizeof(EXTPageRecordHeader)
+                                     length:payloadLength];
+        if (!payload)
+            return nil;
+
+        if (type == EXTPageRecordMatrix) {
+            const int32_t *shape = (const int32_t*)payload;
+            EXTMatrix *ret = [EXTMatrix matrixWidth:shape[0] height:shape[1]];
+            ret.characteristic = shape[2];
+            memcpy(ret.presentation.mutableBytes, payload + 4 * sizeof(int32_t),
+                   sizeof(int) * shape[0] * shape[1]);
+
+            return ret;
+        }
+
+        return [NSKeyedUnarchiver unarchiveObjectWithData:
+                    [NSData dataWithBytes:payload length:payloadLength]];
+    }
+}
+
+@end
+
+@implementation EXTPagedArray {
+    id first;                   // entry 0, in memory
+    NSMutableArray *offsets;    // @(offset) into the store; entry 0 is NSNull
+    NSPointerArray *faulted;    // weak: the entries last read back
+    id latest;                  // the last entry, in memory
+}
+
+@synthesize store;
+
+-(instancetype) initWithArray:(NSArray*)array store:(EXTPageStore*)newStore {
+    if (self = [super init]) {
+        store = newStore;
+        offsets = [NSMutableArray arrayWithCapacity:array.count];
+        faulted = [NSPointerArray weakObjectsPointerArray];
+
+        for (id object in array)
+            [self addObject:object];
+    }
+
+    return self;
+}
+
+-(instancetype) init {
+    return [self initWithArray:@[] store:[EXTPageStore temporaryStore]];
+}
+
+-(instancetype) initWithCapacity:(NSUInteger)numItems {
+    return [self init];
+}
+
+#pragma mark - NSArray primitives
+
+-(NSUInteger) count {
+    return offsets.count;
+}
+
+-(id) objectAtIndex:(NSUInteger)index {
+    @synchronized (self) {
+        if (index >= offsets.count)
+            [NSException raise:NSRangeException
+                        format:@"index %lu beyond count %lu",
+                               (unsigned long)index,
+                               (unsigned long)offsets.count];
+
+        if (index == 0)
+            return first;
+        if (index == offsets.count - 1 && latest)
+            return latest;
+
+        id ret = [faulted pointerAtIndex:index];
+        if (!ret) {
+            ret = [store objectAtOffset:[offsets[index] unsignedLongLongValue]];
+            [faulted replacePointerAtIndex:index
+                               withPointer:(__bridge void *)ret];
+        }
+
+        return ret;
+    }
+}
+
+#pragma mark - NSMutableArray primitives
+
+// writes object out unless it's going to be entry 0.
+-(id) offsetFor:(id)object atIndex:(NSUInteger)index {
+    if (index == 0)
+        return [NSNull null];
+
+    return @([store appendObject:object]);
+}
+
+-(void) insertObject:(id)anObject atIndex:(NSUInteger)index {
+    @synchronized (self) {
+        // the entry being pushed out of the first slot goes to the store.
+        if (index == 0 && offsets.count > 0)
+            offsets[0] = [self offsetFor:first atIndex:1];
+
+        [offsets insertObject:[self offsetFor:anObject atIndex:index]
+                      atIndex:index];
+        [faulted insertPointer:(__bridge void *)anObject atIndex:index];
+
+        if (index == 0)
+            first = anObject;
+        if (index == offsets.count - 1)
+            latest = anObject;
+    }
+}
+
+-(void) removeObjectAtIndex:(NSUInteger)index {
+    @synchronized (self) {
+        if (index == 0 && offsets.count > 1) {
+            first = [self objectAtIndex:1];
+            offsets[1] = [NSNull null];
+        } else if (index == 0) {
+            first = nil;
+        }
+
+        if (index == offsets.count - 1)
+            latest = nil;
+
+        [offsets removeObjectAtIndex:index];
+        [faulted removePointerAtIndex:index];
+    }
+}
+
+-(void) addObject:(id)anObject {
+    [self insertObject:anObject atIndex:self.count];
+}
+
+-(void) removeLastObject {
+    [self removeObjectAtIndex:self.count - 1];
+}
+
+-(void) replaceObjectAtIndex:(NSUInteger)index withObject:(id)anObject {
+    @synchronized (self) {
+        offsets[index] = [self offsetFor:anObject atIndex:index];
+        [faulted replacePointerAtIndex:index
+                           withPointer:(__bridge void *)anObject];
+
+        if (index == 0)
+            first = anObject;
+        if (index == offsets.count - 1)
+            latest = anObject;
+    }
+}
+
+@end
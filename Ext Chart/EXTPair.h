@@ -6,7 +6,7 @@
 //  Copyright 2011 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTLocation.h"
 #import "EXTMatrix.h"
@@ -26,20 +26,29 @@
 	return pair;
 }
 
+-(EXTGrading) grading {
+    EXTGrading ret = {2, {a, b}};
+    return ret;
+}
+
++(EXTPair*) locationWithGrading:(EXTGrading)grading {
+    return [EXTPair pairWithA:grading.coordinates[0] B:grading.coordinates[1]];
+}
+
 +(EXTPair*) addLocation:(EXTPair *)a to:(EXTPair *)b {
-    return [EXTPair pairWithA:(a.a+b.a) B:(a.b+b.b)];
+    return [EXTPair locationWithGrading:EXTGradingAdd(a.grading, b.grading)];
 }
 
 +(EXTPair*) identityLocation {
-    return [EXTPair pairWithA:0 B:0];
+    return [EXTPair locationWithGrading:EXTGradingZero(2)];
 }
 
 +(EXTPair*) negate:(EXTPair*)loc {
-    return [EXTPair pairWithA:(-loc.a) B:(-loc.b)];
+    return [EXTPair locationWithGrading:EXTGradingScale(loc.grading, -1)];
 }
 
 +(EXTPair*) scale:(EXTPair*)loc by:(int)scale {
-    return [EXTPair pairWithA:(loc.a*scale) B:(loc.b*scale)];
+    return [EXTPair locationWithGrading:EXTGradingScale(loc.grading, scale)];
 }
 
 +(EXTPair*) followDiffl:(EXTPair*)a page:(int)page {
@@ -62,7 +71,7 @@
 
 +(EXTPair*) linearCombination:(CFArrayRef)coeffs
                     ofLocations:(CFArrayRef)generators {
-    int a = 0, b = 0;
+    EXTGrading sum = EXTGradingZero(2);
     
     // access this just once.
     int max = CFArrayGetCount(coeffs);
@@ -72,11 +81,10 @@
         __unsafe_unretained EXTPair *thisGuy = CFArrayGetValueAtIndex(generators, i);
         NSInteger scale = (NSInteger)CFArrayGetValueAtIndex(coeffs, i);
         
-        a += scale*thisGuy->a;
-        b += scale*thisGuy->b;
+        sum = EXTGradingAddMultiple(sum, thisGuy.grading, (int)scale);
     }
     
-    return [EXTPair pairWithA:a B:b];
+    return [EXTPair locationWithGrading:sum];
 }
 
 /// NSCoder, NSCopying routines ///
@@ -85,16 +93,10 @@
     return [[EXTPair allocWithZone:zone] initWithA:self.a B:self.b];
 }
 
+// the old hash started from a + b, which sent whole antidiagonals to the same
+// bucket.
 - (NSUInteger) hash {
-	long long key = [self a];
-	key += [self b];
-	key = (~key) + (key << 18); // key = (key << 18) - key - 1;
-	key = key ^ (key >> 31);
-	key = key * 21; // key = (key + (key << 2)) + (key << 4);
-	key = key ^ (key >> 11);
-	key = key + (key << 6);
-	key = key ^ (key >> 22);
-	return (int) key;
+	return (NSUInteger)EXTGradingHash(self.grading);
 }
 
 -(BOOL) isEqual:(id)other {
@@ -168,12 +170,12 @@
     return [EXTPair pairWithA:a B:b];
 }
 
+-(EXTGridProjection) gridProjection {
+    return EXTGridProjectionCompose(userToScreen, internalToUser);
+}
+
 -(EXTIntPoint) gridPoint:(EXTPair*)loc {
-    EXTPair *userCoordsPair = [self convertFromInternalToUser:loc];
-    
-    NSArray *result = [userToScreen actOn:@[@(userCoordsPair.a),
-                                            @(userCoordsPair.b)]];
-    return (EXTIntPoint){[result[0] intValue], [result[1] intValue]};
+    return EXTGridProjectionApply([self gridProjection], loc.grading);
 }
 
 -(EXTIntPoint) followDifflAtGridLocation:(EXTIntPoint)gridLocation
@@ -6,20 +6,39 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTSpectralSequence.h"
 #import "EXTMultiplicationTables.h"
 
 
 
+// a monomial in the generators of a polynomial spectral sequence, stored as a
+// packed vector of exponents indexed by the generators' positions.  tags are
+// immutable, and they compare and hash by their exponents.
 @interface EXTPolynomialTag : NSObject <NSCopying, NSCoding>
 
-@property(strong) NSMutableDictionary *tags;
+// the generator entries of the spectral sequence the exponents index into.  the
+// spectral sequence owns this array; its tags only read the names out of it.
+@property(readonly) NSArray *generators;
+// one past the index of the last nonzero exponent.
+@property(readonly) int length;
+
++(EXTPolynomialTag*) tagWithExponents:(const int*)exponents
+                                count:(int)count
+                           generators:(NSArray*)generators;
+-(int) exponentOf:(int)generatorIndex;
+// generator name => exponent, over the nonzero exponents.
+-(NSDictionary*) tags;
+
+// decoded tags carry their exponents by generator name until the spectral
+// sequence they belong to hands them its generators to index them by.
+-(void) linkToGenerators:(NSArray*)generators indices:(NSDictionary*)indices;
 
 -(NSString*) description;
 +(EXTPolynomialTag*) sum:(EXTPolynomialTag*)left with:(EXTPolynomialTag*)right;
 -(BOOL) isEqual:(id)object;
+-(NSUInteger) hash;
 -(instancetype) copyWithZone:(NSZone *)zone;
 
 @end
@@ -54,19 +73,38 @@
 -(void) resizePolyClass:(NSObject<NSCopying>*)name
                    upTo:(int)newBound
             onCondition:(bool (^)(EXTLocation*))condition;
+// resizes several generators at once, given as name => @(new bound).  all the
+// new monomials are found first, and then each term they land in is extended,
+// and its differentials rewritten, just once.  to fill out a chart in one
+// pass, add the generators up to 0 and then resize them all together.
+-(void) resizePolyClasses:(NSDictionary*)newBounds
+              onCondition:(bool (^)(EXTLocation*))condition;
 
 -(EXTMatrix*) productWithLeft:(EXTLocation*)left right:(EXTLocation*)right;
+// the product precomposed with leftMap (x) rightMap, which map into the terms
+// at left and right, without forming the tensor product of the maps.  a nil
+// map stands for the identity on its term.
+-(EXTMatrix*) productWithLeft:(EXTLocation*)left
+                      through:(EXTMatrix*)leftMap
+                        right:(EXTLocation*)right
+                      through:(EXTMatrix*)rightMap;
+-(void) prepareProductsForPairs:(NSArray*)pairs;
 
 // performs an irreversible upcast to EXTSpectralSequence
 -(EXTSpectralSequence*) upcastToSSeq;
 
--(void) computeLeibniz:(EXTLocation *)loc1
-                  with:(EXTLocation *)loc2
-                onPage:(int)page;
+-(void) addLeibnizPartialsFor:(EXTLocation *)loc1
+                         with:(EXTLocation *)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential *)dsum;
 
 -(void) changeName:(NSObject<NSCopying>*)name to:(NSObject<NSCopying>*)newName;
 -(void) deleteClass:(NSObject<NSCopying>*)name;
 -(EXTLocation*) computeLocationForTag:(EXTPolynomialTag*)tag;
+// generator name => @(position in generators).
+-(NSDictionary*) generatorIndices;
+// tag => @(position in term.names), for looking up products in a term.
+-(NSDictionary*) indicesOfNamesInTerm:(EXTTerm*)term;
 -(int) koszulSignForMultiplying:(EXTPolynomialTag*)left
                              by:(EXTPolynomialTag*)right;
 
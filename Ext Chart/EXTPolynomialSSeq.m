@@ -9,58 +9,141 @@
 #import "EXTPolynomialSSeq.h"
 #import "EXTTerm.h"
 #import "EXTDifferential.h"
+#import "EXTLocationDictionary.h"
 
 
-// EXTTerms should have names which aren't strings but "tags".  each tag should
-// be either a dictionary of pairs of base class + exponent.  multiplication
-// should act by iterating through and adding these lists together.
+// EXTTerms should have names which aren't strings but "tags".  each tag is a
+// monomial in the polynomial generators, and multiplication acts by adding
+// exponent vectors together.
 //
-// IMPORTANT NOTE: the tags dictionary should not allow ANY key with a @0 value.
-@implementation EXTPolynomialTag
+// the exponents are indexed by position in the spectral sequence's generators,
+// and trailing zeros are never stored, so that adding a generator leaves the
+// existing tags alone and equal monomials have equal representations.
+@implementation EXTPolynomialTag {
+    int *exponents;
+    NSDictionary *unlinked;     // name => exponent, for a decoded tag
+}
 
-@synthesize tags;
+@synthesize generators, length;
 
 -(EXTPolynomialTag*) init {
     if (self = [super init]) {
-        tags = [NSMutableDictionary dictionary];
+        exponents = NULL;
+        length = 0;
     }
     
     return self;
 }
 
++(EXTPolynomialTag*) tagWithExponents:(const int*)newExponents
+                                count:(int)count
+                           generators:(NSArray*)newGenerators {
+    EXTPolynomialTag *ret = [EXTPolynomialTag new];
+    
+    while (count > 0 && newExponents[count-1] == 0)
+        count--;
+    
+    ret->generators = newGenerators;
+    ret->length = count;
+    if (count > 0) {
+        ret->exponents = malloc(count * sizeof(int));
+        memcpy(ret->exponents, newExponents, count * sizeof(int));
+    }
+    
+    return ret;
+}
+
+-(void) dealloc {
+    free(exponents);
+}
+
+-(int) exponentOf:(int)generatorIndex {
+    return generatorIndex < length ? exponents[generatorIndex] : 0;
+}
+
+-(NSDictionary*) tags {
+    if (unlinked)
+        return unlinked;
+    
+    NSMutableDictionary *ret = [NSMutableDictionary dictionaryWithCapacity:length];
+    for (int i = 0; i < length; i++)
+        if (exponents[i] != 0)
+            ret[generators[i][@"name"]] = @(exponents[i]);
+    
+    return ret;
+}
+
+-(void) linkToGenerators:(NSArray*)newGenerators
+                 indices:(NSDictionary*)indices {
+    if (!unlinked)
+        return;
+    
+    int *newExponents = calloc(MAX(newGenerators.count, 1), sizeof(int));
+    for (id name in unlinked)
+        newExponents[[indices[name] intValue]] = [unlinked[name] intValue];
+    
+    int count = (int)newGenerators.count;
+    while (count > 0 && newExponents[count-1] == 0)
+        count--;
+    
+    free(exponents);
+    exponents = newExponents;
+    length = count;
+    generators = newGenerators;
+    unlinked = nil;
+}
+
 // sends the tag dictionary [x:1, y:2] to the string "x y^2"
 -(NSString*) description {
+    if (unlinked) {
+        NSString *ret = [NSMutableString string];
+        
+        if (unlinked.count == 0)
+            return @"1";
+        
+        for (NSString *key in unlinked.keyEnumerator) {
+            if ([unlinked[key] intValue] == 1)
+                ret = [ret stringByAppendingFormat:@" %@", key.description];
+            else
+                ret = [ret stringByAppendingFormat:@" (%@)^{%@}",
+                       key.description, unlinked[key]];
+        }
+        
+        return ret;
+    }
+    
     NSString *ret = [NSMutableString string];
     
-    if (self.tags.count == 0)
+    if (length == 0)
         return @"1";
     
-    for (NSString *key in tags.keyEnumerator) {
-        if ([[tags objectForKey:key] intValue] == 0)
+    for (int i = 0; i < length; i++) {
+        NSObject *name = generators[i][@"name"];
+        if (exponents[i] == 0)
             continue;
-        else if ([[tags objectForKey:key] intValue] == 1)
-            ret = [ret stringByAppendingFormat:@" %@", key.description];
+        else if (exponents[i] == 1)
+            ret = [ret stringByAppendingFormat:@" %@", name.description];
         else
-            ret = [ret stringByAppendingFormat:@" (%@)^{%@}",
-                        key.description,
-                        [tags objectForKey:key]];
+            ret = [ret stringByAppendingFormat:@" (%@)^{%d}",
+                        name.description, exponents[i]];
     }
     
     return ret;
 }
 
 +(EXTPolynomialTag*) sum:(EXTPolynomialTag*)left with:(EXTPolynomialTag*)right {
-    EXTPolynomialTag *ret = [left copy];
+    NSAssert(!left->unlinked && !right->unlinked,
+             @"Tags must be linked to their generators to be multiplied.");
     
-    for (NSString *key in right.tags.keyEnumerator) {
-        id leftValue = [left.tags objectForKey:key],
-            rightValue = [right.tags objectForKey:key];
-        if (!leftValue)
-            [ret.tags setObject:rightValue forKey:key];
-        else
-            [ret.tags setObject:@([rightValue intValue] + [leftValue intValue])
-                         forKey:key];
-    }
+    EXTPolynomialTag *ret = [EXTPolynomialTag new];
+    ret->generators = left->generators ? left->generators : right->generators;
+    ret->length = MAX(left->length, right->length);
+    if (ret->length == 0)
+        return ret;
+    
+    ret->exponents = malloc(ret->length * sizeof(int));
+    for (int i = 0; i < ret->length; i++)
+        ret->exponents[i] = [left exponentOf:i] + [right exponentOf:i];
     
     return ret;
 }
@@ -71,45 +154,165 @@
     
     EXTPolynomialTag *target = (EXTPolynomialTag*)object;
     
-    return ([target.tags isEqualToDictionary:tags]);
+    if (unlinked || target->unlinked)
+        return [[target tags] isEqualToDictionary:[self tags]];
+    
+    return (target->length == length &&
+            (length == 0 ||
+             !memcmp(target->exponents, exponents, length * sizeof(int))));
 }
 
+// tags are immutable, so a copy is the tag itself.
 -(instancetype) copyWithZone:(NSZone *)zone {
-    EXTPolynomialTag *ret = [EXTPolynomialTag new];
-    ret.tags = [NSMutableDictionary dictionaryWithDictionary:tags];
-    return ret;
+    return self;
 }
 
+// archived tags keep the name => exponent form, which doesn't depend on the
+// order of the generators.
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
-    if (self = [super init]) {
-        tags = [aDecoder decodeObjectForKey:@"tags"];
+    if (self = [self init]) {
+        unlinked = [aDecoder decodeObjectForKey:@"tags"];
     }
     
     return self;
 }
 
 - (void)encodeWithCoder:(NSCoder *)aCoder {
-    [aCoder encodeObject:tags forKey:@"tags"];
+    [aCoder encodeObject:[NSMutableDictionary dictionaryWithDictionary:[self tags]]
+                  forKey:@"tags"];
 }
 
 - (NSUInteger)hash {
-    return 0;
+    // an unlinked tag doesn't know its positions yet.  these only turn up in
+    // decoded spectral sequences that aren't polynomial any more, which never
+    // look tags up.
+    if (unlinked)
+        return 0;
+    
+    uint64_t hash = 0x9e3779b97f4a7c15ull;
+    for (int i = 0; i < length; i++) {
+        hash ^= (uint64_t)(uint32_t)exponents[i];
+        hash *= 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 31;
+    }
+    
+    return (NSUInteger)hash;
 }
 
 @end
 
 
 
+//
+// the koszul sign of a product of monomials only depends on which exponents of
+// odd generators are odd, so these are packed into bit masks, one bit per
+// generator, and a sign comes down to a few ands and popcounts.
+//
+static inline int EXTParityMaskWords(NSUInteger generatorCount) {
+    return (int)MAX((generatorCount + 63) / 64, (NSUInteger)1);
+}
+
+// bit i is set when generator i has odd koszul degree.
+static void EXTOddGeneratorMask(NSArray *generators, int words,
+                                uint64_t *mask) {
+    memset(mask, 0, sizeof(uint64_t) * words);
+    for (int i = 0; i < generators.count; i++)
+        if ([(EXTLocation*)generators[i][@"location"] koszulDegree] & 1)
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+}
+
+// bit i is set when generator i is odd and appears in tag to an odd power.  a
+// suffix mask instead has bit i set when there are an odd number of such
+// generators from i on up, which is what a right-hand factor at i commutes past.
+static void EXTTagParityMask(EXTPolynomialTag *tag, const uint64_t *odd,
+                             int words, BOOL suffix, uint64_t *mask) {
+    memset(mask, 0, sizeof(uint64_t) * words);
+    
+    int parity = 0;
+    for (int i = tag.length - 1; i >= 0; i--) {
+        int bit = ([tag exponentOf:i] & 1) &&
+                  (odd[i / 64] & ((uint64_t)1 << (i % 64)));
+        parity ^= bit;
+        if (suffix ? parity : bit)
+            mask[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+}
+
+// the sign has always carried a leading factor of -1.
+static inline int EXTKoszulSign(const uint64_t *leftSuffix,
+                                const uint64_t *rightMask, int words) {
+    int power = 1;
+    for (int w = 0; w < words; w++)
+        power += __builtin_popcountll(leftSuffix[w] & rightMask[w]);
+    
+    return power & 0x1 ? -1 : 1;
+}
+
+// the nonzero entries of a map into a term, or of the identity on a term of
+// the given size when there's no map.
+typedef struct {
+    size_t count;
+    int *columns, *rows, *values;
+} EXTMapEntries;
+
+static EXTMapEntries EXTMapEntriesOf(EXTMatrix *map, int size) {
+    __block EXTMapEntries ret = {0, NULL, NULL, NULL};
+    __block size_t capacity = map ? 16 : (size_t)size + 1;
+    ret.columns = malloc(sizeof(int) * capacity);
+    ret.rows = malloc(sizeof(int) * capacity);
+    ret.values = malloc(sizeof(int) * capacity);
+    
+    if (!map) {
+        for (int i = 0; i < size; i++) {
+            ret.columns[i] = ret.rows[i] = i;
+            ret.values[i] = 1;
+        }
+        ret.count = size;
+        return ret;
+    }
+    
+    [map enumerateNonzeroEntriesUsingBlock:^(int column, int row, int value) {
+        if (ret.count == capacity) {
+            capacity *= 2;
+            ret.columns = realloc(ret.columns, sizeof(int) * capacity);
+            ret.rows = realloc(ret.rows, sizeof(int) * capacity);
+            ret.values = realloc(ret.values, sizeof(int) * capacity);
+        }
+        ret.columns[ret.count] = column;
+        ret.rows[ret.count] = row;
+        ret.values[ret.count++] = value;
+    }];
+    
+    return ret;
+}
+
+static void EXTMapEntriesFree(EXTMapEntries *entries) {
+    free(entries->columns);
+    free(entries->rows);
+    free(entries->values);
+}
+
+
+
 //
 // now, the actual polynomial spectral sequence class.
 //
-@implementation EXTPolynomialSSeq
+@implementation EXTPolynomialSSeq {
+    NSDictionary *generatorIndices;     // built on demand, nil when stale
+    NSMapTable *nameIndices;            // EXTTerm => @[names, @count, indices]
+}
 
 @synthesize generators;
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     if (self = [super initWithCoder:aDecoder]) {
         generators = [aDecoder decodeObjectForKey:@"generators"];
+        
+        // the tags were decoded before the generators they refer to.
+        NSDictionary *indices = [self generatorIndices];
+        for (EXTTerm *term in self.terms.allValues)
+            for (EXTPolynomialTag *tag in term.names)
+                [tag linkToGenerators:generators indices:indices];
     }
     
     return self;
@@ -239,6 +442,7 @@
     [entry setObject:@0 forKey:@"upperBound"];
     
     [generators addObject:entry];
+    [self invalidateGeneratorIndices];
     
     [self resizePolyClass:name upTo:bound onCondition:condition];
 }
@@ -264,118 +468,131 @@
 -(void) resizePolyClass:(NSObject<NSCopying>*)name
                    upTo:(int)newBound
             onCondition:(bool (^)(EXTLocation*))condition {
-    Class<EXTLocation> indexClass = self.indexClass;
-    
-    CFMutableArrayRef counter = CFArrayCreateMutable(kCFAllocatorDefault, generators.count, NULL);
-    CFMutableArrayRef upperBounds = CFArrayCreateMutable(kCFAllocatorDefault, generators.count, NULL);
-    CFMutableArrayRef locations = CFArrayCreateMutable(kCFAllocatorDefault, generators.count, NULL);
-    CFMutableArrayRef names = CFArrayCreateMutable(kCFAllocatorDefault, generators.count, NULL);
-    
-    // set up all the arrays
-    NSInteger ourIndex = -1, oldBound = -1;
-    for (int i = 0; i < generators.count; i++) {
-        NSDictionary *workingEntry = generators[i];
-        
-        CFArraySetValueAtIndex(names, i, (__bridge const void *)(workingEntry[@"name"]));
-        CFArraySetValueAtIndex(locations, i, (__bridge const void *)(workingEntry[@"location"]));
-        
-        if (![workingEntry[@"name"] isEqual:name]) {
-            CFArraySetValueAtIndex(counter, i, 0);
-            CFArraySetValueAtIndex(upperBounds, i, (void*)[workingEntry[@"upperBound"] integerValue]);
-        } else {
-            CFArraySetValueAtIndex(counter, i, (void*)([workingEntry[@"upperBound"] integerValue]+1));
-            CFArraySetValueAtIndex(upperBounds, i, (void*)(NSInteger)newBound);
-            oldBound = [workingEntry[@"upperBound"] integerValue];
-            ourIndex = i;
-        }
-    }
+    [self resizePolyClasses:@{name: @(newBound)} onCondition:condition];
+}
+
+// the monomials new to the resized box are those with some exponent past its
+// old bound.  they're split up by the last generator for which that happens,
+// and each piece is walked with an odometer, which visits them in the same
+// order that resizing the generators one after another would have.
+-(void) resizePolyClasses:(NSDictionary*)newBounds
+              onCondition:(bool (^)(EXTLocation*))condition {
+    int count = (int)generators.count;
+    int oldBounds[count], upperBounds[count], lowerBounds[count],
+        counter[count];
+    EXTGrading gradings[count];
     
-    // TODO: we can only resize to be larger.  not sure if this is desirable, or
-    // if i'll want to come back and allow for shrinking too.
-    if (oldBound >= newBound)
+    BOOL growing = NO;
+    for (int i = 0; i < count; i++) {
+        NSDictionary *entry = generators[i];
+        NSNumber *newBound = newBounds[entry[@"name"]];
+        
+        gradings[i] = [entry[@"location"] grading];
+        oldBounds[i] = [entry[@"upperBound"] intValue];
+        
+        // TODO: we can only resize to be larger.  not sure if this is
+        // desirable, or if i'll want to come back and allow for shrinking too.
+        upperBounds[i] = MAX(oldBounds[i], newBound.intValue);
+        growing |= (upperBounds[i] > oldBounds[i]);
+    }
+    if (!growing)
         return;
     
-    BOOL totalRollover = FALSE;
-    while (!totalRollover) {
-        // search for a term in the location encoded by the counter
-        EXTLocation *workingLoc = [indexClass linearCombination:counter ofLocations:locations];
+    // location => the new tags that land there, in the order they're found.
+    EXTLocationDictionary *pending = [EXTLocationDictionary dictionary];
+    
+    for (int last = 0; last < count; last++) {
+        if (upperBounds[last] == oldBounds[last])
+            continue;
         
-        if (condition(workingLoc)) {
-            EXTTerm *term = [self findTerm:workingLoc];
+        for (int i = 0; i < count; i++) {
+            lowerBounds[i] = (i == last) ? oldBounds[i] + 1 : 0;
+            counter[i] = lowerBounds[i];
+        }
         
-            // if it doesn't exist, create it
-            if (!term) {
-                term = [EXTTerm term:workingLoc
-                           withNames:[NSMutableArray array]
-                   andCharacteristic:self.defaultCharacteristic];
-                
-                [self.terms setObject:term forKey:workingLoc];
-            }
+        BOOL totalRollover = FALSE;
+        while (!totalRollover) {
+            EXTGrading grading = [[self.indexClass identityLocation] grading];
+            for (int i = 0; i < count; i++)
+                grading = EXTGradingAddMultiple(grading, gradings[i], counter[i]);
+            EXTLocation *workingLoc =
+                [self.indexClass locationWithGrading:grading];
             
-            // now add the new tag to its names array
-            EXTPolynomialTag *tag = [EXTPolynomialTag new];
-            tag.tags = [NSMutableDictionary dictionaryWithCapacity:generators.count];
-            for (int i = 0; i < generators.count; i++) {
-                NSInteger value = (NSInteger)CFArrayGetValueAtIndex(counter, i);
-                if (value != 0)
-                    [tag.tags setObject:@(value)
-                                 forKey:CFArrayGetValueAtIndex(names, i)];
+            if (condition(workingLoc)) {
+                NSMutableArray *tags = pending[workingLoc];
+                if (!tags)
+                    pending[workingLoc] = tags = [NSMutableArray array];
+                
+                [tags addObject:[EXTPolynomialTag tagWithExponents:counter
+                                                             count:count
+                                                        generators:generators]];
             }
-            [term.names addObject:tag];
             
-            // the new name is automatically a cycle and not a boundary.
-            term.cycles[0] = [EXTMatrix directSum:term.cycles[0] with:[EXTMatrix identity:1]];
-            term.boundaries[0] = [EXTMatrix directSum:term.boundaries[0] with:[EXTMatrix matrixWidth:0 height:1]];
-        
-            // also need to modify all incoming and outgoing differentials.
-            if (self.differentials.count > 0) {
-                EXTMatrix *inclusion = [EXTMatrix matrixWidth:(term.size-1)
-                                                       height:term.size];
-                int *inclusionData = inclusion.presentation.mutableBytes;
-                for (int i = 0; i < term.size-1; i++)
-                    inclusionData[i*inclusion.height + i] = 1;
-                for (int i = 1; i < self.differentials.count; i++) {
-                    EXTDifferential
-                        *outgoing = [self findDifflWithSource:workingLoc onPage:i],
-                        *incoming = [self findDifflWithTarget:workingLoc onPage:i];
-                    for (EXTPartialDefinition *p in outgoing.partialDefinitions)
-                        p.inclusion = [EXTMatrix newMultiply:inclusion
-                                                          by:p.inclusion];
-                    for (EXTPartialDefinition *p in incoming.partialDefinitions)
-                        p.action = [EXTMatrix newMultiply:inclusion
-                                                       by:p.action];
+            // increment the counter.  the generators after the last one stay
+            // inside their old bounds, which keeps the pieces disjoint.
+            for (int i = 0;
+                 i < count ? TRUE : !(totalRollover = TRUE);
+                 i++) {
+                int bound = (i > last) ? oldBounds[i] : upperBounds[i];
+                
+                if (counter[i] + 1 > bound) {
+                    counter[i] = lowerBounds[i];
+                    continue;
                 }
-            }
-        }
-        
-        // increment the counter
-        for (int i = 0;
-             i < generators.count ? TRUE : !(totalRollover = TRUE);
-             i++) {
-            NSInteger value = (NSInteger)CFArrayGetValueAtIndex(counter, i) + 1;
-            
-            // there are two kinds of roll-over
-            if ((i == ourIndex) && (value > newBound)) {
-                CFArraySetValueAtIndex(counter, i, (void*)(oldBound+1));
-                continue;
-            } else if ((i != ourIndex) &&
-                  (value > (NSInteger)CFArrayGetValueAtIndex(upperBounds, i))) {
-                CFArraySetValueAtIndex(counter, i, 0);
-                continue;
-            } else {
-                CFArraySetValueAtIndex(counter, i, (void*)value);
+                
+                counter[i]++;
                 break;
-            }
-        } // for: counter increment
-    } // while
+            } // for: counter increment
+        } // while
+    } // for: last
     
-    // store newBound as the new bound
-    ((NSMutableDictionary*)generators[ourIndex])[@"upperBound"] = @(newBound);
+    // now extend each term once, by all of its new tags together.  the new
+    // names are automatically cycles and not boundaries, and the differentials
+    // in and out only need their matrices padded out with zero rows.
+    for (EXTLocation *location in pending) {
+        NSArray *tags = pending[location];
+        int added = (int)tags.count;
+        EXTTerm *term = [self findTerm:location];
+        
+        if (!term) {
+            term = [EXTTerm term:location
+                       withNames:[NSMutableArray array]
+               andCharacteristic:self.defaultCharacteristic];
+            
+            [self.terms setObject:term forKey:location];
+        }
+        
+        [term.names addObjectsFromArray:tags];
+        
+        term.cycles[0] = [EXTMatrix directSum:term.cycles[0]
+                                         with:[EXTMatrix identity:added]];
+        term.boundaries[0] =
+            [EXTMatrix directSum:term.boundaries[0]
+                            with:[EXTMatrix matrixWidth:0 height:added]];
+        
+        // the term and its differentials are edited in place, so they have to
+        // be reported for the groups computed off of them to be thrown out.
+        [self invalidateTerm:term];
+        
+        EXTMatrix *padding = [EXTMatrix matrixWidth:0 height:added];
+        for (int page = 1; page < self.differentials.count; page++) {
+            EXTDifferential
+                *outgoing = [self findDifflWithSource:location onPage:page],
+                *incoming = [self findDifflWithTarget:location onPage:page];
+            for (EXTPartialDefinition *p in outgoing.partialDefinitions)
+                p.inclusion = [EXTMatrix directSum:p.inclusion with:padding];
+            for (EXTPartialDefinition *p in incoming.partialDefinitions)
+                p.action = [EXTMatrix directSum:p.action with:padding];
+            if (outgoing)
+                [self invalidateDifferential:outgoing];
+            if (incoming)
+                [self invalidateDifferential:incoming];
+        }
+    }
     
-    CFRelease(counter);
-    CFRelease(locations);
-    CFRelease(upperBounds);
-    CFRelease(names);
+    // store the new bounds
+    for (int i = 0; i < count; i++)
+        ((NSMutableDictionary*)generators[i])[@"upperBound"] = @(upperBounds[i]);
     
     return;
 }
@@ -383,36 +600,108 @@
 // builds the multiplication matrix for a pair of EXTLocations
 -(EXTMatrix*) productWithLeft:(EXTLocation*)leftLoc
                         right:(EXTLocation*)rightLoc {
+    return [self productWithLeft:leftLoc through:nil
+                           right:rightLoc through:nil];
+}
+
+// the pairs of nonzero entries of the two maps are the only products that
+// contribute, and each of them multiplies a single pair of monomials, so this
+// never forms the kronecker product or the (mostly zero) structure matrix.
+// where each pair of monomials lands, and with what sign, is worked out the
+// first time that pair comes up.
+-(EXTMatrix*) productWithLeft:(EXTLocation*)leftLoc
+                      through:(EXTMatrix*)leftMap
+                        right:(EXTLocation*)rightLoc
+                      through:(EXTMatrix*)rightMap {
     EXTTerm *left = [self findTerm:leftLoc],
            *right = [self findTerm:rightLoc],
           *target = [self findTerm:[[leftLoc class] addLocation:leftLoc to:rightLoc]];
+    int leftSize = left.size, rightSize = right.size,
+        rightWidth = rightMap ? (int)rightMap.width : rightSize,
+        width = (leftMap ? (int)leftMap.width : leftSize) * rightWidth,
+        characteristic = self.defaultCharacteristic;
     
-    EXTMatrix *ret = [EXTMatrix matrixWidth:(left.size*right.size)
-                                     height:target.size];
-    ret.characteristic = self.defaultCharacteristic;
-    
-    int *retData = ret.presentation.mutableBytes;
-    for (int i = 0; i < left.size; i++)
-    for (int j = 0; j < right.size; j++) {
-        EXTPolynomialTag *sumTag = [EXTPolynomialTag sum:left.names[i]
-                                                    with:right.names[j]];
-        int index = [target.names indexOfObject:sumTag];
-        if (index != -1) {
-            if (self.defaultCharacteristic == 2)
-                retData[(i*right.size+j)*ret.height+index] = 1;
-            else
-                retData[(i*right.size+j)*ret.height+index] =
-                                [self koszulSignForMultiplying:left.names[i]
-                                                            by:right.names[j]];
+    EXTMapEntries leftEntries = EXTMapEntriesOf(leftMap, leftSize),
+                  rightEntries = EXTMapEntriesOf(rightMap, rightSize);
+    
+    NSArray *leftNames = left.names, *rightNames = right.names;
+    NSDictionary *targetIndices = [self indicesOfNamesInTerm:target];
+    
+    int words = EXTParityMaskWords(generators.count);
+    uint64_t *odd = malloc(sizeof(uint64_t) * words),
+             *leftSuffixes = malloc(sizeof(uint64_t) * words * (leftSize + 1)),
+             *rightMasks = malloc(sizeof(uint64_t) * words * (rightSize + 1));
+    EXTOddGeneratorMask(generators, words, odd);
+    for (int i = 0; i < leftSize; i++)
+        EXTTagParityMask(leftNames[i], odd, words, YES, leftSuffixes + i*words);
+    for (int j = 0; j < rightSize; j++)
+        EXTTagParityMask(rightNames[j], odd, words, NO, rightMasks + j*words);
+    
+    // the index of the product of left.names[i] and right.names[j] in the
+    // target, -1 if it isn't there and -2 if it hasn't been looked up yet.
+    size_t pairs = (size_t)leftSize * rightSize;
+    int *products = malloc(sizeof(int) * (pairs + 1)),
+        *signs = malloc(sizeof(int) * (pairs + 1));
+    for (size_t k = 0; k < pairs; k++)
+        products[k] = -2;
+    
+    size_t capacity = leftEntries.count * rightEntries.count, count = 0;
+    int *columns = malloc(sizeof(int) * (capacity + 1)),
+        *rows = malloc(sizeof(int) * (capacity + 1)),
+        *values = malloc(sizeof(int) * (capacity + 1));
+    
+    for (size_t a = 0; a < leftEntries.count; a++)
+    for (size_t b = 0; b < rightEntries.count; b++) {
+        int i = leftEntries.rows[a], j = rightEntries.rows[b];
+        size_t k = (size_t)i * rightSize + j;
+        
+        if (products[k] == -2) {
+            NSNumber *index =
+                targetIndices[[EXTPolynomialTag sum:leftNames[i]
+                                               with:rightNames[j]]];
+            products[k] = index ? index.intValue : -1;
+            signs[k] = characteristic == 2 ? 1 :
+                            EXTKoszulSign(leftSuffixes + i*words,
+                                          rightMasks + j*words, words);
         }
+        if (products[k] < 0)
+            continue;
+        
+        int64_t value = (int64_t)leftEntries.values[a] *
+                        rightEntries.values[b] * signs[k];
+        columns[count] = leftEntries.columns[a] * rightWidth +
+                         rightEntries.columns[b];
+        rows[count] = products[k];
+        values[count++] = (int)(characteristic ? value % characteristic : value);
     }
     
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width
+                                     height:target.size
+                                    entries:count
+                                    columns:columns
+                                       rows:rows
+                                     values:values
+                             characteristic:characteristic];
+    
+    free(columns); free(rows); free(values);
+    free(products); free(signs);
+    free(odd); free(leftSuffixes); free(rightMasks);
+    EXTMapEntriesFree(&leftEntries);
+    EXTMapEntriesFree(&rightEntries);
+    
     return ret;
 }
 
--(void) computeLeibniz:(EXTLocation *)loc1
-                  with:(EXTLocation *)loc2
-                onPage:(int)page {
+// the products are read off the tags as they're asked for, so there's nothing
+// to assemble ahead of time (and no multiplication tables to assemble into).
+-(void) prepareProductsForPairs:(NSArray*)pairs {
+    return;
+}
+
+-(void) addLeibnizPartialsFor:(EXTLocation *)loc1
+                         with:(EXTLocation *)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential *)dsum {
     EXTLocation *sumLoc = [[loc1 class] addLocation:loc1 to:loc2],
     *targetLoc = [[loc1 class] followDiffl:sumLoc page:page];
     EXTTerm *sumterm = [self findTerm:sumLoc],
@@ -421,28 +710,9 @@
     *B = [self findTerm:loc2];
     EXTDifferential *d1 = [self findDifflWithSource:loc1 onPage:page],
     *d2 = [self findDifflWithSource:loc2 onPage:page];
-    
-    // if we don't have differentials to work with, then skip this entirely.
-    // XXX: i'm not sure this condition is quite right.
     BOOL d1Zero = [self isInZeroRanges:[[loc1 class] followDiffl:loc1
                                                             page:page]],
     d2Zero = [self isInZeroRanges:[[loc2 class] followDiffl:loc2 page:page]];
-    if ((!d1 && !d1Zero) ||
-        (!d2 && !d2Zero) ||
-        !targetterm ||
-        [self isInZeroRanges:sumLoc] ||
-        !sumterm ||
-        [self isInZeroRanges:targetLoc])
-        return;
-    
-    // if we're here, then we have all the fixin's we need to construct some
-    // more partial differential definitions.  let's find a place to put them.
-    EXTDifferential *dsum = [self findDifflWithSource:sumterm.location
-                                               onPage:page];
-    if (!dsum) {
-        dsum = [EXTDifferential differential:sumterm end:targetterm page:page];
-        [self addDifferential:dsum];
-    }
     
     // TODO: note that this is duplicated code from EXTMultiplicationTables.
     // there's a reason for this: this is meant to be optimized for the
@@ -463,22 +733,19 @@
              [self.locConvertor convertToString:loc2]];
         [dsum.partialDefinitions addObject:allZero];
     } else if (d1Zero && !d2Zero) {
+        EXTLocation *Y = [[loc2 class] followDiffl:loc2 page:page];
+        
         for (EXTPartialDefinition *partial2 in d2.partialDefinitions) {
             // in this case, we only have the right-hand differential, so
             // d(xy) = 0 + x dy.  this means building the span
             // A|B <-1|j- A|J -1|partial-> A|Y --mu-> Z.
-            EXTMatrix *muAY = [self productWithLeft:loc1 right:
-                                [[loc2 class] followDiffl:loc2 page:page]],
-                      *muAB = [self productWithLeft:loc1 right:loc2];
-            
             EXTPartialDefinition *partial = [EXTPartialDefinition new];
-            partial.inclusion =
-                [EXTMatrix newMultiply:muAB by:
-                    [EXTMatrix hadamardProduct:[EXTMatrix identity:A.size]
-                                          with:partial2.inclusion]];
-            partial.action = [EXTMatrix newMultiply:muAY by:
-                    [EXTMatrix hadamardProduct:[EXTMatrix identity:A.size]
-                                          with:partial2.action]];
+            partial.inclusion = [self productWithLeft:loc1 through:nil
+                                                right:loc2
+                                              through:partial2.inclusion];
+            partial.action = [self productWithLeft:loc1 through:nil
+                                             right:Y
+                                           through:partial2.action];
             partial.description =
                 [NSString stringWithFormat:@"Leibniz rule on %@ and %@",
                     [self.locConvertor convertToString:loc1],
@@ -487,24 +754,19 @@
             [dsum.partialDefinitions addObject:partial];
         }
     } else if (!d1Zero && d2Zero) {
+        EXTLocation *X = [[loc1 class] followDiffl:loc1 page:page];
+        
         for (EXTPartialDefinition *partial1 in d1.partialDefinitions) {
             // in this case, we only have the left-hand differential, so
             // d(xy) = dx y.  this means building the span
             // A|B <-i|1- I|B -partial|1-> X|B --mu-> Z.
-            EXTMatrix
-                *muXB = [self productWithLeft:
-                          [[loc1 class] followDiffl:loc1 page:page] right:loc2],
-                *muAB = [self productWithLeft:loc1 right:loc2];
-            
             EXTPartialDefinition *partial = [EXTPartialDefinition new];
-            partial.inclusion =
-                [EXTMatrix newMultiply:muAB by:
-                    [EXTMatrix hadamardProduct:partial1.inclusion
-                                          with:[EXTMatrix identity:B.size]]];
-            partial.action =
-                [EXTMatrix newMultiply:muXB by:
-                    [EXTMatrix hadamardProduct:partial1.action
-                                          with:[EXTMatrix identity:B.size]]];
+            partial.inclusion = [self productWithLeft:loc1
+                                              through:partial1.inclusion
+                                                right:loc2 through:nil];
+            partial.action = [self productWithLeft:X
+                                           through:partial1.action
+                                             right:loc2 through:nil];
             partial.description =
                 [NSString stringWithFormat:@"Leibniz rule on %@ and %@",
                     [self.locConvertor convertToString:loc1],
@@ -513,21 +775,19 @@
             [dsum.partialDefinitions addObject:partial];
         }
     } else {
+        EXTLocation *X = [[loc1 class] followDiffl:loc1 page:page],
+                    *Y = [[loc2 class] followDiffl:loc2 page:page];
+        
         for (EXTPartialDefinition *partial1 in d1.partialDefinitions)
         for (EXTPartialDefinition *partial2 in d2.partialDefinitions) {
             // in this case, we only both differentials, so d(xy) = dx y + x dy.
             // this means building both spans, then taking their intersection,
-            // and summing their action on the intersection.
+            // and summing their action on the intersection.  only the
+            // intersection needs the inclusions as kronecker products (which
+            // it can work with unformed); the legs through mu go straight
+            // through the monomial products.
             //
             // XXX: should there be a koszul sign here??
-            EXTMatrix
-                *muAY = [self productWithLeft:loc1
-                               right:[[loc2 class] followDiffl:loc2 page:page]],
-                *muXB = [self productWithLeft:
-                          [[loc1 class] followDiffl:loc1 page:page] right:loc2],
-                *muAB = [self productWithLeft:loc1 right:loc2];
-
-            
             EXTMatrix
                 *rightInclusion =
                     [EXTMatrix hadamardProduct:[EXTMatrix identity:A.size]
@@ -535,21 +795,22 @@
                 *leftInclusion =
                     [EXTMatrix hadamardProduct:partial1.inclusion
                                           with:[EXTMatrix identity:B.size]],
-                *rightMultiply =
-                    [EXTMatrix newMultiply:muAY by:
-                        [EXTMatrix hadamardProduct:[EXTMatrix identity:A.size]
-                                              with:partial2.action]],
-                *leftMultiply =
-                    [EXTMatrix newMultiply:muXB by:
-                       [EXTMatrix hadamardProduct:partial1.action
-                                             with:[EXTMatrix identity:B.size]]];
+                *rightMultiply = [self productWithLeft:loc1 through:nil
+                                                 right:Y
+                                               through:partial2.action],
+                *leftMultiply = [self productWithLeft:X
+                                              through:partial1.action
+                                                right:loc2 through:nil];
             
             NSArray *pair = [EXTMatrix formIntersection:leftInclusion
                                                    with:rightInclusion];
             
             EXTPartialDefinition *partial = [EXTPartialDefinition new];
-            partial.inclusion = [EXTMatrix newMultiply:muAB by:
-                            [EXTMatrix newMultiply:leftInclusion by:pair[0]]];
+            partial.inclusion =
+                [EXTMatrix newMultiply:[self productWithLeft:loc1
+                                                     through:partial1.inclusion
+                                                       right:loc2 through:nil]
+                                    by:pair[0]];
             partial.action =
                [EXTMatrix sum:[EXTMatrix newMultiply:leftMultiply by:pair[0]]
                          with:[EXTMatrix newMultiply:rightMultiply by:pair[1]]];
@@ -565,8 +826,6 @@
     if (![dsum checkForSanity])
         NSLog(@"checkForSanity in computeLeibniz failed to pass.");
     
-    [dsum stripDuplicates];
-    
     return;
 }
 
@@ -581,22 +840,20 @@
             entry = generator;
     }
     
-    for (EXTTerm *term in self.terms.allValues) {
-        for (EXTPolynomialTag *tag in term.names) {
-            NSNumber *exponent = [tag.tags objectForKey:name];
-            if (!exponent)
-                continue;
-            [tag.tags setObject:exponent forKey:newName];
-            [tag.tags removeObjectForKey:name];
-        }
-    }
-    
+    // the tags read their names out of the generator entries, so this is all.
     entry[@"name"] = newName;
+    [self invalidateGeneratorIndices];
     
     return;
 }
 
 - (void)deleteClass:(NSObject<NSCopying> *)name {
+    NSNumber *generatorIndex = [self generatorIndices][name];
+    if (!generatorIndex)
+        return;
+    int row = generatorIndex.intValue;
+    
+    // the surviving tags move down into the positions of the generators left.
     for (EXTTerm *term in self.terms.allValues) {
         NSMutableArray *indexList = [NSMutableArray array],
                        *saveList = [NSMutableArray array];
@@ -604,11 +861,21 @@
         
         for (int index = 0; index < term.size; index++) {
             EXTPolynomialTag *tag = term.names[index];
-            NSNumber *exponent = [tag.tags objectForKey:name];
-            if ((exponent) && ([exponent intValue] != 0))
+            if ([tag exponentOf:row] != 0)
                 continue;
+            
+            int exponents[MAX(tag.length, 1)];
+            for (int i = 0, j = 0; i < tag.length; i++)
+                if (i != row)
+                    exponents[j++] = [tag exponentOf:i];
+            
             [indexList addObject:@(index)];
-            [saveList addObject:tag];
+            [saveList addObject:
+                [EXTPolynomialTag tagWithExponents:exponents
+                                             count:(tag.length > row ?
+                                                    tag.length - 1 :
+                                                    tag.length)
+                                        generators:generators]];
         }
         
         EXTMatrix *inclusion = [EXTMatrix matrixWidth:indexList.count
@@ -649,47 +916,92 @@
                                                         by:pair[0]];
                 partial.action = pair[1];
             }
+            
+            // the partial definitions were edited in place.
+            if (outgoing)
+                [self invalidateDifferential:outgoing];
+            if (incoming)
+                [self invalidateDifferential:incoming];
         } // differential pages
         
         term.names = saveList;
+        [self invalidateTerm:term];
     } // term
     
-    NSUInteger row = -1;
-    for (int i = 0; i < generators.count; i++)
-        if ([[generators[i] objectForKey:@"name"] isEqual:name]) {
-            row = i; break;
-        }
-    
     [generators removeObjectAtIndex:row];
+    [self invalidateGeneratorIndices];
 }
 
 -(NSObject<EXTLocation> *)computeLocationForTag:(EXTPolynomialTag *)tag {
-    EXTLocation *loc = [self.indexClass identityLocation];
+    EXTGrading grading = [[self.indexClass identityLocation] grading];
     
-    for (int i = 0; i < generators.count; i++) {
-        NSMutableDictionary *entry = generators[i];
-        NSNumber *amount = tag.tags[entry[@"name"]];
-        if (amount)
-            loc = [self.indexClass addLocation:loc to:[self.indexClass scale:entry[@"location"] by:[amount intValue]]];
-    }
+    for (int i = 0; i < tag.length; i++)
+        grading = EXTGradingAddMultiple(grading,
+                                        [generators[i][@"location"] grading],
+                                        [tag exponentOf:i]);
     
-    return loc;
+    return [self.indexClass locationWithGrading:grading];
 }
 
 -(int)koszulSignForMultiplying:(EXTPolynomialTag *)left
                             by:(EXTPolynomialTag *)right {
-    int power = 1;
+    int words = EXTParityMaskWords(generators.count);
+    uint64_t odd[words], leftSuffix[words], rightMask[words];
     
-    for (int j = 0; j < self.generators.count; j++) {
-        for (int i = j; i < self.generators.count; i++) {
-            // commute the thing in right[j] across the things in left[i]
-            int rightj = [right.tags[generators[j][@"name"]] intValue],
-                lefti  = [left.tags[generators[i][@"name"]] intValue];
-            power += rightj * lefti * [(EXTLocation*)generators[i][@"location"] koszulDegree] * [(EXTLocation*)generators[j][@"location"] koszulDegree];
+    EXTOddGeneratorMask(generators, words, odd);
+    EXTTagParityMask(left, odd, words, YES, leftSuffix);
+    EXTTagParityMask(right, odd, words, NO, rightMask);
+    
+    return EXTKoszulSign(leftSuffix, rightMask, words);
+}
+
+#pragma mark - lookups
+
+-(NSDictionary*) generatorIndices {
+    @synchronized (self) {
+        if (!generatorIndices) {
+            NSMutableDictionary *indices =
+                [NSMutableDictionary dictionaryWithCapacity:generators.count];
+            for (int i = 0; i < generators.count; i++)
+                indices[generators[i][@"name"]] = @(i);
+            generatorIndices = indices;
         }
+        
+        return generatorIndices;
     }
+}
+
+-(void) invalidateGeneratorIndices {
+    @synchronized (self) {
+        generatorIndices = nil;
+    }
+}
+
+// the maps are kept per term, and rebuilt whenever the term's names array is
+// replaced or grows.  (tags are immutable, so nothing else can change them.)
+// products are computed in parallel, so the cache is guarded.
+-(NSDictionary*) indicesOfNamesInTerm:(EXTTerm*)term {
+    if (!term)
+        return nil;
     
-    return power & 0x1 ? -1 : 1;
+    @synchronized (self) {
+        if (!nameIndices)
+            nameIndices = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality) valueOptions:NSPointerFunctionsStrongMemory];
+        
+        NSArray *names = term.names, *cached = [nameIndices objectForKey:term];
+        if (cached && cached[0] == names &&
+            [cached[1] unsignedIntegerValue] == names.count)
+            return cached[2];
+        
+        NSMutableDictionary *indices =
+            [NSMutableDictionary dictionaryWithCapacity:names.count];
+        // the first occurrence wins, as it did with -indexOfObject:.
+        for (NSUInteger i = names.count; i > 0; i--)
+            indices[names[i-1]] = @(i-1);
+        [nameIndices setObject:@[names, @(names.count), indices] forKey:term];
+        
+        return indices;
+    }
 }
 
 -(EXTPolynomialSSeq *)flattenSSeqAtPage:(int)page
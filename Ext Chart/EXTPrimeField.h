@@ -0,0 +1,60 @@
+//
+//  EXTPrimeField.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// arithmetic in F_p for p prime, tuned for gaussian elimination: reductions go
+// through a precomputed barrett factor rather than a hardware divide, and
+// inverses of small primes come from a table built once per prime.
+//
+// EXTMatrix switches over to the elimination routine below whenever its
+// characteristic is an odd prime; characteristic 2 has its own bit-packed
+// routines in EXTBitMatrix.
+typedef struct {
+    uint32_t characteristic;
+    uint64_t barrettFactor;       // floor((2^64 - 1) / p)
+    uint64_t maxPendingUpdates;   // axpys a reduced column survives unreduced
+    uint32_t *inverses;           // NULL for primes too large to tabulate
+} EXTPrimeField;
+
+/// returns a shared, immortal description of F_p, or NULL if the
+/// characteristic isn't prime.  safe to call from any thread.
+const EXTPrimeField *EXTPrimeFieldForCharacteristic(NSUInteger characteristic);
+
+static inline uint32_t EXTPrimeFieldReduce(const EXTPrimeField *field,
+                                           uint64_t x) {
+    uint64_t quotient = (uint64_t)(((__uint128_t)x * field->barrettFactor) >> 64),
+             remainder = x - quotient * field->characteristic;
+
+    while (remainder >= field->characteristic)
+        remainder -= field->characteristic;
+
+    return (uint32_t)remainder;
+}
+
+static inline uint32_t EXTPrimeFieldReduceSigned(const EXTPrimeField *field,
+                                                 int64_t x) {
+    if (x >= 0)
+        return EXTPrimeFieldReduce(field, (uint64_t)x);
+
+    uint32_t negative = EXTPrimeFieldReduce(field, (uint64_t)(-x));
+    return negative ? field->characteristic - negative : 0;
+}
+
+uint32_t EXTPrimeFieldInverse(const EXTPrimeField *field, uint32_t x);
+
+/// gauss-jordan column reduction over F_p of the rows [0, limit) of an
+/// int-valued, column-major matrix, in place.  afterwards every entry lies in
+/// [0, p), each pivot is 1, and each pivot row is zero away from its pivot.
+/// if pivotColumns is non-NULL, it receives (for each row < limit) the column
+/// used as that row's pivot, or -1.  returns the number of pivots.
+///
+/// to track the column operations, append an identity block below the matrix
+/// and pass the original height as the limit.
+int EXTPrimeFieldColumnReduce(const EXTPrimeField *field, int *data,
+                              int width, int height, int limit,
+                              int *pivotColumns);
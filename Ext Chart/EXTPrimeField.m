@@ -0,0 +1,174 @@
+//
+//  EXTPrimeField.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTPrimeField.h"
+#import "EXTScratch.h"
+#include <pthread.h>
+
+// primes up to this size get a full table of inverses.
+#define EXT_PRIME_FIELD_TABLE_LIMIT 65536
+
+typedef struct EXTPrimeFieldCacheEntry {
+    NSUInteger characteristic;
+    EXTPrimeField *field; // NULL records that the characteristic isn't prime
+    struct EXTPrimeFieldCacheEntry *next;
+} EXTPrimeFieldCacheEntry;
+
+static EXTPrimeFieldCacheEntry *EXTPrimeFieldCache = NULL;
+static pthread_mutex_t EXTPrimeFieldCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool EXTIsPrime(NSUInteger n) {
+    if (n < 2)
+        return false;
+    for (NSUInteger d = 2; d*d <= n; d++)
+        if (n % d == 0)
+            return false;
+    return true;
+}
+
+static EXTPrimeField *EXTPrimeFieldCreate(uint32_t p) {
+    EXTPrimeField *field = calloc(1, sizeof(EXTPrimeField));
+
+    field->characteristic = p;
+    field->barrettFactor = UINT64_MAX / p;
+    // a reduced column gains less than (p-1)^2 per axpy; stay below 2^64.
+    field->maxPendingUpdates = (p > 2) ?
+        (UINT64_MAX - p) / ((uint64_t)(p - 1) * (p - 1)) : UINT64_MAX;
+    if (field->maxPendingUpdates == 0)
+        field->maxPendingUpdates = 1;
+
+    if (p <= EXT_PRIME_FIELD_TABLE_LIMIT) {
+        field->inverses = calloc(p, sizeof(uint32_t));
+        field->inverses[1] = 1;
+        // the usual recurrence: 1/i = -(p/i) * 1/(p mod i).
+        for (uint32_t i = 2; i < p; i++)
+            field->inverses[i] = (uint32_t)((uint64_t)(p - p/i) *
+                                            field->inverses[p % i] % p);
+    }
+
+    return field;
+}
+
+const EXTPrimeField *EXTPrimeFieldForCharacteristic(NSUInteger characteristic) {
+    if (characteristic < 2 || characteristic > INT32_MAX)
+        return NULL;
+
+    pthread_mutex_lock(&EXTPrimeFieldCacheLock);
+
+    EXTPrimeFieldCacheEntry *entry = EXTPrimeFieldCache;
+    while (entry && entry->characteristic != characteristic)
+        entry = entry->next;
+
+    if (!entry) {
+        entry = calloc(1, sizeof(EXTPrimeFieldCacheEntry));
+        entry->characteristic = characteristic;
+        entry->field = EXTIsPrime(characteristic) ?
+                            EXTPrimeFieldCreate((uint32_t)characteristic) : NULL;
+        entry->next = EXTPrimeFieldCache;
+        EXTPrimeFieldCache = entry;
+    }
+
+    pthread_mutex_unlock(&EXTPrimeFieldCacheLock);
+
+    return entry->field;
+}
+
+uint32_t EXTPrimeFieldInverse(const EXTPrimeField *field, uint32_t x) {
+    if (field->inverses)
+        return field->inverses[x];
+
+    // extended euclid, tracking only the coefficient of x.
+    int64_t rOld = field->characteristic, rNew = x, tOld = 0, tNew = 1;
+    while (rNew != 0) {
+        int64_t quotient = rOld / rNew, temp;
+
+        temp = rNew; rNew = rOld - quotient * rNew; rOld = temp;
+        temp = tNew; tNew = tOld - quotient * tNew; tOld = temp;
+    }
+
+    return EXTPrimeFieldReduceSigned(field, tOld);
+}
+
+int EXTPrimeFieldColumnReduce(const EXTPrimeField *field, int *data,
+                              int width, int height, int limit,
+                              int *pivotColumns) {
+    uint32_t p = field->characteristic;
+    int rank = 0;
+
+    // we work on 64-bit entries so that a column can absorb several axpys
+    // before it needs reducing; pending[i] counts those since the last one.
+    EXTScratchMark mark = EXTScratchSave();
+    uint64_t *work = EXTScratchAlloc(sizeof(uint64_t) * ((size_t)width * height + 1));
+    uint64_t *pending = EXTScratchCalloc(width + 1, sizeof(uint64_t));
+    bool *usedColumns = EXTScratchCalloc(width + 1, sizeof(bool));
+
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        work[i] = EXTPrimeFieldReduceSigned(field, data[i]);
+
+    limit = MIN(limit, height);
+
+    for (int pivotRow = 0; pivotRow < limit; pivotRow++) {
+        int pivotColumn = -1;
+
+        if (pivotColumns)
+            pivotColumns[pivotRow] = -1;
+
+        for (int i = 0; i < width; i++) {
+            if (usedColumns[i])
+                continue;
+            if (EXTPrimeFieldReduce(field, work[(size_t)i*height + pivotRow])) {
+                pivotColumn = i;
+                break;
+            }
+        }
+
+        if (pivotColumn == -1)
+            continue;
+
+        usedColumns[pivotColumn] = true;
+        if (pivotColumns)
+            pivotColumns[pivotRow] = pivotColumn;
+        rank++;
+
+        // normalize the pivot column, which also leaves it fully reduced.
+        uint64_t *pivot = work + (size_t)pivotColumn*height;
+        uint64_t scale = EXTPrimeFieldInverse(field,
+                            EXTPrimeFieldReduce(field, pivot[pivotRow]));
+        for (int j = 0; j < height; j++)
+            pivot[j] = EXTPrimeFieldReduce(field,
+                            EXTPrimeFieldReduce(field, pivot[j]) * scale);
+        pending[pivotColumn] = 0;
+
+        // clear this row out of every other column by an unreduced axpy.
+        for (int i = 0; i < width; i++) {
+            if (i == pivotColumn)
+                continue;
+
+            uint64_t *column = work + (size_t)i*height;
+            uint32_t entry = EXTPrimeFieldReduce(field, column[pivotRow]);
+            if (entry == 0)
+                continue;
+
+            uint64_t factor = p - entry;
+            for (int j = 0; j < height; j++)
+                column[j] += factor * pivot[j];
+
+            if (++pending[i] >= field->maxPendingUpdates) {
+                for (int j = 0; j < height; j++)
+                    column[j] = EXTPrimeFieldReduce(field, column[j]);
+                pending[i] = 0;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        data[i] = (int)EXTPrimeFieldReduce(field, work[i]);
+
+    EXTScratchRestore(mark);
+
+    return rank;
+}
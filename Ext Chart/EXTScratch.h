@@ -0,0 +1,47 @@
+//
+//  EXTScratch.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// a per-thread arena for the temporaries of the linear algebra routines: the
+// augmented matrices of reductions, the [P, -Q] of an intersection, pivot
+// tables, and so on.  a routine notes where the arena stands, carves out what
+// it needs, and hands all of it back at once when it's done:
+//
+//     EXTScratchMark mark = EXTScratchSave();
+//     int *pivots = EXTScratchAlloc(sizeof(int) * height);
+//     ...
+//     EXTScratchRestore(mark);
+//
+// marks nest, so routines which use the arena can call one another.  the
+// arena hangs on to its memory from one use to the next, so once it has grown
+// to fit a computation, running that computation again doesn't touch the heap.
+typedef struct {
+    void *chunk;
+    size_t offset;
+} EXTScratchMark;
+
+// the smallest chunk the arena takes from the heap.
+#define EXT_SCRATCH_CHUNK_SIZE (1 << 20)
+
+EXTScratchMark EXTScratchSave(void);
+void EXTScratchRestore(EXTScratchMark mark);
+
+/// uninitialized, 16-byte aligned, and good until the enclosing restore.
+void *EXTScratchAlloc(size_t bytes);
+/// zero-filled, and otherwise as EXTScratchAlloc.
+void *EXTScratchCalloc(size_t count, size_t size);
+
+/// the number of buffers taken from the heap for the entries of matrices so
+/// far (dense, sparse or bit-packed), counting the arena's own chunks and the
+/// few temporaries which can't live in it, so that tests and benchmarks can
+/// check that a computation stays off of it.  anything in the kernels that
+/// calls malloc directly should report here.
+uint64_t EXTHeapAllocationCount(void);
+/// the total size of those buffers, in bytes.
+uint64_t EXTHeapAllocationBytes(void);
+void EXTCountHeapAllocation(size_t bytes);
@@ -0,0 +1,122 @@
+//
+//  EXTScratch.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTScratch.h"
+
+#include <pthread.h>
+
+typedef struct EXTScratchChunk {
+    struct EXTScratchChunk *next;
+    size_t size;
+    _Alignas(16) unsigned char data[];
+} EXTScratchChunk;
+
+// allocations are handed out from current, starting at offset.  every chunk
+// after current is free, since marks are restored in the reverse order to
+// which they're saved.  a NULL current means nothing is in use at all.
+typedef struct {
+    EXTScratchChunk *first, *current;
+    size_t offset;
+} EXTScratchArena;
+
+static __thread EXTScratchArena EXTScratchThreadArena;
+
+// hands a thread's chunks back to the heap when the thread exits.
+static pthread_key_t EXTScratchArenaKey;
+static pthread_once_t EXTScratchArenaKeyOnce = PTHREAD_ONCE_INIT;
+
+static uint64_t EXTHeapAllocations = 0, EXTHeapBytes = 0;
+
+uint64_t EXTHeapAllocationCount(void) {
+    return __atomic_load_n(&EXTHeapAllocations, __ATOMIC_RELAXED);
+}
+
+uint64_t EXTHeapAllocationBytes(void) {
+    return __atomic_load_n(&EXTHeapBytes, __ATOMIC_RELAXED);
+}
+
+void EXTCountHeapAllocation(size_t bytes) {
+    __atomic_fetch_add(&EXTHeapAllocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&EXTHeapBytes, bytes, __ATOMIC_RELAXED);
+}
+
+static void EXTScratchFreeChunks(EXTScratchChunk *chunk) {
+    while (chunk) {
+        EXTScratchChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+static void EXTScratchReleaseArena(void *arena) {
+    EXTScratchFreeChunks(((EXTScratchArena*)arena)->first);
+}
+
+static void EXTScratchCreateArenaKey(void) {
+    pthread_key_create(&EXTScratchArenaKey, EXTScratchReleaseArena);
+}
+
+static EXTScratchChunk *EXTScratchCreateChunk(size_t size) {
+    EXTScratchChunk *ret = malloc(sizeof(EXTScratchChunk) + size);
+    ret->next = NULL;
+    ret->size = size;
+    EXTCountHeapAllocation(sizeof(EXTScratchChunk) + size);
+
+    return ret;
+}
+
+EXTScratchMark EXTScratchSave(void) {
+    EXTScratchArena *arena = &EXTScratchThreadArena;
+
+    return (EXTScratchMark){arena->current, arena->offset};
+}
+
+void EXTScratchRestore(EXTScratchMark mark) {
+    EXTScratchArena *arena = &EXTScratchThreadArena;
+
+    arena->current = mark.chunk;
+    arena->offset = mark.offset;
+}
+
+void *EXTScratchAlloc(size_t bytes) {
+    EXTScratchArena *arena = &EXTScratchThreadArena;
+    bytes = (bytes + 15) & ~(size_t)15;
+
+    if (arena->current && arena->offset + bytes <= arena->current->size) {
+        void *ret = arena->current->data + arena->offset;
+        arena->offset += bytes;
+        return ret;
+    }
+
+    // move on to the next chunk if it's big enough, and otherwise trade the
+    // free chunks in for one that is.
+    EXTScratchChunk **next = arena->current ? &arena->current->next :
+                                              &arena->first;
+    if (!*next || (*next)->size < bytes) {
+        size_t size = MAX(bytes, (size_t)EXT_SCRATCH_CHUNK_SIZE);
+        if (arena->current)
+            size = MAX(size, 2 * arena->current->size);
+
+        EXTScratchFreeChunks(*next);
+        *next = EXTScratchCreateChunk(size);
+
+        pthread_once(&EXTScratchArenaKeyOnce, EXTScratchCreateArenaKey);
+        pthread_setspecific(EXTScratchArenaKey, arena);
+    }
+
+    arena->current = *next;
+    arena->offset = bytes;
+
+    return arena->current->data;
+}
+
+void *EXTScratchCalloc(size_t count, size_t size) {
+    void *ret = EXTScratchAlloc(count * size);
+    memset(ret, 0, count * size);
+
+    return ret;
+}
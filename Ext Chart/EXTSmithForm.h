@@ -0,0 +1,38 @@
+//
+//  EXTSmithForm.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// presents quotients of lattices Z/B over the integers without the silent
+// overflow of the int-valued elimination in EXTMatrix.
+//
+// the coordinates of B in terms of Z are found by solving modulo several
+// word-size primes and chinese remaindering until the lift checks out exactly.
+// those coordinates are then brought to echelon form by unimodular row moves in
+// checked 128-bit arithmetic, which splits off the free part of Z/B.  what
+// remains has finite index, bounded by the product D of the echelon pivots, so
+// the torsion part is diagonalized with every entry kept reduced modulo D.
+// nothing here ever wraps around: if a value outgrows the arithmetic, the
+// routine says so rather than returning garbage.
+typedef struct {
+    int count;            // number of nontrivial cyclic summands
+    int length;           // length of each generator, i.e., the height of Z
+    int64_t *generators;  // column-major, count columns of the given length
+    int64_t *orders;      // the order of each summand, with 0 for Z itself
+} EXTSmithForm;
+
+/// B and Z are int-valued, column-major, of the common given height, and the
+/// columns of Z must be linearly independent with span containing those of B.
+/// on success, fills out result with generators (written in the ambient
+/// coordinates, i.e., as columns Z.v) of the cyclic summands of Z/B other than
+/// the trivial ones, and returns true.  returns false if B doesn't live in Z,
+/// or if the computation would overflow.
+bool EXTSmithFormOfQuotient(const int *B, int bWidth,
+                            const int *Z, int zWidth,
+                            int height, EXTSmithForm *result);
+
+void EXTSmithFormFree(EXTSmithForm *form);
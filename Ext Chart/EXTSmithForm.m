@@ -0,0 +1,485 @@
+//
+//  EXTSmithForm.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTSmithForm.h"
+#import "EXTPrimeField.h"
+#import "EXTScratch.h"
+
+typedef __int128 EXTWideInt;
+
+// the largest primes below 2^31, so that residues fit in an int and products
+// of two of them fit in a uint64_t.
+static const uint32_t EXTSmithFormPrimes[] = {
+    2147483647, 2147483629, 2147483587, 2147483579, 2147483563, 2147483549
+};
+#define EXT_SMITH_FORM_PRIME_COUNT \
+    (int)(sizeof(EXTSmithFormPrimes) / sizeof(EXTSmithFormPrimes[0]))
+
+// a == b*s + c*t, failing on overflow.
+static inline bool EXTWideCombine(EXTWideInt *a, EXTWideInt b, EXTWideInt s,
+                                  EXTWideInt c, EXTWideInt t) {
+    EXTWideInt left, right;
+
+    return !__builtin_mul_overflow(b, s, &left) &&
+           !__builtin_mul_overflow(c, t, &right) &&
+           !__builtin_add_overflow(left, right, a);
+}
+
+static inline EXTWideInt EXTWideAbs(EXTWideInt x) {
+    return (x < 0) ? -x : x;
+}
+
+// the q minimizing |a - q*b|, so that the remainder is at most |b|/2.
+static inline EXTWideInt EXTWideNearestQuotient(EXTWideInt a, EXTWideInt b) {
+    EXTWideInt q = a / b, r = a - q*b;
+
+    if (2*EXTWideAbs(r) > EXTWideAbs(b))
+        q += ((r < 0) == (b < 0)) ? 1 : -1;
+
+    return q;
+}
+
+// the representative of x mod m in (-m/2, m/2].
+static inline EXTWideInt EXTWideSymmetricMod(EXTWideInt x, EXTWideInt m) {
+    x %= m;
+    if (x < 0)
+        x += m;
+    return (2*x > m) ? x - m : x;
+}
+
+static EXTWideInt EXTWideGCD(EXTWideInt a, EXTWideInt b) {
+    while (b != 0) {
+        EXTWideInt temp = a % b;
+        a = b;
+        b = temp;
+    }
+
+    return EXTWideAbs(a);
+}
+
+#pragma mark - coordinates of B in Z
+
+// solves Z.X == B modulo p by gauss-jordan elimination on the rows of [Z | B],
+// writing X row-major.  returns false if Z drops rank mod p.
+static bool EXTSolveModPrime(const EXTPrimeField *field,
+                             const int *B, int bWidth,
+                             const int *Z, int zWidth,
+                             int height, uint32_t *solution) {
+    uint32_t p = field->characteristic;
+    int width = zWidth + bWidth;
+    EXTScratchMark mark = EXTScratchSave();
+    uint32_t *rows = EXTScratchAlloc(sizeof(uint32_t) * ((size_t)height * width + 1));
+    bool ret = true;
+
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < zWidth; j++)
+            rows[(size_t)i*width + j] =
+                EXTPrimeFieldReduceSigned(field, Z[(size_t)j*height + i]);
+        for (int j = 0; j < bWidth; j++)
+            rows[(size_t)i*width + zWidth + j] =
+                EXTPrimeFieldReduceSigned(field, B[(size_t)j*height + i]);
+    }
+
+    for (int c = 0; c < zWidth; c++) {
+        int found = -1;
+        for (int i = c; i < height; i++)
+            if (rows[(size_t)i*width + c]) {
+                found = i;
+                break;
+            }
+
+        if (found == -1) {
+            ret = false;
+            break;
+        }
+
+        uint32_t *pivot = rows + (size_t)c*width;
+        if (found != c) {
+            uint32_t *other = rows + (size_t)found*width;
+            for (int j = c; j < width; j++) {
+                uint32_t temp = pivot[j]; pivot[j] = other[j]; other[j] = temp;
+            }
+        }
+
+        uint64_t scale = EXTPrimeFieldInverse(field, pivot[c]);
+        for (int j = c; j < width; j++)
+            pivot[j] = EXTPrimeFieldReduce(field, pivot[j] * scale);
+
+        for (int i = 0; i < height; i++) {
+            uint32_t *row = rows + (size_t)i*width;
+            if (i == c || row[c] == 0)
+                continue;
+
+            uint64_t factor = p - row[c];
+            for (int j = c; j < width; j++)
+                row[j] = EXTPrimeFieldReduce(field, row[j] + factor * pivot[j]);
+        }
+    }
+
+    if (ret)
+        for (int c = 0; c < zWidth; c++)
+            memcpy(solution + (size_t)c*bWidth,
+                   rows + (size_t)c*width + zWidth,
+                   sizeof(uint32_t) * bWidth);
+
+    EXTScratchRestore(mark);
+
+    return ret;
+}
+
+// checks Z.X == B exactly.
+static bool EXTVerifySolution(const int *B, int bWidth,
+                              const int *Z, int zWidth,
+                              int height, const EXTWideInt *X) {
+    for (int j = 0; j < bWidth; j++)
+        for (int i = 0; i < height; i++) {
+            EXTWideInt sum = 0;
+
+            for (int c = 0; c < zWidth; c++)
+                if (!EXTWideCombine(&sum, sum, 1,
+                                    Z[(size_t)c*height + i], X[(size_t)c*bWidth + j]))
+                    return false;
+
+            if (sum != B[(size_t)j*height + i])
+                return false;
+        }
+
+    return true;
+}
+
+// finds the integral X with Z.X == B, row-major, by chinese remaindering its
+// residues modulo successive primes.  the symmetric lift is tested after each
+// prime, so small coordinates cost only a prime or two.
+static bool EXTSolveIntegral(const int *B, int bWidth,
+                             const int *Z, int zWidth,
+                             int height, EXTWideInt *X) {
+    size_t count = (size_t)zWidth * bWidth;
+    EXTScratchMark mark = EXTScratchSave();
+    uint32_t *solution = EXTScratchAlloc(sizeof(uint32_t) * (count + 1));
+    EXTWideInt *residues = EXTScratchCalloc(count + 1, sizeof(EXTWideInt)),
+               modulus = 1;
+    bool solved = EXTVerifySolution(B, bWidth, Z, zWidth, height, residues);
+
+    for (int n = 0; n < EXT_SMITH_FORM_PRIME_COUNT && !solved; n++) {
+        const EXTPrimeField *field =
+            EXTPrimeFieldForCharacteristic(EXTSmithFormPrimes[n]);
+        uint32_t p = field->characteristic;
+        EXTWideInt nextModulus;
+
+        if (__builtin_mul_overflow(modulus, (EXTWideInt)p, &nextModulus))
+            break;
+        if (!EXTSolveModPrime(field, B, bWidth, Z, zWidth, height, solution))
+            continue;
+
+        // x = r + modulus * ((s - r) / modulus mod p) agrees with both.
+        uint64_t inverse = EXTPrimeFieldInverse(field,
+                                (uint32_t)(modulus % p));
+        for (size_t i = 0; i < count; i++) {
+            uint64_t r = (uint64_t)(residues[i] % p),
+                     t = EXTPrimeFieldReduce(field,
+                            EXTPrimeFieldReduce(field, solution[i] + p - r) * inverse);
+            residues[i] += modulus * t;
+        }
+        modulus = nextModulus;
+
+        for (size_t i = 0; i < count; i++)
+            X[i] = (residues[i] > modulus / 2) ? residues[i] - modulus : residues[i];
+
+        solved = EXTVerifySolution(B, bWidth, Z, zWidth, height, X);
+    }
+
+    EXTScratchRestore(mark);
+
+    return solved;
+}
+
+#pragma mark - elimination
+
+// the row operations below are all recorded on W (column-major, square) by
+// their inverses, so that W.X stays put: swapping rows i and k swaps columns i
+// and k of W, and subtracting q times row k from row i adds q times column i
+// of W to column k.
+static void EXTSwapRows(EXTWideInt *X, int columns, EXTWideInt *W, int size,
+                        int i, int k) {
+    for (int j = 0; j < columns; j++) {
+        EXTWideInt temp = X[(size_t)i*columns + j];
+        X[(size_t)i*columns + j] = X[(size_t)k*columns + j];
+        X[(size_t)k*columns + j] = temp;
+    }
+
+    for (int j = 0; j < size; j++) {
+        EXTWideInt temp = W[(size_t)i*size + j];
+        W[(size_t)i*size + j] = W[(size_t)k*size + j];
+        W[(size_t)k*size + j] = temp;
+    }
+}
+
+static bool EXTUndoRowSubtraction(EXTWideInt *W, int size, int i, int k,
+                                  EXTWideInt q) {
+    for (int j = 0; j < size; j++)
+        if (!EXTWideCombine(&W[(size_t)k*size + j], W[(size_t)k*size + j], 1,
+                            W[(size_t)i*size + j], q))
+            return false;
+
+    return true;
+}
+
+// row_i -= q row_k, from column c onward.
+static bool EXTSubtractRow(EXTWideInt *X, int columns, EXTWideInt *W, int size,
+                           int i, int k, EXTWideInt q, int c) {
+    for (int j = c; j < columns; j++)
+        if (!EXTWideCombine(&X[(size_t)i*columns + j], X[(size_t)i*columns + j], 1,
+                            X[(size_t)k*columns + j], -q))
+            return false;
+
+    return EXTUndoRowSubtraction(W, size, i, k, q);
+}
+
+// brings X (row-major) to echelon form by unimodular row operations, recording
+// them on W, which should start out as the identity.  the column is cleared
+// below each pivot by repeated division with remainder, and the entries above
+// are then reduced modulo it, which keeps the coefficients (and so W) much
+// smaller than a straight bezout elimination would.  remainders are taken
+// nearest to zero throughout.  writes the echelon
+// pivots to pivots and returns their number, or -1 on overflow.
+static int EXTEchelonize(EXTWideInt *X, int rows, int columns,
+                         EXTWideInt *W, EXTWideInt *pivots) {
+    int k = 0;
+
+    for (int c = 0; c < columns && k < rows; c++) {
+        while (true) {
+            int smallest = -1;
+            for (int i = k; i < rows; i++) {
+                EXTWideInt entry = X[(size_t)i*columns + c];
+                if (entry != 0 &&
+                    (smallest == -1 ||
+                     EXTWideAbs(entry) <
+                        EXTWideAbs(X[(size_t)smallest*columns + c])))
+                    smallest = i;
+            }
+
+            if (smallest == -1)
+                break;
+            if (smallest != k)
+                EXTSwapRows(X, columns, W, rows, smallest, k);
+
+            bool clean = true;
+            for (int i = k + 1; i < rows; i++) {
+                EXTWideInt q = EXTWideNearestQuotient(X[(size_t)i*columns + c],
+                                                      X[(size_t)k*columns + c]);
+                if (q != 0 && !EXTSubtractRow(X, columns, W, rows, i, k, q, c))
+                    return -1;
+                if (X[(size_t)i*columns + c] != 0)
+                    clean = false;
+            }
+
+            if (clean)
+                break;
+        }
+
+        EXTWideInt pivot = X[(size_t)k*columns + c];
+        if (pivot == 0)
+            continue;
+
+        for (int i = 0; i < k; i++) {
+            EXTWideInt q = EXTWideNearestQuotient(X[(size_t)i*columns + c], pivot);
+            if (q != 0 && !EXTSubtractRow(X, columns, W, rows, i, k, q, c))
+                return -1;
+        }
+
+        pivots[k++] = pivot;
+    }
+
+    return k;
+}
+
+
+// diagonalizes the full-rank rows x columns matrix A (row-major) modulo the
+// multiple D of its index, euclid-style: the smallest entry is moved to the
+// corner and everything else in its row and column is divided by it, until
+// the remainders vanish.  row operations are undone on the columns of W as
+// before, and column operations (which don't change the quotient) are
+// forgotten.  returns false on overflow.
+static bool EXTDiagonalizeModulo(EXTWideInt *A, int rows, int columns,
+                                 EXTWideInt D,
+                                 EXTWideInt *W, int wHeight,
+                                 EXTWideInt *diagonal) {
+    for (size_t i = 0; i < (size_t)rows * columns; i++)
+        A[i] = EXTWideSymmetricMod(A[i], D);
+
+    for (int k = 0; k < rows; k++) {
+        while (true) {
+            int pivotRow = -1, pivotColumn = -1;
+            for (int i = k; i < rows; i++)
+                for (int j = k; j < columns; j++) {
+                    EXTWideInt entry = A[(size_t)i*columns + j];
+                    if (entry != 0 &&
+                        (pivotRow == -1 ||
+                         EXTWideAbs(entry) <
+                            EXTWideAbs(A[(size_t)pivotRow*columns + pivotColumn]))) {
+                        pivotRow = i;
+                        pivotColumn = j;
+                    }
+                }
+
+            // D kills everything that's left, so this summand is Z/D.
+            if (pivotRow == -1) {
+                diagonal[k] = 0;
+                break;
+            }
+
+            if (pivotRow != k)
+                EXTSwapRows(A, columns, W, wHeight, pivotRow, k);
+            if (pivotColumn != k)
+                for (int i = 0; i < rows; i++) {
+                    EXTWideInt temp = A[(size_t)i*columns + k];
+                    A[(size_t)i*columns + k] = A[(size_t)i*columns + pivotColumn];
+                    A[(size_t)i*columns + pivotColumn] = temp;
+                }
+
+            EXTWideInt pivot = A[(size_t)k*columns + k];
+            bool clean = true;
+
+            for (int i = k + 1; i < rows; i++) {
+                EXTWideInt q = EXTWideNearestQuotient(A[(size_t)i*columns + k], pivot);
+                if (q == 0)
+                    continue;
+
+                for (int j = k; j < columns; j++)
+                    A[(size_t)i*columns + j] =
+                        EXTWideSymmetricMod(A[(size_t)i*columns + j] -
+                                            q * A[(size_t)k*columns + j], D);
+                if (!EXTUndoRowSubtraction(W, wHeight, i, k, q))
+                    return false;
+
+                if (A[(size_t)i*columns + k] != 0)
+                    clean = false;
+            }
+
+            for (int j = k + 1; j < columns; j++) {
+                EXTWideInt q = EXTWideNearestQuotient(A[(size_t)k*columns + j], pivot);
+                if (q == 0)
+                    continue;
+
+                for (int i = k; i < rows; i++)
+                    A[(size_t)i*columns + j] =
+                        EXTWideSymmetricMod(A[(size_t)i*columns + j] -
+                                            q * A[(size_t)i*columns + k], D);
+
+                if (A[(size_t)k*columns + j] != 0)
+                    clean = false;
+            }
+
+            if (clean) {
+                diagonal[k] = pivot;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+#pragma mark - the quotient
+
+bool EXTSmithFormOfQuotient(const int *B, int bWidth,
+                            const int *Z, int zWidth,
+                            int height, EXTSmithForm *result) {
+    EXTScratchMark mark = EXTScratchSave();
+    EXTWideInt *X = EXTScratchCalloc((size_t)zWidth * bWidth + 1, sizeof(EXTWideInt)),
+               *W = EXTScratchCalloc((size_t)zWidth * zWidth + 1, sizeof(EXTWideInt)),
+               *pivots = EXTScratchCalloc(zWidth + 1, sizeof(EXTWideInt)),
+               *orders = EXTScratchCalloc(zWidth + 1, sizeof(EXTWideInt)),
+               D = 1;
+    bool ret = false;
+    int rank = 0;
+
+    *result = (EXTSmithForm){0, height, NULL, NULL};
+
+    for (int i = 0; i < zWidth; i++)
+        W[(size_t)i*zWidth + i] = 1;
+
+    if (!EXTSolveIntegral(B, bWidth, Z, zWidth, height, X))
+        goto cleanup;
+
+    // after echelonizing, the last zWidth - rank columns of W span a
+    // complement to the saturation of B, and so generate the free part.
+    rank = EXTEchelonize(X, zWidth, bWidth, W, pivots);
+    if (rank < 0)
+        goto cleanup;
+
+    // the top rank rows of X now present the torsion, and the triangular
+    // minor on their pivot columns has determinant D, a multiple of its order.
+    for (int k = 0; k < rank; k++)
+        if (__builtin_mul_overflow(D, pivots[k] < 0 ? -pivots[k] : pivots[k], &D) ||
+            D > INT64_MAX)
+            goto cleanup;
+
+    if (D > 1) {
+        EXTWideInt *diagonal = EXTScratchCalloc(rank + 1, sizeof(EXTWideInt));
+        bool diagonalized = EXTDiagonalizeModulo(X, rank, bWidth, D,
+                                                 W, zWidth, diagonal);
+
+        for (int k = 0; k < rank; k++) {
+            orders[k] = EXTWideGCD(diagonal[k], D);
+        }
+
+        if (!diagonalized)
+            goto cleanup;
+    } else {
+        for (int k = 0; k < rank; k++)
+            orders[k] = 1;
+    }
+
+    for (int k = rank; k < zWidth; k++)
+        orders[k] = 0;
+
+    // write out the nontrivial summands, pushing generators forward along Z.
+    result->generators = calloc((size_t)zWidth * height + 1, sizeof(int64_t));
+    result->orders = calloc(zWidth + 1, sizeof(int64_t));
+    EXTCountHeapAllocation(sizeof(int64_t) * zWidth * height);
+    EXTCountHeapAllocation(sizeof(int64_t) * zWidth);
+
+    for (int k = 0; k < zWidth; k++) {
+        if (orders[k] == 1)
+            continue;
+
+        int64_t *generator = result->generators + (size_t)result->count*height;
+        for (int i = 0; i < height; i++) {
+            EXTWideInt sum = 0;
+
+            for (int c = 0; c < zWidth; c++)
+                if (!EXTWideCombine(&sum, sum, 1,
+                                    Z[(size_t)c*height + i], W[(size_t)k*zWidth + c]))
+                    goto cleanup;
+
+            if (sum > INT64_MAX || sum < INT64_MIN)
+                goto cleanup;
+            generator[i] = (int64_t)sum;
+        }
+
+        result->orders[result->count++] = (int64_t)orders[k];
+    }
+
+    ret = true;
+
+cleanup:
+    if (!ret)
+        EXTSmithFormFree(result);
+
+    EXTScratchRestore(mark);
+
+    return ret;
+}
+
+void EXTSmithFormFree(EXTSmithForm *form) {
+    free(form->generators);
+    free(form->orders);
+    form->generators = NULL;
+    form->orders = NULL;
+    form->count = 0;
+}
@@ -0,0 +1,109 @@
+//
+//  EXTSparseMatrix.h
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "EXTPrimeField.h"
+
+// a matrix in compressed sparse column form: the nonzero entries of column i
+// sit at positions [columnStarts[i], columnStarts[i+1]) of rows and values, in
+// order of increasing row.  zeros are never stored.
+//
+// most of the matrices pushed through the multiplication tables are kronecker
+// products with identities, inclusions of evenly spaced bases, and structure
+// matrices of polynomial algebras, all of which are almost entirely zero.
+// EXTMatrix keeps itself in this form when few enough of its entries are
+// nonzero, and hands products and (over a prime field) reductions to the
+// routines here whenever an operand is that sparse.
+typedef struct {
+    int width, height;
+    size_t *columnStarts;   // width + 1 offsets into rows and values
+    int *rows;
+    int *values;
+} EXTSparseMatrix;
+
+// a matrix is stored sparse when at most one in this many of its entries is
+// nonzero...
+#define EXT_SPARSE_MATRIX_RATIO 8
+// ...but in characteristic 2, where the dense routines pack 64 entries into a
+// word, the sparse routines only take over at this ratio.
+#define EXT_SPARSE_MATRIX_BIT_RATIO 64
+
+static inline size_t EXTSparseMatrixNonzeros(const EXTSparseMatrix *matrix) {
+    return matrix->columnStarts[matrix->width];
+}
+
+/// the heap footprint of the arrays behind matrix.
+static inline size_t EXTSparseMatrixBytes(const EXTSparseMatrix *matrix) {
+    return sizeof(size_t) * (matrix->width + 1) +
+           2 * sizeof(int) * EXTSparseMatrixNonzeros(matrix);
+}
+
+EXTSparseMatrix EXTSparseMatrixCreateIdentity(int width);
+EXTSparseMatrix EXTSparseMatrixCopy(const EXTSparseMatrix *matrix);
+void EXTSparseMatrixFree(EXTSparseMatrix *matrix);
+
+/// the nonzero entries of an int-valued, column-major matrix.
+EXTSparseMatrix EXTSparseMatrixFromInts(const int *data, int width, int height);
+/// writes out every entry of matrix into data, column-major.
+void EXTSparseMatrixGetInts(const EXTSparseMatrix *matrix, int *data);
+size_t EXTSparseMatrixCountNonzeros(const int *data, int width, int height);
+
+/// reduces every entry into [0, characteristic), dropping those that vanish.
+void EXTSparseMatrixReduce(EXTSparseMatrix *matrix, int characteristic);
+
+/// with a nonzero characteristic, the entries of the product lie in
+/// [0, characteristic).
+EXTSparseMatrix EXTSparseMatrixMultiply(const EXTSparseMatrix *left,
+                                        const EXTSparseMatrix *right,
+                                        int characteristic);
+/// the kronecker product, laid out the same way as +[EXTMatrix hadamardProduct:with:]
+EXTSparseMatrix EXTSparseMatrixKronecker(const EXTSparseMatrix *left,
+                                         const EXTSparseMatrix *right,
+                                         int characteristic);
+
+/// the matrix whose (columns[e], rows[e]) entry is values[e], for the count
+/// entries given in any order.  entries that land on the same spot are summed,
+/// and with a nonzero characteristic the sums are reduced into
+/// [0, characteristic).
+EXTSparseMatrix EXTSparseMatrixFromTriples(int width, int height, size_t count,
+                                           const int *columns, const int *rows,
+                                           const int *values,
+                                           int characteristic);
+
+EXTSparseMatrix EXTSparseMatrixTranspose(const EXTSparseMatrix *matrix);
+/// the matrix [left, right], where the two have the same height.
+EXTSparseMatrix EXTSparseMatrixConcatenate(const EXTSparseMatrix *left,
+                                           const EXTSparseMatrix *right);
+/// the matrix [matrix; identity], for tracking column operations.
+EXTSparseMatrix EXTSparseMatrixStackedOnIdentity(const EXTSparseMatrix *matrix);
+/// the rows [firstRow, firstRow + rowCount) of every column.
+EXTSparseMatrix EXTSparseMatrixRowBlock(const EXTSparseMatrix *matrix,
+                                        int firstRow, int rowCount);
+
+/// the sparse counterpart to EXTPrimeFieldColumnReduce, with the same contract:
+/// gauss-jordan column reduction over F_p of the rows [0, limit), in place,
+/// after which every entry lies in [0, p), each pivot is 1, and each pivot row
+/// is zero away from its pivot.  of the columns that could serve as a pivot,
+/// the one with the fewest entries is picked, which keeps fill-in down.
+int EXTSparseMatrixColumnReduce(const EXTPrimeField *field,
+                                EXTSparseMatrix *matrix, int limit,
+                                int *pivotColumns);
+/// a basis for the kernel of the matrix over F_p.
+EXTSparseMatrix EXTSparseMatrixKernel(const EXTPrimeField *field,
+                                      const EXTSparseMatrix *matrix);
+/// a basis for the image of the matrix over F_p, ordered by pivot row.
+EXTSparseMatrix EXTSparseMatrixImage(const EXTPrimeField *field,
+                                     const EXTSparseMatrix *matrix);
+/// the pullback of left --> target <-- right over F_p, in one elimination of
+/// [left, -right; identity]: left * leftInclusion = right * rightInclusion,
+/// and the columns of the two together span every such pair.
+void EXTSparseMatrixPullback(const EXTPrimeField *field,
+                             const EXTSparseMatrix *left,
+                             const EXTSparseMatrix *right,
+                             EXTSparseMatrix *leftInclusion,
+                             EXTSparseMatrix *rightInclusion);
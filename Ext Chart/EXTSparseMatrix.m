@@ -0,0 +1,770 @@
+//
+//  EXTSparseMatrix.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import "EXTSparseMatrix.h"
+#import "EXTScratch.h"
+
+#pragma mark - construction
+
+// a matrix under construction, filled in one column at a time.  its buffers
+// become the finished matrix, so they come from the heap rather than the
+// scratch arena, and are counted as they're taken.
+typedef struct {
+    EXTSparseMatrix matrix;
+    size_t count, capacity;
+} EXTSparseBuilder;
+
+static EXTSparseBuilder EXTSparseBuilderCreate(int width, int height,
+                                               size_t capacity) {
+    EXTSparseBuilder ret;
+
+    ret.matrix.width = width;
+    ret.matrix.height = height;
+    ret.matrix.columnStarts = calloc((size_t)width + 1, sizeof(size_t));
+    ret.count = 0;
+    ret.capacity = MAX(capacity, (size_t)16);
+    ret.matrix.rows = malloc(sizeof(int) * ret.capacity);
+    ret.matrix.values = malloc(sizeof(int) * ret.capacity);
+    EXTCountHeapAllocation(sizeof(size_t) * ((size_t)width + 1));
+    EXTCountHeapAllocation(2 * sizeof(int) * ret.capacity);
+
+    return ret;
+}
+
+static inline void EXTSparseBuilderPush(EXTSparseBuilder *builder,
+                                        int row, int value) {
+    if (builder->count == builder->capacity) {
+        builder->capacity *= 2;
+        builder->matrix.rows = realloc(builder->matrix.rows,
+                                       sizeof(int) * builder->capacity);
+        builder->matrix.values = realloc(builder->matrix.values,
+                                         sizeof(int) * builder->capacity);
+        EXTCountHeapAllocation(2 * sizeof(int) * builder->capacity);
+    }
+
+    builder->matrix.rows[builder->count] = row;
+    builder->matrix.values[builder->count++] = value;
+}
+
+// seals off the given column; the next push starts column + 1.
+static inline void EXTSparseBuilderEndColumn(EXTSparseBuilder *builder,
+                                             int column) {
+    builder->matrix.columnStarts[column + 1] = builder->count;
+}
+
+EXTSparseMatrix EXTSparseMatrixCreateIdentity(int width) {
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(width, width, width);
+
+    for (int i = 0; i < width; i++) {
+        EXTSparseBuilderPush(&builder, i, 1);
+        EXTSparseBuilderEndColumn(&builder, i);
+    }
+
+    return builder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixCopy(const EXTSparseMatrix *matrix) {
+    size_t nonzeros = EXTSparseMatrixNonzeros(matrix);
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(matrix->width,
+                                                      matrix->height, nonzeros);
+
+    memcpy(builder.matrix.columnStarts, matrix->columnStarts,
+           sizeof(size_t) * (matrix->width + 1));
+    memcpy(builder.matrix.rows, matrix->rows, sizeof(int) * nonzeros);
+    memcpy(builder.matrix.values, matrix->values, sizeof(int) * nonzeros);
+
+    return builder.matrix;
+}
+
+void EXTSparseMatrixFree(EXTSparseMatrix *matrix) {
+    free(matrix->columnStarts);
+    free(matrix->rows);
+    free(matrix->values);
+    matrix->columnStarts = NULL;
+    matrix->rows = matrix->values = NULL;
+    matrix->width = matrix->height = 0;
+}
+
+size_t EXTSparseMatrixCountNonzeros(const int *data, int width, int height) {
+    size_t ret = 0;
+
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        ret += (data[i] != 0);
+
+    return ret;
+}
+
+EXTSparseMatrix EXTSparseMatrixFromInts(const int *data, int width, int height) {
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(width, height,
+                               EXTSparseMatrixCountNonzeros(data, width, height));
+
+    for (int i = 0; i < width; i++) {
+        const int *column = data + (size_t)i * height;
+
+        for (int j = 0; j < height; j++)
+            if (column[j] != 0)
+                EXTSparseBuilderPush(&builder, j, column[j]);
+
+        EXTSparseBuilderEndColumn(&builder, i);
+    }
+
+    return builder.matrix;
+}
+
+void EXTSparseMatrixGetInts(const EXTSparseMatrix *matrix, int *data) {
+    memset(data, 0, sizeof(int) * (size_t)matrix->width * matrix->height);
+
+    for (int i = 0; i < matrix->width; i++) {
+        int *column = data + (size_t)i * matrix->height;
+
+        for (size_t e = matrix->columnStarts[i]; e < matrix->columnStarts[i+1]; e++)
+            column[matrix->rows[e]] = matrix->values[e];
+    }
+}
+
+static inline int EXTSparseReduce(int64_t x, int characteristic) {
+    int64_t remainder = x % characteristic;
+    return (int)(remainder < 0 ? remainder + characteristic : remainder);
+}
+
+void EXTSparseMatrixReduce(EXTSparseMatrix *matrix, int characteristic) {
+    if (characteristic == 0)
+        return;
+
+    // compacts the surviving entries toward the front as it goes.
+    size_t count = 0;
+    for (int i = 0; i < matrix->width; i++) {
+        size_t start = matrix->columnStarts[i], end = matrix->columnStarts[i+1];
+        matrix->columnStarts[i] = count;
+
+        for (size_t e = start; e < end; e++) {
+            int value = EXTSparseReduce(matrix->values[e], characteristic);
+            if (value == 0)
+                continue;
+
+            matrix->rows[count] = matrix->rows[e];
+            matrix->values[count++] = value;
+        }
+    }
+    matrix->columnStarts[matrix->width] = count;
+}
+
+#pragma mark - products
+
+static int EXTSparseCompareRows(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// puts the count rows in touched, which are exactly the rows whose marks equal
+// stamp, into increasing order.  if they're a good fraction of all the rows,
+// it's quicker to sweep the marks than to sort.
+static void EXTSparseSortTouched(int *touched, int count, const int *marks,
+                                 int stamp, int height) {
+    if ((size_t)count * 16 < (size_t)height) {
+        qsort(touched, count, sizeof(int), EXTSparseCompareRows);
+        return;
+    }
+
+    for (int j = 0, t = 0; j < height; j++)
+        if (marks[j] == stamp)
+            touched[t++] = j;
+}
+
+// gustavson's algorithm: column k of the product gathers the columns of left
+// named by the entries of column k of right into a scattered accumulator.
+EXTSparseMatrix EXTSparseMatrixMultiply(const EXTSparseMatrix *left,
+                                        const EXTSparseMatrix *right,
+                                        int characteristic) {
+    int height = left->height;
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(right->width, height,
+                               EXTSparseMatrixNonzeros(left) +
+                               EXTSparseMatrixNonzeros(right));
+
+    EXTScratchMark mark = EXTScratchSave();
+    int64_t *accumulator = EXTScratchAlloc(sizeof(int64_t) * (height + 1));
+    int *marks = EXTScratchAlloc(sizeof(int) * (height + 1)),
+        *touched = EXTScratchAlloc(sizeof(int) * (height + 1));
+    for (int j = 0; j < height; j++)
+        marks[j] = -1;
+
+    for (int k = 0; k < right->width; k++) {
+        int touchedCount = 0;
+
+        for (size_t e = right->columnStarts[k]; e < right->columnStarts[k+1]; e++) {
+            int inner = right->rows[e];
+            int64_t weight = right->values[e];
+
+            if (inner >= left->width)
+                continue;
+
+            for (size_t f = left->columnStarts[inner];
+                 f < left->columnStarts[inner+1]; f++) {
+                int row = left->rows[f];
+                int64_t term = weight * left->values[f];
+
+                if (marks[row] != k) {
+                    marks[row] = k;
+                    accumulator[row] = 0;
+                    touched[touchedCount++] = row;
+                }
+
+                // with a characteristic, the accumulator stays in (-p, p).
+                if (characteristic)
+                    accumulator[row] = (accumulator[row] + term % characteristic) %
+                                       characteristic;
+                else
+                    accumulator[row] += term;
+            }
+        }
+
+        EXTSparseSortTouched(touched, touchedCount, marks, k, height);
+
+        for (int t = 0; t < touchedCount; t++) {
+            int row = touched[t],
+                value = characteristic ?
+                            EXTSparseReduce(accumulator[row], characteristic) :
+                            (int)accumulator[row];
+            if (value != 0)
+                EXTSparseBuilderPush(&builder, row, value);
+        }
+
+        EXTSparseBuilderEndColumn(&builder, k);
+    }
+
+    EXTScratchRestore(mark);
+
+    return builder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixKronecker(const EXTSparseMatrix *left,
+                                         const EXTSparseMatrix *right,
+                                         int characteristic) {
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(left->width * right->width,
+                               left->height * right->height,
+                               EXTSparseMatrixNonzeros(left) *
+                               EXTSparseMatrixNonzeros(right));
+
+    // both factors are sorted by row, so the rows k * right->height + l come
+    // out sorted too.
+    for (int i = 0; i < left->width; i++)
+        for (int j = 0; j < right->width; j++) {
+            for (size_t e = left->columnStarts[i]; e < left->columnStarts[i+1]; e++)
+                for (size_t f = right->columnStarts[j];
+                     f < right->columnStarts[j+1]; f++) {
+                    int64_t product = (int64_t)left->values[e] * right->values[f];
+                    int value = characteristic ?
+                                    EXTSparseReduce(product, characteristic) :
+                                    (int)product;
+
+                    if (value != 0)
+                        EXTSparseBuilderPush(&builder,
+                                             left->rows[e] * right->height +
+                                             right->rows[f],
+                                             value);
+                }
+
+            EXTSparseBuilderEndColumn(&builder, i * right->width + j);
+        }
+
+    return builder.matrix;
+}
+
+// a counting sort of the entries into their columns, then the same scattered
+// accumulator as the product above to sum the repeats within each column.
+EXTSparseMatrix EXTSparseMatrixFromTriples(int width, int height, size_t count,
+                                           const int *columns, const int *rows,
+                                           const int *values,
+                                           int characteristic) {
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(width, height, count);
+
+    EXTScratchMark mark = EXTScratchSave();
+    size_t *starts = EXTScratchCalloc((size_t)width + 1, sizeof(size_t));
+    for (size_t e = 0; e < count; e++)
+        starts[columns[e] + 1]++;
+    for (int i = 0; i < width; i++)
+        starts[i+1] += starts[i];
+
+    size_t *order = EXTScratchAlloc(sizeof(size_t) * (count + 1)),
+           *next = EXTScratchAlloc(sizeof(size_t) * ((size_t)width + 1));
+    memcpy(next, starts, sizeof(size_t) * ((size_t)width + 1));
+    for (size_t e = 0; e < count; e++)
+        order[next[columns[e]]++] = e;
+
+    int64_t *accumulator = EXTScratchAlloc(sizeof(int64_t) * (height + 1));
+    int *marks = EXTScratchAlloc(sizeof(int) * (height + 1)),
+        *touched = EXTScratchAlloc(sizeof(int) * (height + 1));
+    for (int j = 0; j < height; j++)
+        marks[j] = -1;
+
+    for (int k = 0; k < width; k++) {
+        int touchedCount = 0;
+
+        for (size_t o = starts[k]; o < starts[k+1]; o++) {
+            size_t e = order[o];
+            int row = rows[e];
+
+            if (marks[row] != k) {
+                marks[row] = k;
+                accumulator[row] = 0;
+                touched[touchedCount++] = row;
+            }
+
+            if (characteristic)
+                accumulator[row] = (accumulator[row] + values[e] % characteristic) %
+                                   characteristic;
+            else
+                accumulator[row] += values[e];
+        }
+
+        EXTSparseSortTouched(touched, touchedCount, marks, k, height);
+
+        for (int t = 0; t < touchedCount; t++) {
+            int row = touched[t],
+                value = characteristic ?
+                            EXTSparseReduce(accumulator[row], characteristic) :
+                            (int)accumulator[row];
+            if (value != 0)
+                EXTSparseBuilderPush(&builder, row, value);
+        }
+
+        EXTSparseBuilderEndColumn(&builder, k);
+    }
+
+    EXTScratchRestore(mark);
+
+    return builder.matrix;
+}
+
+// a counting sort on the rows: each row of matrix becomes a column, filled in
+// in order of increasing column, so the result comes out sorted.
+EXTSparseMatrix EXTSparseMatrixTranspose(const EXTSparseMatrix *matrix) {
+    size_t nonzeros = EXTSparseMatrixNonzeros(matrix);
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(matrix->height,
+                                                      matrix->width, nonzeros);
+    EXTScratchMark mark = EXTScratchSave();
+    size_t *starts = builder.matrix.columnStarts,
+           *next = EXTScratchAlloc(sizeof(size_t) * (matrix->height + 1));
+
+    for (size_t e = 0; e < nonzeros; e++)
+        starts[matrix->rows[e] + 1]++;
+    for (int j = 0; j < matrix->height; j++)
+        starts[j+1] += starts[j];
+    memcpy(next, starts, sizeof(size_t) * matrix->height);
+
+    for (int i = 0; i < matrix->width; i++)
+        for (size_t e = matrix->columnStarts[i]; e < matrix->columnStarts[i+1]; e++) {
+            size_t target = next[matrix->rows[e]]++;
+            builder.matrix.rows[target] = i;
+            builder.matrix.values[target] = matrix->values[e];
+        }
+
+    EXTScratchRestore(mark);
+
+    return builder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixConcatenate(const EXTSparseMatrix *left,
+                                           const EXTSparseMatrix *right) {
+    size_t leftNonzeros = EXTSparseMatrixNonzeros(left),
+           rightNonzeros = EXTSparseMatrixNonzeros(right);
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(left->width + right->width, left->height,
+                               leftNonzeros + rightNonzeros);
+
+    memcpy(builder.matrix.columnStarts, left->columnStarts,
+           sizeof(size_t) * (left->width + 1));
+    for (int i = 1; i <= right->width; i++)
+        builder.matrix.columnStarts[left->width + i] =
+                                        leftNonzeros + right->columnStarts[i];
+
+    memcpy(builder.matrix.rows, left->rows, sizeof(int) * leftNonzeros);
+    memcpy(builder.matrix.rows + leftNonzeros, right->rows,
+           sizeof(int) * rightNonzeros);
+    memcpy(builder.matrix.values, left->values, sizeof(int) * leftNonzeros);
+    memcpy(builder.matrix.values + leftNonzeros, right->values,
+           sizeof(int) * rightNonzeros);
+
+    return builder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixStackedOnIdentity(const EXTSparseMatrix *matrix) {
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(matrix->width, matrix->height + matrix->width,
+                               EXTSparseMatrixNonzeros(matrix) + matrix->width);
+
+    for (int i = 0; i < matrix->width; i++) {
+        for (size_t e = matrix->columnStarts[i]; e < matrix->columnStarts[i+1]; e++)
+            EXTSparseBuilderPush(&builder, matrix->rows[e], matrix->values[e]);
+
+        EXTSparseBuilderPush(&builder, matrix->height + i, 1);
+        EXTSparseBuilderEndColumn(&builder, i);
+    }
+
+    return builder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixRowBlock(const EXTSparseMatrix *matrix,
+                                        int firstRow, int rowCount) {
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(matrix->width, rowCount,
+                                                      matrix->width);
+
+    for (int i = 0; i < matrix->width; i++) {
+        for (size_t e = matrix->columnStarts[i]; e < matrix->columnStarts[i+1]; e++)
+            if (matrix->rows[e] >= firstRow && matrix->rows[e] < firstRow + rowCount)
+                EXTSparseBuilderPush(&builder, matrix->rows[e] - firstRow,
+                                     matrix->values[e]);
+
+        EXTSparseBuilderEndColumn(&builder, i);
+    }
+
+    return builder.matrix;
+}
+
+#pragma mark - reduction over F_p
+
+// during reduction each column lives in its own buffer, so that it can grow
+// and shrink independently of the others.  the buffers trade places as they
+// go, which the scratch arena's stack discipline can't follow, so they come
+// from the heap and are counted there.
+typedef struct {
+    int count, capacity;
+    int *rows;
+    uint32_t *values;
+} EXTSparseColumn;
+
+static void EXTSparseColumnReserve(EXTSparseColumn *column, int capacity) {
+    if (column->capacity >= capacity)
+        return;
+
+    column->capacity = MAX(capacity, 2 * column->capacity);
+    column->rows = realloc(column->rows, sizeof(int) * column->capacity);
+    column->values = realloc(column->values, sizeof(uint32_t) * column->capacity);
+    EXTCountHeapAllocation((sizeof(int) + sizeof(uint32_t)) * column->capacity);
+}
+
+// column += factor * pivot, merging by row into scratch and then trading
+// buffers with it.  entries which cancel are dropped.
+static void EXTSparseColumnAxpy(const EXTPrimeField *field,
+                                EXTSparseColumn *column, uint32_t factor,
+                                const EXTSparseColumn *pivot,
+                                EXTSparseColumn *scratch) {
+    EXTSparseColumnReserve(scratch, column->count + pivot->count);
+
+    int a = 0, b = 0, count = 0;
+    while (a < column->count || b < pivot->count) {
+        int row;
+        uint64_t value;
+
+        if (b == pivot->count ||
+            (a < column->count && column->rows[a] < pivot->rows[b])) {
+            row = column->rows[a];
+            value = column->values[a++];
+        } else if (a == column->count || pivot->rows[b] < column->rows[a]) {
+            row = pivot->rows[b];
+            value = (uint64_t)factor * pivot->values[b++];
+        } else {
+            row = column->rows[a];
+            value = column->values[a++] + (uint64_t)factor * pivot->values[b++];
+        }
+
+        uint32_t reduced = EXTPrimeFieldReduce(field, value);
+        if (reduced == 0)
+            continue;
+
+        scratch->rows[count] = row;
+        scratch->values[count++] = reduced;
+    }
+
+    EXTSparseColumn temp = *column;
+    *column = *scratch;
+    column->count = count;
+    *scratch = temp;
+}
+
+// rows are eliminated in order, and a column that hasn't been used as a pivot
+// is always zero on the rows already eliminated.  so the columns that can
+// serve as the pivot of a row are exactly the unused ones whose first entry
+// sits in that row, and we keep them in a bucket per row.  the forward pass
+// only clears each pivot row from the unused columns; the pivot columns are
+// cleared against each other afterward, from the bottom up.
+int EXTSparseMatrixColumnReduce(const EXTPrimeField *field,
+                                EXTSparseMatrix *matrix, int limit,
+                                int *pivotColumns) {
+    int width = matrix->width, height = matrix->height, rank = 0;
+    uint32_t p = field->characteristic;
+
+    limit = MIN(limit, height);
+
+    EXTScratchMark mark = EXTScratchSave();
+    EXTSparseColumn *columns = EXTScratchCalloc(width + 1, sizeof(EXTSparseColumn)),
+                    scratch = {0, 0, NULL, NULL};
+    for (int i = 0; i < width; i++) {
+        EXTSparseColumn *column = &columns[i];
+        size_t start = matrix->columnStarts[i], end = matrix->columnStarts[i+1];
+
+        EXTSparseColumnReserve(column, (int)(end - start) + 1);
+        for (size_t e = start; e < end; e++) {
+            uint32_t value = EXTPrimeFieldReduceSigned(field, matrix->values[e]);
+            if (value == 0)
+                continue;
+
+            column->rows[column->count] = matrix->rows[e];
+            column->values[column->count++] = value;
+        }
+    }
+
+    int *buckets = EXTScratchAlloc(sizeof(int) * (limit + 1)),
+        *nextInBucket = EXTScratchAlloc(sizeof(int) * (width + 1)),
+        *pivots = EXTScratchAlloc(sizeof(int) * (limit + 1));
+    for (int j = 0; j < limit; j++)
+        buckets[j] = pivots[j] = -1;
+    for (int i = width - 1; i >= 0; i--)
+        if (columns[i].count && columns[i].rows[0] < limit) {
+            nextInBucket[i] = buckets[columns[i].rows[0]];
+            buckets[columns[i].rows[0]] = i;
+        }
+
+    for (int pivotRow = 0; pivotRow < limit; pivotRow++) {
+        int pivotColumn = -1;
+
+        for (int i = buckets[pivotRow]; i != -1; i = nextInBucket[i])
+            if (pivotColumn == -1 || columns[i].count < columns[pivotColumn].count)
+                pivotColumn = i;
+
+        if (pivotColumn == -1)
+            continue;
+
+        pivots[pivotRow] = pivotColumn;
+        rank++;
+
+        EXTSparseColumn *pivot = &columns[pivotColumn];
+        uint64_t scale = EXTPrimeFieldInverse(field, pivot->values[0]);
+        for (int e = 0; e < pivot->count; e++)
+            pivot->values[e] = EXTPrimeFieldReduce(field, pivot->values[e] * scale);
+
+        for (int i = buckets[pivotRow], next; i != -1; i = next) {
+            next = nextInBucket[i];
+            if (i == pivotColumn)
+                continue;
+
+            EXTSparseColumn *column = &columns[i];
+            EXTSparseColumnAxpy(field, column, p - column->values[0], pivot,
+                                &scratch);
+
+            if (column->count && column->rows[0] < limit) {
+                nextInBucket[i] = buckets[column->rows[0]];
+                buckets[column->rows[0]] = i;
+            }
+        }
+    }
+
+    // each pivot column only has entries on or below its own pivot row.  going
+    // from the bottom up, the pivot columns below the current one are already
+    // alone in their pivot rows, so the current one can be cleared against all
+    // of them at once, using its own untouched entries as the coefficients.
+    uint64_t *accumulator = EXTScratchAlloc(sizeof(uint64_t) * (height + 1));
+    int *marks = EXTScratchAlloc(sizeof(int) * (height + 1)),
+        *touched = EXTScratchAlloc(sizeof(int) * (height + 1));
+    for (int j = 0; j < height; j++)
+        marks[j] = -1;
+
+    for (int pivotRow = limit - 1; pivotRow >= 0; pivotRow--) {
+        if (pivots[pivotRow] == -1)
+            continue;
+
+        EXTSparseColumn *column = &columns[pivots[pivotRow]];
+        bool isAlone = true;
+        for (int e = 1; e < column->count && isAlone; e++)
+            isAlone = (column->rows[e] >= limit || pivots[column->rows[e]] == -1);
+        if (isAlone)
+            continue;
+
+        int touchedCount = 0;
+        for (int e = 0; e < column->count; e++) {
+            marks[column->rows[e]] = pivotRow;
+            accumulator[column->rows[e]] = column->values[e];
+            touched[touchedCount++] = column->rows[e];
+        }
+
+        for (int e = 1; e < column->count; e++) {
+            int row = column->rows[e];
+            if (row >= limit || pivots[row] == -1)
+                continue;
+
+            const EXTSparseColumn *other = &columns[pivots[row]];
+            uint64_t factor = p - column->values[e];
+            for (int f = 0; f < other->count; f++) {
+                int target = other->rows[f];
+
+                if (marks[target] != pivotRow) {
+                    marks[target] = pivotRow;
+                    accumulator[target] = 0;
+                    touched[touchedCount++] = target;
+                }
+
+                accumulator[target] = EXTPrimeFieldReduce(field,
+                        accumulator[target] + factor * other->values[f]);
+            }
+        }
+
+        EXTSparseSortTouched(touched, touchedCount, marks, pivotRow, height);
+        EXTSparseColumnReserve(column, touchedCount);
+        column->count = 0;
+        for (int t = 0; t < touchedCount; t++) {
+            if (accumulator[touched[t]] == 0)
+                continue;
+
+            column->rows[column->count] = touched[t];
+            column->values[column->count++] = (uint32_t)accumulator[touched[t]];
+        }
+    }
+
+    // write the columns back.
+    size_t nonzeros = 0;
+    for (int i = 0; i < width; i++)
+        nonzeros += columns[i].count;
+
+    EXTSparseBuilder builder = EXTSparseBuilderCreate(width, height, nonzeros);
+    for (int i = 0; i < width; i++) {
+        for (int e = 0; e < columns[i].count; e++)
+            EXTSparseBuilderPush(&builder, columns[i].rows[e],
+                                 (int)columns[i].values[e]);
+        EXTSparseBuilderEndColumn(&builder, i);
+
+        free(columns[i].rows);
+        free(columns[i].values);
+    }
+
+    EXTSparseMatrixFree(matrix);
+    *matrix = builder.matrix;
+
+    if (pivotColumns)
+        memcpy(pivotColumns, pivots, sizeof(int) * limit);
+
+    free(scratch.rows);
+    free(scratch.values);
+    EXTScratchRestore(mark);
+
+    return rank;
+}
+
+EXTSparseMatrix EXTSparseMatrixKernel(const EXTPrimeField *field,
+                                      const EXTSparseMatrix *matrix) {
+    EXTSparseMatrix augmented = EXTSparseMatrixStackedOnIdentity(matrix);
+    int rank = EXTSparseMatrixColumnReduce(field, &augmented, matrix->height,
+                                           NULL);
+
+    // the columns whose top part vanished carry the kernel underneath.
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(matrix->width - rank, matrix->width,
+                               EXTSparseMatrixNonzeros(&augmented));
+    for (int i = 0, column = 0; i < augmented.width; i++) {
+        size_t start = augmented.columnStarts[i], end = augmented.columnStarts[i+1];
+        if (start != end && augmented.rows[start] < matrix->height)
+            continue;
+
+        for (size_t e = start; e < end; e++)
+            EXTSparseBuilderPush(&builder, augmented.rows[e] - matrix->height,
+                                 augmented.values[e]);
+        EXTSparseBuilderEndColumn(&builder, column++);
+    }
+
+    EXTSparseMatrixFree(&augmented);
+
+    return builder.matrix;
+}
+
+void EXTSparseMatrixPullback(const EXTPrimeField *field,
+                             const EXTSparseMatrix *left,
+                             const EXTSparseMatrix *right,
+                             EXTSparseMatrix *leftInclusion,
+                             EXTSparseMatrix *rightInclusion) {
+    int height = left->height, leftWidth = left->width,
+        width = left->width + right->width;
+
+    // [left, -right; identity], written out in one go.
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(width, height + width,
+                               EXTSparseMatrixNonzeros(left) +
+                               EXTSparseMatrixNonzeros(right) + width);
+    for (int i = 0; i < width; i++) {
+        const EXTSparseMatrix *block = (i < leftWidth) ? left : right;
+        int column = (i < leftWidth) ? i : i - leftWidth,
+            sign = (i < leftWidth) ? 1 : -1;
+
+        for (size_t e = block->columnStarts[column];
+             e < block->columnStarts[column+1]; e++)
+            EXTSparseBuilderPush(&builder, block->rows[e],
+                                 sign * block->values[e]);
+        EXTSparseBuilderPush(&builder, height + i, 1);
+        EXTSparseBuilderEndColumn(&builder, i);
+    }
+
+    EXTSparseMatrix augmented = builder.matrix;
+    int rank = EXTSparseMatrixColumnReduce(field, &augmented, height, NULL);
+
+    // the columns whose top part vanished carry pairs (x; y) with
+    // left x = right y, which split straight into the two inclusions.
+    size_t nonzeros = EXTSparseMatrixNonzeros(&augmented);
+    EXTSparseBuilder leftBuilder =
+                        EXTSparseBuilderCreate(width - rank, leftWidth, nonzeros),
+                     rightBuilder =
+                        EXTSparseBuilderCreate(width - rank, right->width,
+                                               nonzeros);
+    for (int i = 0, column = 0; i < width; i++) {
+        size_t start = augmented.columnStarts[i], end = augmented.columnStarts[i+1];
+        if (start != end && augmented.rows[start] < height)
+            continue;
+
+        for (size_t e = start; e < end; e++) {
+            int row = augmented.rows[e] - height;
+            if (row < leftWidth)
+                EXTSparseBuilderPush(&leftBuilder, row, augmented.values[e]);
+            else
+                EXTSparseBuilderPush(&rightBuilder, row - leftWidth,
+                                     augmented.values[e]);
+        }
+        EXTSparseBuilderEndColumn(&leftBuilder, column);
+        EXTSparseBuilderEndColumn(&rightBuilder, column++);
+    }
+
+    EXTSparseMatrixFree(&augmented);
+
+    *leftInclusion = leftBuilder.matrix;
+    *rightInclusion = rightBuilder.matrix;
+}
+
+EXTSparseMatrix EXTSparseMatrixImage(const EXTPrimeField *field,
+                                     const EXTSparseMatrix *matrix) {
+    EXTSparseMatrix reduced = EXTSparseMatrixCopy(matrix);
+    EXTScratchMark mark = EXTScratchSave();
+    int *pivotColumns = EXTScratchAlloc(sizeof(int) * (matrix->height + 1));
+    int rank = EXTSparseMatrixColumnReduce(field, &reduced, matrix->height,
+                                           pivotColumns);
+
+    EXTSparseBuilder builder =
+        EXTSparseBuilderCreate(rank, matrix->height,
+                               EXTSparseMatrixNonzeros(&reduced));
+    for (int j = 0, column = 0; j < matrix->height; j++) {
+        if (pivotColumns[j] == -1)
+            continue;
+
+        for (size_t e = reduced.columnStarts[pivotColumns[j]];
+             e < reduced.columnStarts[pivotColumns[j] + 1]; e++)
+            EXTSparseBuilderPush(&builder, reduced.rows[e], reduced.values[e]);
+        EXTSparseBuilderEndColumn(&builder, column++);
+    }
+
+    EXTScratchRestore(mark);
+    EXTSparseMatrixFree(&reduced);
+
+    return builder.matrix;
+}
@@ -6,7 +6,7 @@
 //  Copyright (c) 2013 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTLocation.h"
 #import "EXTZeroRange.h"
@@ -15,7 +15,7 @@
 //#import "EXTDifferential.h"
 
 @class EXTMultiplicationTables;
-@class EXTTerm, EXTDifferential;
+@class EXTTerm, EXTDifferential, EXTPageStore;
 
 @interface EXTSpectralSequence : NSObject <NSCoding>
 
@@ -26,6 +26,15 @@
 @property(nonatomic, strong) EXTLocationToPoint *locConvertor;
 @property(nonatomic, strong) NSMutableArray *zeroRanges;
 @property(assign, readonly) int defaultCharacteristic;
+// when set, the groups terms compute on pages past E_0 are kept in this store
+// on disk rather than in memory.  it's picked up by each term the next time
+// its groups are computed.
+@property(nonatomic, strong) EXTPageStore *pageStore;
+// when set, -computeGroupsForPage: forgets the homology representatives on the
+// pages strictly between E_0 and the one asked for.  they're recomputed from
+// the cycles and boundaries by -[EXTTerm homologyRepsForPage:] if they're
+// wanted again.
+@property(nonatomic, assign) BOOL dropsIntermediateRepresentatives;
 
 -(EXTSpectralSequence*) initWithIndexingClass:(Class<EXTLocation>)locClass
                             andCharacteristic:(int)characteristic;
@@ -48,16 +57,40 @@
                             viaProjection:(NSObject<EXTLocation>* (^)(NSObject<EXTLocation>*))projectionOperator;
 
 - (EXTTerm*)findTerm:(EXTLocation*)loc;
+// the same lookup, for a grading of the indexing class.
+- (EXTTerm*)findTermAtGrading:(EXTGrading)grading;
 - (void) addDifferential:(EXTDifferential*)diff;
 - (EXTDifferential*)findDifflWithSource:(EXTLocation*)loc onPage:(int)page;
 - (EXTDifferential*)findDifflWithTarget:(EXTLocation*)loc onPage:(int)page;
 - (NSArray*)findDifflsSourcedUnderPoint:(EXTIntPoint)point onPage:(int)page;
 - (NSArray*)findTermsUnderPoint:(EXTIntPoint)point;
+- (NSArray*)findTermsInGridRect:(EXTIntRect)rect;
 
 -(EXTMatrix*) productWithLeft:(EXTLocation*)leftLoc
                         right:(EXTLocation*)rightLoc;
+// readies -productWithLeft:right: for each of the pairs @[leftLoc, rightLoc],
+// doing the work in parallel where it can be done ahead of time.
+-(void) prepareProductsForPairs:(NSArray*)pairs;
 
+// brings the groups on pages 0, ..., page up to date.  once a page has been
+// computed, only the terms marked stale by the calls below (and whatever their
+// changes spill onto on later pages) are computed again.
 -(void) computeGroupsForPage:(int)page;
+// anything that edits a differential's partial definitions in place should
+// report it here, as should anything that edits a term's names or E_0 groups
+// in place: the term itself is still the same object, so nothing else can
+// tell it's changed, and its old groups would be kept.  adding, replacing or
+// removing terms in the dictionary recomputes everything by itself.
+-(void) invalidateDifferential:(EXTDifferential*)diff;
+-(void) invalidateTerm:(EXTTerm*)term;
+// zero ranges and products don't enter into the groups directly, but they
+// decide which differentials Leibniz propagation writes down, so edits to them
+// are reported too.  a range is only known by where it is now, so anything
+// that moves one should report it both before and after.  the multiplication
+// tables report their own additions; whoever edits an entry in place should
+// report it here.
+-(void) invalidateZeroRange:(EXTZeroRange*)range;
+-(void) invalidateProductsOf:(EXTLocation*)loc1 with:(EXTLocation*)loc2;
 
 // subclasses of EXTSpectralSequence can call this to be turned into plain old
 // instances of EXTSpectralSequence.  this should be useful for e.g. tensoring
@@ -71,6 +104,19 @@
 -(void) computeLeibniz:(EXTLocation *)loc1
                   with:(EXTLocation *)loc2
                 onPage:(int)page;
+// -computeLeibniz:with:onPage: comes in two halves, so that
+// -propagateLeibniz:page: can schedule them.  the first checks that the rule
+// applies and finds (or adds) the differential off the sum, returning nil if
+// not.  the second appends the partial definitions the rule gives to that
+// differential, and writes to nothing else.  subclasses with their own
+// multiplication override the second.
+-(EXTDifferential*) leibnizDifferentialFor:(EXTLocation *)loc1
+                                      with:(EXTLocation *)loc2
+                                    onPage:(int)page;
+-(void) addLeibnizPartialsFor:(EXTLocation *)loc1
+                         with:(EXTLocation *)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential *)dsum;
 
 -(int) rankOfVector:(NSArray*)vector
          inLocation:(EXTLocation*)loc
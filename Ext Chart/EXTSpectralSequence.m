@@ -13,19 +13,86 @@
 #import "EXTDifferential.h"
 #import "EXTMultiplicationTables.h"
 #import "EXTMatrix.h"
+#import "EXTLocationDictionary.h"
 
-@implementation EXTSpectralSequence
+#include <dispatch/dispatch.h>
+
+// the name of a basis element x (x) y of a tensor product.  charts can have
+// thousands of these per term, so they put off formatting themselves until
+// somebody looks.
+@interface EXTTensorName : NSObject <NSCopying, NSCoding>
+@property (strong, readonly) id left, right;
++(EXTTensorName*) nameWithLeft:(id)left right:(id)right;
+@end
+
+@implementation EXTTensorName
+
+@synthesize left, right;
+
++(EXTTensorName*) nameWithLeft:(id)newLeft right:(id)newRight {
+    EXTTensorName *ret = [EXTTensorName new];
+    ret->left = newLeft;
+    ret->right = newRight;
+    
+    return ret;
+}
+
+-(NSString*) description {
+    return [NSString stringWithFormat:@"%@ %@", left, right];
+}
+
+-(BOOL) isEqual:(id)object {
+    if (![object isKindOfClass:[EXTTensorName class]])
+        return NO;
+    
+    return [left isEqual:[object left]] && [right isEqual:[object right]];
+}
+
+-(NSUInteger) hash {
+    return [left hash] * 31 + [right hash];
+}
+
+-(instancetype) copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)aDecoder {
+    if (self = [super init]) {
+        left = [aDecoder decodeObjectForKey:@"left"];
+        right = [aDecoder decodeObjectForKey:@"right"];
+    }
+    
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeObject:left forKey:@"left"];
+    [aCoder encodeObject:right forKey:@"right"];
+}
+
+@end
+
+@implementation EXTSpectralSequence {
+    // staleTerms[r] holds the terms whose groups on page r are out of date.
+    // pages from computedPages on haven't been computed at all, and are only
+    // ever computed for every term at once.
+    NSMutableArray *staleTerms;
+    int computedPages;
+    unsigned long computedTermMutations;
+}
 
 @synthesize terms, differentials, multTables, indexClass, zeroRanges,
-            locConvertor, defaultCharacteristic;
+            locConvertor, defaultCharacteristic, pageStore,
+            dropsIntermediateRepresentatives;
 
 - (instancetype)initWithCoder:(NSCoder *)aDecoder {
     if (self = [super init]) {
-        terms = [aDecoder decodeObjectForKey:@"terms"];
+        terms = [EXTLocationDictionary dictionaryWithDictionary:
+                                    [aDecoder decodeObjectForKey:@"terms"]];
         defaultCharacteristic =
                         [aDecoder decodeIntegerForKey:@"defaultCharacteristic"];
         
-        differentials = [aDecoder decodeObjectForKey:@"differentials"];
+        self.differentials = [aDecoder decodeObjectForKey:@"differentials"];
         for (NSDictionary *page in differentials)
         for (EXTDifferential *diff in page.allValues) {
             diff.start = [terms objectForKey:((EXTLocation*)diff.start)];
@@ -84,9 +151,9 @@
                             andCharacteristic:(int)characteristic {
     if (self = [super init]) {
         defaultCharacteristic = characteristic;
-        terms = [NSMutableDictionary dictionary];
+        terms = [EXTLocationDictionary dictionary];
         differentials = [NSMutableArray array];
-        differentials[0] = [NSMutableDictionary dictionary];
+        differentials[0] = [EXTLocationDictionary dictionary];
         multTables = [EXTMultiplicationTables multiplicationTables:self];
         zeroRanges = [NSMutableArray array];
         [zeroRanges addObject:[EXTZeroRangeStrict newWithSSeq:self]];
@@ -109,9 +176,9 @@
     
     // and allocate the internal parts of things
     defaultCharacteristic = 0;
-    terms = [NSMutableDictionary dictionary];
+    terms = [EXTLocationDictionary dictionary];
     differentials = [NSMutableArray array];
-    differentials[0] = [NSMutableDictionary dictionary];
+    differentials[0] = [EXTLocationDictionary dictionary];
     multTables = [EXTMultiplicationTables multiplicationTables:self];
     indexClass = [EXTPair class];
     locConvertor = [EXTPairToPoint new];
@@ -133,14 +200,30 @@
 }
 
 
+// a spliced term, keyed by the first coordinate of its grading, for sorting.
+typedef struct {
+    int key;
+    NSUInteger index;
+} EXTSplicedKey;
+
+static int EXTCompareSplicedKeys(const void *a, const void *b) {
+    const EXTSplicedKey *x = a, *y = b;
+    
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
 // returns an EXTSpectralSequence which is given by the tensor product of the
 // current spectral sequence with an incoming collection of classes with
 // multiplication and diff'ls.
 //
-// apologies about my style; you can very much tell that i'm used to working in
-// a language with strong typing and an easy production of tuple types, neither
-// of which is quite true in Objective-C.  i'm not about to make a zillion
-// helper classes, though.
+// the pair terms A (x) P are bucketed by the location they land in, and each
+// bucket is spliced into one term by laying the pairs' bases end to end.  a
+// pair is named by its indices (i, j) into the two lists of terms, as the
+// number i * rightCount + j, which also indexes its offset into its spliced
+// term.  after that, the spliced terms, their differentials and their products
+// are each built in parallel, one spliced term at a time.
 //
 // XXX: each of these pieces should deal with the respective zero ranges in some
 // way. this means both computing the zero range of the tensor and handling
@@ -159,346 +242,353 @@
         ret = [EXTSpectralSequence sSeqWithIndexingClass:self.indexClass
                                        andCharacteristic:gcd];
     }
-
-    NSMutableArray *tensorTerms = [NSMutableArray array];
-    
-    // we need to do a bunch of manipulations over pairs of classes.
-    for (EXTTerm *t1 in self.terms.allValues) {
-        for (EXTTerm *t2 in p.terms.allValues) {
-            // build EXTTerm's for all the tensor pairs A (x) P, and store
-            // these in a separate list.
-            EXTLocation *loc = [[t1.location class] addLocation:t1.location
-                                                             to:t2.location];
-            NSMutableArray *names = [NSMutableArray array];
-            for (int i = 0; i < t1.size; i++)
-                for (int j = 0; j < t2.size; j++)
-                    [names addObject:[NSString stringWithFormat:@"%@ %@", t1.names[i], t2.names[j]]];
-            
-            EXTTerm *t1t2 = [EXTTerm term:loc withNames:names andCharacteristic:defaultCharacteristic];
-            t1t2.cycles[0] = [EXTMatrix hadamardProduct:t1.cycles[0] with:t2.cycles[0]];
-            t1t2.boundaries[0] = [EXTMatrix hadamardProduct:t1.boundaries[0] with:t2.boundaries[0]];
-            
-            [tensorTerms addObject:
-                [NSMutableArray arrayWithArray:@[t1t2, t1, t2, @false]]];
-        }
-    }
     
-    // some of these new EXTTerms will have overlapping EXTLocations. the next
-    // thing to do is to collect them together into one large EXTTerm per
-    // EXTLocation, remembering which term was added in which order.
-    NSMutableArray *splicedTensorTerms = [NSMutableArray array];
-    for (NSMutableArray *term in tensorTerms) {
-        // if this term has already been accounted for, then we must skip it.
-        if ([term[3] isEqual:@true])
-            continue;
-        
-        // otherwise, this designates some fresh EXTLocation.
-        EXTLocation *loc = [(EXTTerm*)term[0] location];
-        // iterate through all the terms, finding all the ones which share loc
-        NSMutableArray *atThisLoc = [NSMutableArray array];
-        for (NSMutableArray *workingTerm in tensorTerms) {
-            if ([[(EXTTerm*)workingTerm[0] location] isEqual:loc]) {
-                [atThisLoc addObject:workingTerm];
-                workingTerm[3] = @true;
-            }
-        }
-        
-        // now, we sum them together. we want a list of names.
-        NSMutableArray *sumNames = [NSMutableArray array];
-        EXTMatrix *sumCycles = [EXTMatrix matrixWidth:0 height:0],
-              *sumBoundaries = [EXTMatrix matrixWidth:0 height:0];
-        for (NSMutableArray *workingTerm in atThisLoc) {
-            [sumNames addObjectsFromArray:((EXTTerm*)workingTerm[0]).names];
-            sumCycles = [EXTMatrix directSum:sumCycles with:((EXTTerm*)workingTerm[0]).cycles[0]];
-            sumBoundaries = [EXTMatrix directSum:sumBoundaries with:((EXTTerm*)workingTerm[0]).boundaries[0]];
-        }
-        
-        EXTTerm *splicedTerm = [EXTTerm term:loc withNames:sumNames andCharacteristic:defaultCharacteristic];
-        splicedTerm.cycles[0] = sumCycles;
-        splicedTerm.boundaries[0] = sumBoundaries;
-        
-        // finally, add the summed term and its child terms to the spliced terms
-        [splicedTensorTerms addObject:@[splicedTerm, atThisLoc]];
-    }
+    dispatch_queue_t queue =
+        dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
     
-    // store these terms into the returning spectral sequence.
-    for (NSMutableArray* tuple in splicedTensorTerms) {
-        [ret.terms setObject:tuple[0] forKey:((EXTTerm*)tuple[0]).location];
+    NSArray *leftTerms = self.terms.allValues, *rightTerms = p.terms.allValues;
+    NSUInteger rightCount = rightTerms.count;
+    
+    // location => @(index into leftTerms or rightTerms).
+    EXTLocationDictionary
+        *leftIndices = [EXTLocationDictionary dictionaryWithCapacity:leftTerms.count],
+        *rightIndices = [EXTLocationDictionary dictionaryWithCapacity:rightCount];
+    for (NSUInteger i = 0; i < leftTerms.count; i++)
+        leftIndices[[leftTerms[i] location]] = @(i);
+    for (NSUInteger j = 0; j < rightCount; j++)
+        rightIndices[[rightTerms[j] location]] = @(j);
+    
+    // location => the pairs landing there, in the order they're spliced.
+    EXTLocationDictionary *buckets = [EXTLocationDictionary dictionary];
+    for (NSUInteger i = 0; i < leftTerms.count; i++)
+    for (NSUInteger j = 0; j < rightCount; j++) {
+        EXTLocation *loc = [[[leftTerms[i] location] class]
+                                addLocation:[leftTerms[i] location]
+                                         to:[rightTerms[j] location]];
+        NSMutableArray *bucket = buckets[loc];
+        if (!bucket)
+            buckets[loc] = bucket = [NSMutableArray array];
+        [bucket addObject:@(i * rightCount + j)];
     }
     
-    // XXX: i don't think that this is **summing** differentials correctly...
-    NSMutableArray *outputDifferentials = [NSMutableArray array];
-    // iterate over pairs of existing terms to build differentials from old ones
-    for (NSMutableArray *tuple in splicedTensorTerms) {
-        EXTTerm *start = tuple[0];
-        NSMutableArray *startSummands = tuple[1];
-        
-        // find all the differentials involving any of the working left-summands
-        NSMutableArray *partialPresentations = [NSMutableArray array];
-        for (NSMutableDictionary *dictionary in self.differentials)
-        for (EXTDifferential *d1 in dictionary.allValues) {
-            // check if this diff'l is attached to one of our left-summands.
-            int sourceIndex = -1, sourceOffset = 0;
-            for (int i = 0; i < startSummands.count; i++) {
-                NSMutableArray *tuple = startSummands[i];
-                if (tuple[1] == d1.start) {
-                    sourceIndex = i;
-                    break;
-                }
-                sourceOffset += ((EXTTerm*)tuple[1]).size;
-            }
-            if (sourceIndex == -1)
-                continue;
-            
-            EXTTerm *AP = ((NSMutableArray*)startSummands[sourceIndex])[0],
-                     *P = ((NSMutableArray*)startSummands[sourceIndex])[2];
+    NSArray *locations = buckets.allKeys;
+    NSUInteger count = locations.count;
+    int *offsets = malloc(sizeof(int) * (leftTerms.count * rightCount + 1));
+    
+    // splice together the pair terms at each location.
+    __strong EXTTerm **spliced =
+                    (__strong EXTTerm **)calloc(count, sizeof(EXTTerm*));
+    dispatch_apply(count, queue, ^(size_t s) {
+        @autoreleasepool {
+            NSMutableArray *sumNames = [NSMutableArray array];
+            EXTMatrix *sumCycles = [EXTMatrix matrixWidth:0 height:0],
+                  *sumBoundaries = [EXTMatrix matrixWidth:0 height:0];
             
-            // ok, so this differential is attached to our source term. we now
-            // find all the same data for its target term.
-            int endIndex = -1, endOffset = 0;
-            NSMutableArray *endSummands = nil;
-            EXTTerm *end = nil;
-            for (NSMutableArray *workingTuple in splicedTensorTerms) {
-                end = workingTuple[0];
-                endSummands = workingTuple[1];
-                endIndex = -1, endOffset = 0;
-                for (int i = 0; i < endSummands.count; i++) {
-                    NSMutableArray *tuple = endSummands[i];
-                    if ((tuple[1] == d1.end) && (tuple[2] == P)) {
-                        endIndex = i;
-                        break;
-                    }
-                    endOffset += ((EXTTerm*)tuple[0]).size;
-                }
+            for (NSNumber *pair in buckets[locations[s]]) {
+                EXTTerm *t1 = leftTerms[pair.unsignedIntegerValue / rightCount],
+                        *t2 = rightTerms[pair.unsignedIntegerValue % rightCount];
                 
-                if (endIndex != -1)
-                    break;
-            }
-            
-            EXTTerm *BP = ((NSMutableArray*)endSummands[endIndex])[0];
-            
-            // an EXTPartialDefinition used to look like A <-i--< A' --d-> B.
-            // now we're going to tensor up to P, which will give something like
-            // (+)_I A|P <-i1- A|P <-(i|1)-< A'|P -(d|1)-> B|P -i2-> (+)_J B|P.
-            // many of these pieces are common to varying i and d, so we pre-
-            // compute the ones we can hold constant.
-            EXTMatrix *idP = [EXTMatrix identity:P.size];
-            EXTMatrix *i1 = [EXTMatrix includeEvenlySpacedBasis:AP.size endDim:start.size offset:sourceOffset spacing:1];
-            EXTMatrix *i2 = [EXTMatrix includeEvenlySpacedBasis:BP.size endDim:end.size offset:endOffset spacing:1];
-            
-            // now we iterate through the available i and d.
-            NSMutableArray *partialsForThisD = [NSMutableArray array];
-            for (EXTPartialDefinition *partial in d1.partialDefinitions) {
-                EXTPartialDefinition *newPartial = [EXTPartialDefinition new];
-                EXTMatrix *ix1 = [EXTMatrix hadamardProduct:partial.inclusion with:idP];
-                EXTMatrix *dx1 = [EXTMatrix hadamardProduct:partial.action with:idP];
-                ix1.characteristic = ret.defaultCharacteristic;
-                dx1.characteristic = ret.defaultCharacteristic;
-                newPartial.inclusion = [EXTMatrix newMultiply:i1 by:ix1];
-                newPartial.action = [EXTMatrix newMultiply:i2 by:dx1];
-                partial.description = [NSString stringWithFormat:@"Tensored up from %@ (x) %@",d1.start.location,P.location];
-                [partialsForThisD addObject:partial];
+                offsets[pair.unsignedIntegerValue] = (int)sumNames.count;
+                for (int i = 0; i < t1.size; i++)
+                    for (int j = 0; j < t2.size; j++)
+                        [sumNames addObject:[EXTTensorName nameWithLeft:t1.names[i]
+                                                                  right:t2.names[j]]];
+                
+                sumCycles = [EXTMatrix directSum:sumCycles with:
+                    [EXTMatrix hadamardProduct:t1.cycles[0] with:t2.cycles[0]]];
+                sumBoundaries = [EXTMatrix directSum:sumBoundaries with:
+                    [EXTMatrix hadamardProduct:t1.boundaries[0]
+                                          with:t2.boundaries[0]]];
             }
             
-            [partialPresentations addObject:[NSMutableArray arrayWithObjects:start, end, @(d1.page), partialsForThisD, @false, nil]];
-        } // d1
+            EXTTerm *splicedTerm = [EXTTerm term:locations[s]
+                                       withNames:sumNames
+                               andCharacteristic:defaultCharacteristic];
+            splicedTerm.cycles[0] = sumCycles;
+            splicedTerm.boundaries[0] = sumBoundaries;
+            spliced[s] = splicedTerm;
+        }
+    });
+    
+    // store these terms into the returning spectral sequence.
+    for (NSUInteger s = 0; s < count; s++)
+        [ret.terms setObject:spliced[s] forKey:locations[s]];
+    
+    // an EXTPartialDefinition used to look like A <-i--< A' --d-> B.  tensored
+    // up to P, this becomes
+    // (+)_I A|P <-i1- A|P <-(i|1)-< A'|P -(d|1)-> B|P -i2-> (+)_J B|P,
+    // and symmetrically for the differentials of p.  the pair which d|1 lands
+    // in is looked up by index, so only the differentials actually leaving a
+    // pair's factors are ever visited.
+    NSArray *(^tensorDifferential)(EXTDifferential *, NSUInteger, NSUInteger,
+                                   EXTTerm *, BOOL) =
+        ^(EXTDifferential *d, NSUInteger sourcePair, NSUInteger endPair,
+          EXTTerm *start, BOOL onLeft) {
+        EXTTerm *A = leftTerms[sourcePair / rightCount],
+                *P = rightTerms[sourcePair % rightCount],
+                *B = leftTerms[endPair / rightCount],
+                *Q = rightTerms[endPair % rightCount],
+              *end = [ret findTerm:[[B.location class] addLocation:B.location
+                                                                to:Q.location]];
+        EXTMatrix
+            *identity = [EXTMatrix identity:(onLeft ? P.size : A.size)],
+            *i1 = [EXTMatrix includeEvenlySpacedBasis:(A.size * P.size)
+                                               endDim:start.size
+                                               offset:offsets[sourcePair]
+                                              spacing:1],
+            *i2 = [EXTMatrix includeEvenlySpacedBasis:(B.size * Q.size)
+                                               endDim:end.size
+                                               offset:offsets[endPair]
+                                              spacing:1];
         
-        // now also do d2.
-        // XXX: THIS IS DUPLICATED CODE. BUGS IN ONE MEAN BUGS IN THE OTHER.
-        // CORRECT APPROPRIATELY, AND EVENTUALLY FACTOR THIS ALL OUT.
-        for (NSMutableDictionary *dictionary in p.differentials)
-        for (EXTDifferential *d2 in dictionary.allValues) {
-            // check if this diff'l is attached to one of our right-summands.
-            int sourceIndex = -1, sourceOffset = 0;
-            for (int i = 0; i < startSummands.count; i++) {
-                NSMutableArray *tuple = startSummands[i];
-                if (tuple[2] == d2.start) {
-                    sourceIndex = i;
-                    break;
-                }
-                sourceOffset += ((EXTTerm*)tuple[2]).size;
-            }
-            if (sourceIndex == -1)
-                continue;
+        NSMutableArray *partials = [NSMutableArray array];
+        for (EXTPartialDefinition *partial in d.partialDefinitions) {
+            EXTPartialDefinition *newPartial = [EXTPartialDefinition new];
+            EXTMatrix
+                *ix1 = onLeft ?
+                    [EXTMatrix hadamardProduct:partial.inclusion with:identity] :
+                    [EXTMatrix hadamardProduct:identity with:partial.inclusion],
+                *dx1 = onLeft ?
+                    [EXTMatrix hadamardProduct:partial.action with:identity] :
+                    [EXTMatrix hadamardProduct:identity with:partial.action];
+            ix1.characteristic = ret.defaultCharacteristic;
+            dx1.characteristic = ret.defaultCharacteristic;
+            newPartial.inclusion = [EXTMatrix newMultiply:i1 by:ix1];
+            newPartial.action = [EXTMatrix newMultiply:i2 by:dx1];
+            newPartial.description =
+                [NSString stringWithFormat:@"Tensored up from %@ (x) %@",
+                                           A.location, P.location];
+            [partials addObject:newPartial];
+        }
+        
+        return @[end, partials];
+    };
+    
+    __strong NSArray **splicedDifferentials =
+                    (__strong NSArray **)calloc(count, sizeof(NSArray*));
+    dispatch_apply(count, queue, ^(size_t s) {
+        @autoreleasepool {
+            EXTTerm *start = spliced[s];
+            // @(page) => the differential leaving start on that page.
+            NSMutableDictionary *byPage = [NSMutableDictionary dictionary];
             
-            EXTTerm *AP = ((NSMutableArray*)startSummands[sourceIndex])[0],
-                    *A = ((NSMutableArray*)startSummands[sourceIndex])[1];
+            void (^collect)(EXTDifferential *, NSArray *) =
+                ^(EXTDifferential *d, NSArray *tensored) {
+                EXTDifferential *diff = byPage[@(d.page)];
+                if (!diff)
+                    byPage[@(d.page)] = diff =
+                        [EXTDifferential differential:start
+                                                  end:tensored[0]
+                                                 page:d.page];
+                [diff.partialDefinitions addObjectsFromArray:tensored[1]];
+            };
             
-            // ok, so this differential is attached to our source term. we now
-            // find all the same data for its target term.
-            int endIndex = -1, endOffset = 0;
-            NSMutableArray *endSummands = nil;
-            EXTTerm *end = nil;
-            for (NSMutableArray *workingTuple in splicedTensorTerms) {
-                end = workingTuple[0];
-                endSummands = workingTuple[1];
-                endIndex = -1, endOffset = 0;
-                for (int i = 0; i < endSummands.count; i++) {
-                    NSMutableArray *tuple = endSummands[i];
-                    if ((tuple[1] == A) && (tuple[2] == d2.end)) {
-                        endIndex = i;
-                        break;
-                    }
-                    endOffset += ((EXTTerm*)tuple[0]).size;
+            for (NSNumber *pair in buckets[start.location]) {
+                NSUInteger i = pair.unsignedIntegerValue / rightCount,
+                           j = pair.unsignedIntegerValue % rightCount;
+                
+                for (int page = 0; page < self.differentials.count; page++) {
+                    EXTDifferential *d1 =
+                        [self findDifflWithSource:[leftTerms[i] location]
+                                           onPage:page];
+                    NSNumber *endIndex = leftIndices[d1.end.location];
+                    if (!d1 || !endIndex)
+                        continue;
+                    
+                    collect(d1, tensorDifferential(d1, pair.unsignedIntegerValue,
+                                endIndex.unsignedIntegerValue * rightCount + j,
+                                start, YES));
                 }
                 
-                if (endIndex != -1)
-                    break;
-            }
-            
-            EXTTerm *AQ = ((NSMutableArray*)endSummands[endIndex])[0];
-            
-            // an EXTPartialDefinition used to look like P <-i--< P' --d-> Q.
-            // now we're going to tensor up to A, which will give something like
-            // (+)_I A|P <-i1- A|P <-(1|i)-< A|P' -(1|d)-> A|Q -i2-> (+)_J A|Q.
-            // many of these pieces are common to varying i and d, so we pre-
-            // compute the ones we can hold constant.
-            EXTMatrix *idA = [EXTMatrix identity:A.size];
-            EXTMatrix *i1 = [EXTMatrix includeEvenlySpacedBasis:AP.size endDim:start.size offset:sourceOffset spacing:1];
-            EXTMatrix *i2 = [EXTMatrix includeEvenlySpacedBasis:AQ.size endDim:end.size offset:endOffset spacing:1];
-            
-            // now we iterate through the available i and d.
-            NSMutableArray *partialsForThisD = [NSMutableArray array];
-            for (EXTPartialDefinition *partial in d2.partialDefinitions) {
-                EXTPartialDefinition *newPartial = [EXTPartialDefinition new];
-                EXTMatrix *ix1 = [EXTMatrix hadamardProduct:idA with:partial.inclusion];
-                EXTMatrix *dx1 = [EXTMatrix hadamardProduct:idA with:partial.action];
-                ix1.characteristic = ret.defaultCharacteristic;
-                dx1.characteristic = ret.defaultCharacteristic;
-                newPartial.inclusion = [EXTMatrix newMultiply:i1 by:ix1];
-                newPartial.action = [EXTMatrix newMultiply:i2 by:dx1];
-                partial.description = [NSString stringWithFormat:@"Tensored up from %@ (x) %@",A.location,d2.start.location];
-                [partialsForThisD addObject:partial];
-            }
-            
-            [partialPresentations addObject:[NSMutableArray arrayWithObjects:start, end, @(d2.page), partialsForThisD, @false, nil]];
-        } // d2
-        
-        // now collect all the differentials that live on the same term.
-        for (NSMutableArray *tagPartial in partialPresentations) {
-            if ([tagPartial[4] boolValue]) // if we've already collected this...
-                continue;                  // ... skip it.
-            
-            // otherwise, this is a new page, so a new differential.
-            EXTDifferential *diff = [EXTDifferential differential:tagPartial[0] end:tagPartial[1] page:[tagPartial[2] intValue]];
-            for (NSMutableArray *workingPartial in partialPresentations) {
-                if ((workingPartial[0] != tagPartial[0]) ||
-                    (workingPartial[1] != tagPartial[1]))
-                    continue;
-                [diff.partialDefinitions addObjectsFromArray:tagPartial[3]];
-                tagPartial[4] = @true;
+                for (int page = 0; page < p.differentials.count; page++) {
+                    EXTDifferential *d2 =
+                        [p findDifflWithSource:[rightTerms[j] location]
+                                        onPage:page];
+                    NSNumber *endIndex = rightIndices[d2.end.location];
+                    if (!d2 || !endIndex)
+                        continue;
+                    
+                    collect(d2, tensorDifferential(d2, pair.unsignedIntegerValue,
+                                i * rightCount + endIndex.unsignedIntegerValue,
+                                start, NO));
+                }
             }
             
-            while (diff.page <= outputDifferentials.count)
-                outputDifferentials[outputDifferentials.count] = [NSMutableDictionary dictionary];
-            [outputDifferentials[diff.page] setObject:diff forKey:diff.start.location];
-        } // partialPresentations
-    } // splicedTensorTerms
+            splicedDifferentials[s] = byPage.allValues;
+        }
+    });
     
     // store these differentials in to the returning spectral sequence
-    ret.differentials = outputDifferentials;
+    for (NSUInteger s = 0; s < count; s++) {
+        for (EXTDifferential *diff in splicedDifferentials[s])
+            [ret addDifferential:diff];
+        splicedDifferentials[s] = nil;
+    }
+    free(splicedDifferentials);
     
     // initialize the multiplication tables for the returning spectral sequence
     ret.multTables = [EXTMultiplicationTables multiplicationTables:ret];
     
-    // iterate over pairs of splicedTensorTerms
-    for (NSMutableArray *leftPair in splicedTensorTerms)
-    for (NSMutableArray *rightPair in splicedTensorTerms) {
-        EXTTerm *leftTerm = leftPair[0],
-                *rightTerm = rightPair[0];
-        NSMutableArray *leftSummands = leftPair[1],
-                      *rightSummands = rightPair[1];
+    // pairs of spliced terms whose sum is empty multiply to zero, so only the
+    // rest are expanded into their pairs of summands.  to find them without
+    // trying every pair, the spliced terms are sorted along the first
+    // coordinate, and a left term is only tried against the run of right
+    // terms which keeps the sum inside the bounding box of the chart.  those
+    // are tried by grading, so a pair with an empty sum builds no location.
+    EXTGrading *gradings = malloc(sizeof(EXTGrading) * (count + 1)),
+               lower = {0}, upper = {0};
+    EXTSplicedKey *order = malloc(sizeof(EXTSplicedKey) * (count + 1));
+    for (NSUInteger s = 0; s < count; s++) {
+        gradings[s] = spliced[s].location.grading;
+        order[s] = (EXTSplicedKey){gradings[s].coordinates[0], s};
         
-        // iterate over pairs of old terms which belong to splicedVectorTerms
-        for (NSMutableArray *leftSummand in leftSummands)
-        for (NSMutableArray *rightSummand in rightSummands) {
-            EXTTerm *A = leftSummand[1], *P = leftSummand[2],
-                    *B = rightSummand[1], *Q = rightSummand[2];
-            
-            EXTMultiplicationEntry
-                *leftEntry = [self.multTables performSoftLookup:A.location
-                                                           with:B.location],
-                *rightEntry = [p.multTables performSoftLookup:P.location
-                                                         with:Q.location];
-            if (!leftEntry || !rightEntry)
-                continue;
-            
-            NSMutableArray
-                *leftPartials = leftEntry.partialDefinitions,
-                *rightPartials = rightEntry.partialDefinitions;
-            
-            // look up the target term, which we need for indexing purposes.
-            EXTTerm *C = [self findTerm:[[A.location class] addLocation:A.location to:B.location]],
-                    *R = [p findTerm:[[P.location class] addLocation:P.location to:Q.location]];
-            
-            // if we're not going to multiply into anything, then the
-            // multiplication is zero/undefined and we skip it.
-            if (!C || !R)
-                continue;
+        if (s == 0)
+            lower = upper = gradings[s];
+        for (int k = 0; k < gradings[s].rank; k++) {
+            lower.coordinates[k] = MIN(lower.coordinates[k],
+                                       gradings[s].coordinates[k]);
+            upper.coordinates[k] = MAX(upper.coordinates[k],
+                                       gradings[s].coordinates[k]);
+        }
+    }
+    qsort(order, count, sizeof(EXTSplicedKey), EXTCompareSplicedKeys);
+    
+    __strong NSArray **splicedProducts =
+                    (__strong NSArray **)calloc(count, sizeof(NSArray*));
+    dispatch_apply(count, queue, ^(size_t s) {
+        @autoreleasepool {
+            EXTTerm *leftTerm = spliced[s];
+            EXTGrading leftGrading = gradings[s];
+            NSMutableArray *products = [NSMutableArray array];
             
-            EXTTerm *CR = nil, *CRplus = nil;
-            int CRoffset = 0;
-            for (NSMutableArray *workingTuple in splicedTensorTerms) {
-                for (NSMutableArray *subTuple in workingTuple[1]) {
-                    if ((subTuple[1] == C) &&
-                        (subTuple[2] == R)) {
-                        CR = subTuple[0];
-                        CRplus = workingTuple[0];
-                        break;
-                    } else CRoffset += ((EXTTerm*)(subTuple[0])).size;
-                }
-                if (CR) break;
-                CRoffset = 0;
+            // the first of the right terms whose first coordinate is in range.
+            int low = lower.coordinates[0] - leftGrading.coordinates[0],
+                high = upper.coordinates[0] - leftGrading.coordinates[0];
+            NSUInteger first = 0, last = count;
+            while (first < last) {
+                NSUInteger middle = (first + last) / 2;
+                if (order[middle].key < low)
+                    first = middle + 1;
+                else
+                    last = middle;
             }
             
-            int BQoffset = 0;
-            for (int i = 0; i < [rightSummands indexOfObject:rightSummand]; i++)
-                BQoffset += ((EXTTerm*)(rightSummands[i])).size;
-            
-            // while we're at it, build the inclusion matrix C|R --> (+) C|R
-            EXTMatrix *i2 = [EXTMatrix includeEvenlySpacedBasis:CR.size endDim:CRplus.size offset:CRoffset spacing:1];
+            // collected, so that they're expanded in the order of spliced.
+            NSMutableIndexSet *hits = [NSMutableIndexSet indexSet];
+            for (NSUInteger o = first; o < count && order[o].key <= high; o++) {
+                EXTGrading sum = EXTGradingAdd(leftGrading,
+                                               gradings[order[o].index]);
+                BOOL inside = YES;
+                for (int k = 1; k < sum.rank && inside; k++)
+                    inside = lower.coordinates[k] <= sum.coordinates[k] &&
+                             sum.coordinates[k] <= upper.coordinates[k];
+                if (inside && [ret findTermAtGrading:sum])
+                    [hits addIndex:order[o].index];
+            }
             
-            for (EXTPartialDefinition *leftPartial in leftPartials)
-            for (EXTPartialDefinition *rightPartial in rightPartials) {
-                EXTPartialDefinition *tensorPartial = [EXTPartialDefinition new];
-                
-                // A|B <-i- I -f-> C and P|Q <-j- J -g-> R become the pair
-                // I|J -i|j-> (A|B)|(P|Q) -i1-> ((+)A|P)|((+)B|Q) ,
-                // I|J -f|g-> C|R -i2-> (+) C|R .
-                // this second one is easy, so we do it first.
-                tensorPartial.inclusion = [EXTMatrix newMultiply:i2 by:[EXTMatrix hadamardProduct:leftPartial.inclusion with:rightPartial.inclusion]];
-                
-                // this biggest challenge is constructing i1.  this matrix has
-                // to include across the reassociation and transposition
-                // (A|B)|(P|Q) ~= (A|P)|(B|Q), along with dealing with one of
-                // the big direct sum inclusions we're constructing.
-                EXTMatrix *i1 = [EXTMatrix matrixWidth:(A.size*B.size*P.size*Q.size) height:(leftTerm.size*rightTerm.size)];
-                
-                for (int i = 0; i < A.size; i++)
-                for (int j = 0; j < P.size; j++)
-                for (int k = 0; k < B.size; k++)
-                for (int l = 0; l < Q.size; l++) {
-                    int APskip = B.size*Q.size*([leftSummands indexOfObject:leftSummand] + i*P.size + j);
-                    // poke a 1 in at this location.  the only way to see that
-                    // this is a reasonable thing to do is to draw out an
-                    // example.  i'm very sorry. :(
-                    //
-                    // addendum: because this is where we deal with commuting
-                    // P across B, this is also where the koszul sign rule shows
-                    // up. that's what that little conditional is about.
-                    ((int*)i1.presentation.mutableBytes)[(l+Q.size*(j+P.size*(k+i*B.size)))*i1.height + (APskip + BQoffset + k*Q.size + l)] = (B.location.koszulDegree * P.location.koszulDegree) & 0x1 ? -1 : 1;
-                }
+            for (NSUInteger t = hits.firstIndex; t != NSNotFound;
+                 t = [hits indexGreaterThanIndex:t]) {
+                EXTTerm *rightTerm = spliced[t],
+                        *CRplus = [ret findTermAtGrading:
+                                    EXTGradingAdd(leftGrading, gradings[t])];
                 
-                // now, we use this to build the differential presentation.
-                tensorPartial.action = [EXTMatrix newMultiply:i1 by:[EXTMatrix hadamardProduct:leftPartial.action with:rightPartial.action]];
-                
-                // store to the table
-                [ret.multTables addPartialDefinition:tensorPartial
-                                                  to:[leftTerm location]
-                                                with:[rightTerm location]];
-            } // left/rightPartials
-        } // left/rightSummands
-    } // splicedTensorTerms
+                for (NSNumber *leftPair in buckets[leftTerm.location])
+                for (NSNumber *rightPair in buckets[rightTerm.location]) {
+                    NSUInteger APpair = leftPair.unsignedIntegerValue,
+                               BQpair = rightPair.unsignedIntegerValue;
+                    EXTTerm *A = leftTerms[APpair / rightCount],
+                            *P = rightTerms[APpair % rightCount],
+                            *B = leftTerms[BQpair / rightCount],
+                            *Q = rightTerms[BQpair % rightCount];
+                    
+                    EXTMultiplicationEntry
+                        *leftEntry = [self.multTables performSoftLookup:A.location
+                                                                   with:B.location],
+                        *rightEntry = [p.multTables performSoftLookup:P.location
+                                                                 with:Q.location];
+                    if (!leftEntry || !rightEntry)
+                        continue;
+                    
+                    // look up the target term, which we need for indexing
+                    // purposes.  if we're not going to multiply into
+                    // anything, then the multiplication is zero/undefined and
+                    // we skip it.
+                    NSNumber *C = [leftIndices objectForGrading:
+                                EXTGradingAdd(A.location.grading, B.location.grading)],
+                             *R = [rightIndices objectForGrading:
+                                EXTGradingAdd(P.location.grading, Q.location.grading)];
+                    if (!C || !R)
+                        continue;
+                    NSUInteger CRpair = C.unsignedIntegerValue * rightCount +
+                                        R.unsignedIntegerValue;
+                    
+                    // build the inclusion matrix C|R --> (+) C|R
+                    EXTMatrix *i2 = [EXTMatrix includeEvenlySpacedBasis:([leftTerms[C.unsignedIntegerValue] size] * [rightTerms[R.unsignedIntegerValue] size])
+                                                                 endDim:CRplus.size
+                                                                 offset:offsets[CRpair]
+                                                                spacing:1];
+                    
+                    // and the inclusion across the reassociation and
+                    // transposition (A|B)|(P|Q) ~= (A|P)|(B|Q), into the big
+                    // direct sums on either side.  commuting P across B is
+                    // where the koszul sign rule shows up.
+                    int entries = A.size * B.size * P.size * Q.size, e = 0,
+                        sign = (B.location.koszulDegree *
+                                P.location.koszulDegree) & 0x1 ? -1 : 1;
+                    int *columns = malloc(sizeof(int) * (entries + 1)),
+                        *rows = malloc(sizeof(int) * (entries + 1)),
+                        *values = malloc(sizeof(int) * (entries + 1));
+                    for (int i = 0; i < A.size; i++)
+                    for (int j = 0; j < P.size; j++)
+                    for (int k = 0; k < B.size; k++)
+                    for (int l = 0; l < Q.size; l++, e++) {
+                        columns[e] = l + Q.size*(j + P.size*(k + i*B.size));
+                        rows[e] = (offsets[APpair] + i*P.size + j) * rightTerm.size +
+                                  offsets[BQpair] + k*Q.size + l;
+                        values[e] = sign;
+                    }
+                    EXTMatrix *i1 = [EXTMatrix matrixWidth:entries
+                                                    height:(leftTerm.size * rightTerm.size)
+                                                   entries:entries
+                                                   columns:columns
+                                                      rows:rows
+                                                    values:values
+                                            characteristic:ret.defaultCharacteristic];
+                    free(columns); free(rows); free(values);
+                    
+                    for (EXTPartialDefinition *leftPartial in leftEntry.partialDefinitions)
+                    for (EXTPartialDefinition *rightPartial in rightEntry.partialDefinitions) {
+                        // A|B <-i- I -f-> C and P|Q <-j- J -g-> R become the
+                        // pair I|J -i|j-> (A|B)|(P|Q) -i1-> ((+)A|P)|((+)B|Q),
+                        // I|J -f|g-> C|R -i2-> (+) C|R .
+                        EXTPartialDefinition *tensorPartial = [EXTPartialDefinition new];
+                        tensorPartial.inclusion = [EXTMatrix newMultiply:i1 by:[EXTMatrix hadamardProduct:leftPartial.inclusion with:rightPartial.inclusion]];
+                        tensorPartial.action = [EXTMatrix newMultiply:i2 by:[EXTMatrix hadamardProduct:leftPartial.action with:rightPartial.action]];
+                        
+                        [products addObject:@[tensorPartial, leftTerm.location,
+                                              rightTerm.location]];
+                    }
+                } // left/rightPair
+            } // t
+            
+            splicedProducts[s] = products;
+        }
+    });
+    
+    // store to the table
+    for (NSUInteger s = 0; s < count; s++) {
+        for (NSArray *product in splicedProducts[s])
+            [ret.multTables addPartialDefinition:product[0]
+                                              to:product[1]
+                                            with:product[2]];
+        splicedProducts[s] = nil;
+        spliced[s] = nil;
+    }
+    free(splicedProducts);
+    free(spliced);
+    free(offsets);
+    free(gradings);
+    free(order);
     
     return ret;
 }
@@ -555,18 +645,49 @@
     return l;
 }
 
+// the terms and the pages of differentials are always kept in
+// EXTLocationDictionary's, so that they can be searched by grading.  whatever
+// dictionaries are handed in are copied over, unless they're already of that
+// kind (which keeps -upcastToSSeq sharing its terms).
+static NSMutableDictionary *EXTLocationDictionaryFrom(NSDictionary *dictionary) {
+    if ([dictionary isKindOfClass:[EXTLocationDictionary class]])
+        return (NSMutableDictionary*)dictionary;
+    
+    return [EXTLocationDictionary dictionaryWithDictionary:dictionary];
+}
+
+-(void) setTerms:(NSMutableDictionary*)newTerms {
+    terms = EXTLocationDictionaryFrom(newTerms);
+    computedPages = 0;
+    [staleTerms removeAllObjects];
+}
+
+-(void) setDifferentials:(NSMutableArray*)newDifferentials {
+    for (NSUInteger page = 0; page < newDifferentials.count; page++)
+        if (![newDifferentials[page] isKindOfClass:[EXTLocationDictionary class]])
+            newDifferentials[page] =
+                            EXTLocationDictionaryFrom(newDifferentials[page]);
+    
+    differentials = newDifferentials;
+}
+
 -(EXTTerm*) findTerm:(EXTLocation *)loc {
     return [terms objectForKey:loc];
 }
 
+-(EXTTerm*) findTermAtGrading:(EXTGrading)grading {
+    return [(EXTLocationDictionary*)terms objectForGrading:grading];
+}
+
 -(void) addDifferential:(EXTDifferential*)diff {
     // first resize the differentials array if it needs it.
     while (differentials.count <= diff.page)
-        differentials[differentials.count] = [NSMutableDictionary dictionary];
+        differentials[differentials.count] = [EXTLocationDictionary dictionary];
     
     NSMutableDictionary *dictionary = differentials[diff.page];
     
     [dictionary setObject:diff forKey:diff.start.location];
+    [self invalidateDifferential:diff];
 }
 
 -(EXTDifferential*) findDifflWithSource:(EXTLocation *)loc onPage:(int)page {
@@ -581,47 +702,211 @@
     return [self findDifflWithSource:startLoc onPage:page];
 }
 
+// the point queries below are asked on every hover and click, so they go
+// through grid indices kept by the term and differential dictionaries rather
+// than projecting every location in the sequence.
 - (NSArray*)findDifflsSourcedUnderPoint:(EXTIntPoint)point onPage:(int)page {
-    NSMutableArray *ret = [NSMutableArray array];
-    
     if (page >= differentials.count)
-        return ret;
+        return @[];
+    
+    EXTLocationDictionary *difflsOnPage = self.differentials[page];
+    return [[difflsOnPage gridIndexForProjection:[self.locConvertor gridProjection]] objectsAtPoint:point];
+}
+
+- (NSArray*)findTermsUnderPoint:(EXTIntPoint)point {
+    EXTLocationDictionary *locationTerms = (EXTLocationDictionary*)terms;
+    return [[locationTerms gridIndexForProjection:[self.locConvertor gridProjection]] objectsAtPoint:point];
+}
+
+- (NSArray*)findTermsInGridRect:(EXTIntRect)rect {
+    EXTLocationDictionary *locationTerms = (EXTLocationDictionary*)terms;
+    return [[locationTerms gridIndexForProjection:[self.locConvertor gridProjection]] objectsInRect:rect];
+}
+
+#pragma mark - dirty tracking
+
+-(void) markTerm:(EXTTerm*)term staleOnPage:(int)page {
+    if (!term || page >= computedPages)
+        return;
     
-    NSMutableDictionary *difflsOnPage = self.differentials[page];
+    if (!staleTerms)
+        staleTerms = [NSMutableArray array];
+    while (staleTerms.count <= page)
+        [staleTerms addObject:[NSMutableSet set]];
     
-    for (EXTLocation *loc in difflsOnPage) {
-        EXTIntPoint difflPoint = [self.locConvertor gridPoint:loc];
-        if (EXTEqualIntPoints(difflPoint, point))
-            [ret addObject:[difflsOnPage objectForKey:loc]];
-    }
+    [staleTerms[page] addObject:term];
+}
+
+-(void) invalidateDifferential:(EXTDifferential*)diff {
+    [diff invalidatePresentation];
     
-    return ret;
+    // the differential only enters into the groups on the next page, as the
+    // cycles of its source and the boundaries of its target.
+    [self markTerm:diff.start staleOnPage:(diff.page + 1)];
+    [self markTerm:diff.end staleOnPage:(diff.page + 1)];
 }
 
-- (NSArray*)findTermsUnderPoint:(EXTIntPoint)point {
-    NSMutableArray *ret = [NSMutableArray array];
+-(void) invalidateTerm:(EXTTerm*)term {
+    [self markTerm:term staleOnPage:0];
+}
+
+-(void) invalidateZeroRange:(EXTZeroRange*)range {
+    // a range matters to the terms inside it, and to the terms whose
+    // differentials land inside it.
+    for (EXTTerm *term in terms.allValues)
+        for (int r = 1; r < computedPages; r++)
+            if ([range isInRange:term.location] ||
+                [range isInRange:[[term.location class] followDiffl:term.location
+                                                               page:(r - 1)]])
+                [self markTerm:term staleOnPage:r];
+}
+
+-(void) invalidateProductsOf:(EXTLocation*)loc1 with:(EXTLocation*)loc2 {
+    if (computedPages <= 1)
+        return;
+    
+    // the product lands in the term at the sum, whose differentials Leibniz
+    // propagation builds out of it.
+    EXTTerm *target = [self findTerm:[[loc1 class] addLocation:loc1 to:loc2]];
+    for (int r = 1; r < computedPages; r++)
+        [self markTerm:target staleOnPage:r];
+}
+
+-(void) setZeroRanges:(NSMutableArray*)newZeroRanges {
+    for (EXTZeroRange *range in zeroRanges)
+        [self invalidateZeroRange:range];
+    
+    zeroRanges = newZeroRanges;
+    
+    for (EXTZeroRange *range in zeroRanges)
+        [self invalidateZeroRange:range];
+}
+
+// recomputes the groups of some terms on a page from those on the page before.
+// each term depends only on the page before, so the work is spread over every
+// core in three phases: the differentials into and out of the terms from the
+// page before are assembled, in parallel; then each term's groups are computed,
+// in parallel, reading only the page before; then they're written down, one
+// after another.  only the last phase writes to anything shared, so the results
+// don't depend on how the work was divided up.
+//
+// with markChanges set, whatever the new groups feed into on the next page is
+// marked stale.
+-(void) computeGroupsOfTerms:(NSArray*)pageTerms
+                      onPage:(int)page
+              markingChanges:(BOOL)markChanges {
+    dispatch_queue_t queue =
+        dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    
+    if (page > 0) {
+        NSMutableSet *incident = [NSMutableSet set];
+        for (EXTTerm *term in pageTerms) {
+            EXTDifferential *outgoing = [self findDifflWithSource:term.location
+                                                           onPage:(page - 1)],
+                            *incoming = [self findDifflWithTarget:term.location
+                                                           onPage:(page - 1)];
+            if (outgoing)
+                [incident addObject:outgoing];
+            if (incoming)
+                [incident addObject:incoming];
+        }
+        
+        NSArray *diffs = incident.allObjects;
+        dispatch_apply(diffs.count, queue, ^(size_t i) {
+            @autoreleasepool {
+                [(EXTDifferential*)diffs[i] presentation];
+            }
+        });
+    }
+    
+    NSUInteger count = pageTerms.count;
+    __strong NSArray **groups =
+                    (__strong NSArray **)calloc(count, sizeof(NSArray*));
+    dispatch_apply(count, queue, ^(size_t i) {
+        @autoreleasepool {
+            groups[i] = [(EXTTerm*)pageTerms[i] groupsForPage:page inSSeq:self];
+        }
+    });
     
-    for (EXTLocation *loc in terms) {
-        EXTIntPoint termPoint = [self.locConvertor gridPoint:loc];
-        if (EXTEqualIntPoints(termPoint, point))
-            [ret addObject:[terms objectForKey:loc]];
+    for (NSUInteger i = 0; i < count; i++) {
+        EXTTerm *term = pageTerms[i];
+        EXTMatrix *oldCycles = term.cycles.count > page ?
+                                                    term.cycles[page] : nil,
+                  *oldBoundaries = term.boundaries.count > page ?
+                                                    term.boundaries[page] : nil;
+        
+        if (pageStore)
+            [term usePageStore:pageStore];
+        [term storeGroups:groups[i] forPage:page];
+        groups[i] = nil;
+        
+        EXTDifferential *outgoing = [self findDifflWithSource:term.location
+                                                       onPage:page],
+                        *incoming = [self findDifflWithTarget:term.location
+                                                       onPage:page];
+        [outgoing invalidatePresentation];
+        
+        // the E_0 groups are edited in place, so there's nothing to compare to.
+        if (!markChanges ||
+            (page > 0 &&
+             [oldCycles isEqual:term.cycles[page]] &&
+             [oldBoundaries isEqual:term.boundaries[page]]))
+            continue;
+        
+        // the cycles and boundaries here feed into the same term on the next
+        // page, into the boundaries of the target of the outgoing differential,
+        // and, through the boundaries, into the cycles of the incoming one's
+        // source.
+        [self markTerm:term staleOnPage:(page + 1)];
+        [self markTerm:outgoing.end staleOnPage:(page + 1)];
+        [self markTerm:incoming.start staleOnPage:(page + 1)];
     }
     
-    return ret;
+    free(groups);
 }
 
 -(void) computeGroupsForPage:(int)page {
-    if (differentials.count > page)
-        for (EXTDifferential *diff in ((NSDictionary*)differentials[page]).allValues)
-            [diff assemblePresentation];
+    // terms are added to, replaced in and removed from the dictionary
+    // directly all over the place, so treat any change to it as invalidating
+    // everything.  a delete and an add, or a replacement, leave the count
+    // alone, so this goes by the dictionary's own mutation count instead.
+    unsigned long mutations = [(EXTLocationDictionary*)terms mutationCount];
+    if (mutations != computedTermMutations) {
+        computedPages = 0;
+        computedTermMutations = mutations;
+        [staleTerms removeAllObjects];
+    }
     
-    for (EXTTerm *term in self.terms.allValues) {
-        [term updateDataForPage:page inSSeq:self];
+    for (int r = 0; r <= page; r++) {
+        if (r >= computedPages) {
+            [self computeGroupsOfTerms:terms.allValues
+                                onPage:r
+                        markingChanges:NO];
+            
+            computedPages = r + 1;
+            if (staleTerms.count > r)
+                [staleTerms[r] removeAllObjects];
+            continue;
+        }
+        
+        if (staleTerms.count <= r || [staleTerms[r] count] == 0)
+            continue;
+        
+        NSArray *stale = [staleTerms[r] allObjects];
+        [staleTerms[r] removeAllObjects];
+        [self computeGroupsOfTerms:stale onPage:r markingChanges:YES];
     }
     
+    if (dropsIntermediateRepresentatives)
+        for (EXTTerm *term in terms.allValues)
+            for (int r = 1; r < page; r++)
+                [term dropHomologyRepsForPage:r];
+    
     return;
 }
 
+#pragma mark -
+
 -(BOOL) isInZeroRanges:(EXTLocation*)loc {
     BOOL disjunction = false;
     
@@ -635,10 +920,61 @@
     return self;
 }
 
+-(EXTDifferential*) leibnizDifferentialFor:(EXTLocation *)loc1
+                                      with:(EXTLocation *)loc2
+                                    onPage:(int)page {
+    EXTLocation *sumLoc = [[loc1 class] addLocation:loc1 to:loc2],
+             *targetLoc = [[loc1 class] followDiffl:sumLoc page:page];
+    EXTTerm *sumterm = [self findTerm:sumLoc],
+         *targetterm = [self findTerm:targetLoc];
+    EXTDifferential *d1 = [self findDifflWithSource:loc1 onPage:page],
+                    *d2 = [self findDifflWithSource:loc2 onPage:page];
+    
+    // if we don't have differentials to work with, then skip this entirely.
+    // XXX: i'm not sure this condition is quite right.
+    BOOL d1Zero = [self isInZeroRanges:[[loc1 class] followDiffl:loc1
+                                                            page:page]],
+         d2Zero = [self isInZeroRanges:[[loc2 class] followDiffl:loc2
+                                                            page:page]];
+    if ((!d1 && !d1Zero) ||
+        (!d2 && !d2Zero) ||
+        !targetterm ||
+        [self isInZeroRanges:sumLoc] ||
+        !sumterm ||
+        [self isInZeroRanges:targetLoc])
+        return nil;
+    
+    // if we're here, then we have all the fixin's we need to construct some
+    // more partial differential definitions.  let's find a place to put them.
+    EXTDifferential *dsum = [self findDifflWithSource:sumterm.location
+                                               onPage:page];
+    if (!dsum) {
+        dsum = [EXTDifferential differential:sumterm end:targetterm page:page];
+        [self addDifferential:dsum];
+    }
+    
+    return dsum;
+}
+
+-(void) addLeibnizPartialsFor:(EXTLocation *)loc1
+                         with:(EXTLocation *)loc2
+                       onPage:(int)page
+                           to:(EXTDifferential *)dsum {
+    [multTables addLeibnizPartialsFor:loc1 with:loc2 onPage:page to:dsum];
+}
+
 -(void) computeLeibniz:(EXTLocation *)loc1
                   with:(EXTLocation *)loc2
                 onPage:(int)page {
-    [multTables computeLeibniz:loc1 with:loc2 onPage:page];
+    EXTDifferential *dsum = [self leibnizDifferentialFor:loc1
+                                                    with:loc2
+                                                  onPage:page];
+    if (!dsum)
+        return;
+    
+    [self addLeibnizPartialsFor:loc1 with:loc2 onPage:page to:dsum];
+    [dsum stripDuplicates];
+    [self invalidateDifferential:dsum];
 }
 
 -(void) naivelyPropagateLeibniz:(EXTLocation*)loc page:(int)page {
@@ -649,92 +985,196 @@
     return;
 }
 
+// a node of the walk in -propagateLeibniz:page:: the term a product lands in,
+// the generator it was last multiplied by, and its digital sum.  the terms
+// belong to the spectral sequence, which outlives the walk.
+typedef struct {
+    __unsafe_unretained EXTTerm *term;
+    NSUInteger topEntry;
+    int digitalSum;
+} EXTLeibnizNode;
+
+// the nodes already walked from, open-addressed by value.  empty slots have no
+// term.
+typedef struct {
+    EXTLeibnizNode *slots;
+    NSUInteger capacity, count;
+} EXTLeibnizNodeSet;
+
+static uint64_t EXTLeibnizNodeHash(EXTLeibnizNode node) {
+    uint64_t hash = (uint64_t)(uintptr_t)(__bridge void*)node.term;
+    hash ^= (uint64_t)node.topEntry * 0x9e3779b97f4a7c15ull;
+    hash ^= (uint64_t)(uint32_t)node.digitalSum * 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 31;
+    hash *= 0x94d049bb133111ebull;
+    
+    return hash ^ (hash >> 29);
+}
+
+// returns NO if node was already in the set.
+static BOOL EXTLeibnizNodeSetAdd(EXTLeibnizNodeSet *set, EXTLeibnizNode node) {
+    if (2 * (set->count + 1) > set->capacity) {
+        EXTLeibnizNodeSet grown = {
+            .capacity = set->capacity ? 2 * set->capacity : 64, .count = 0};
+        grown.slots = calloc(grown.capacity, sizeof(EXTLeibnizNode));
+        for (NSUInteger i = 0; i < set->capacity; i++)
+            if (set->slots[i].term)
+                EXTLeibnizNodeSetAdd(&grown, set->slots[i]);
+        free(set->slots);
+        *set = grown;
+    }
+    
+    NSUInteger mask = set->capacity - 1,
+               slot = (NSUInteger)EXTLeibnizNodeHash(node) & mask;
+    for (; set->slots[slot].term; slot = (slot + 1) & mask)
+        if (set->slots[slot].term == node.term &&
+            set->slots[slot].topEntry == node.topEntry &&
+            set->slots[slot].digitalSum == node.digitalSum)
+            return NO;
+    
+    set->slots[slot] = node;
+    set->count++;
+    return YES;
+}
+
 // propagates differentials along a specified lattice of EXTLocations
 -(void) propagateLeibniz:(NSArray*)locations page:(int)page {
     if (locations.count == 0)
         return;
     
-    CFMutableArrayRef maxes = CFArrayCreateMutable(kCFAllocatorDefault, locations.count, NULL);
-    Class<EXTLocation> locClass = [(EXTLocation*)locations[0] class];
+    // walk outward through the products of the generators which are actually
+    // present.  a product g_i1 * ... * g_in, with i1 <= ... <= in, is reached
+    // exactly once: from g_i1 * ... * g_i(n-1), by multiplying by its topmost
+    // generator, which is what we'll propagate against.  a product with no
+    // term, or which lies in a zero range, carries no differential for the
+    // products above it to be built from, so the whole subtree above it is
+    // skipped rather than probed.  the products are only collected here, by
+    // digital sum: each one reads the differentials off its factors, whose
+    // digital sums are smaller, so they can be carried out a digital sum at a
+    // time.
+    //
+    // distinct products can land on the same location.  what lies above one
+    // depends only on its location, topmost generator and digital sum, so
+    // each of those is walked from once.
+    //
+    // the nodes are kept by value, so that a probe which finds nothing new
+    // allocates nothing.
+    NSMutableArray *products = [NSMutableArray array];
+    EXTLeibnizNodeSet visited = {NULL, 0, 0};
+    NSUInteger frontierCount = 0, frontierCapacity = locations.count;
+    EXTLeibnizNode *frontier = malloc(frontierCapacity * sizeof(EXTLeibnizNode));
+    for (NSUInteger i = 0; i < locations.count; i++) {
+        EXTTerm *term = [self findTerm:locations[i]];
+        if (term && ![self isInZeroRanges:locations[i]])
+            frontier[frontierCount++] = (EXTLeibnizNode){term, i, 1};
+    }
     
-    // build the array of maximums
-    for (int i = 0; i < locations.count; i++) {
-        EXTLocation *loc = locations[i];
-        for (NSInteger j = 1; true; j++) {
-            EXTTerm *t = [self findTerm:loc];
+    while (frontierCount > 0) {
+        EXTLeibnizNode node = frontier[--frontierCount];
+        EXTLocation *leftLoc = node.term.location;
+        int digitalSum = node.digitalSum + 1;
+        
+        // the probes are by grading, so an empty cell costs no location.
+        EXTGrading leftGrading = leftLoc.grading;
+        for (NSUInteger i = node.topEntry; i < locations.count; i++) {
+            EXTTerm *sumTerm = [self findTermAtGrading:
+                    EXTGradingAdd(leftGrading, [locations[i] grading])];
+            if (!sumTerm || [self isInZeroRanges:sumTerm.location])
+                continue;
             
-            if (!t) {
-                CFArraySetValueAtIndex(maxes, i, (void*)j);
-                break;
-            }
+            EXTLeibnizNode child = {sumTerm, i, digitalSum};
+            if (!EXTLeibnizNodeSetAdd(&visited, child))
+                continue;
+            
+            while (products.count <= digitalSum)
+                [products addObject:[NSMutableArray array]];
+            [products[digitalSum] addObject:
+                            @[leftLoc, locations[i], sumTerm.location]];
             
-            loc = [[loc class] addLocation:loc to:locations[i]];
+            if (frontierCount == frontierCapacity) {
+                frontierCapacity *= 2;
+                frontier = realloc(frontier,
+                                   frontierCapacity * sizeof(EXTLeibnizNode));
+            }
+            frontier[frontierCount++] = child;
         }
     }
     
-    // loop through the available differentials by incrementing an array of
-    // counters.  the idea is that the counter [n0, n1, ..., nm, 0, ..., 0]
-    // corresponds to the product [n0, ..., nm-1, 0, ..., 0] * em.
-    CFMutableArrayRef counter = CFArrayCreateMutable(kCFAllocatorDefault, locations.count, NULL);
-    for (int i = 0; i < locations.count; i++)
-        CFArraySetValueAtIndex(counter, i, (void*)0);
-    CFArraySetValueAtIndex(counter, 0, (void*)1);
-    
-    int digitalSum = 1;
-    while (true) {
-        // increment the counter array
-        for (int i = 0; i < locations.count; i++) {
-            CFArraySetValueAtIndex(counter, i, (void*)((NSInteger)CFArrayGetValueAtIndex(counter, i)+1));
+    free(frontier);
+    free(visited.slots);
+    
+    for (NSArray *wave in products) {
+        // distinct lattice points can land on the same location, so a product
+        // might read a differential which another of the same digital sum
+        // writes.  cut the wave wherever that happens, keeping the order in
+        // which the walk found them.
+        NSMutableSet *reads = [NSMutableSet set], *writes = [NSMutableSet set];
+        NSMutableArray *run = [NSMutableArray array];
+        for (NSArray *product in wave) {
+            EXTLocation *sumLoc = product[2];
+            if ([writes containsObject:product[0]] ||
+                [writes containsObject:product[1]] ||
+                [reads containsObject:sumLoc]) {
+                [self computeLeibnizProducts:run onPage:page];
+                run = [NSMutableArray array];
+                [reads removeAllObjects];
+                [writes removeAllObjects];
+            }
             
-            // check if we should perform a carry
-            if (CFArrayGetValueAtIndex(counter, i) ==
-                                            CFArrayGetValueAtIndex(maxes, i)) {
-                CFArraySetValueAtIndex(counter, i, (void*)0);
-                // and then the for(i) loop will handle the actual carry
-            } else
-                break;
+            [run addObject:product];
+            [reads addObject:product[0]];
+            [reads addObject:product[1]];
+            [writes addObject:sumLoc];
         }
-        
-        // calculate the digital sum
-        digitalSum = 0;
-        for (int i = 0; i < locations.count; i++)
-            digitalSum += (NSInteger)CFArrayGetValueAtIndex(counter, i);
-        
-        // this dictates the two edge cases.  if the counter array has only one
-        // thing in it, then we don't have enough to perform a leibniz
-        // calculation, and we should skip ahead to the next counter.
-        if (digitalSum == 1)
-            continue;
-        // and if we've completely rolled over, we're done, so break and return.
-        else if (digitalSum == 0)
-            break;
-        
-        // otherwise, if we have a digital sum >= 2, then find the topmost
-        // nonzero entry, and think of this as what we're propagating against.
-        int topEntry = locations.count-1;
-        for (; topEntry >= 0; topEntry--)
-            if (CFArrayGetValueAtIndex(counter, topEntry) != 0)
-                break;
-        
-        // build the EXTLocation sum corresponding to the vector coordinate
-        CFArraySetValueAtIndex(counter, topEntry, (void*)((NSInteger)CFArrayGetValueAtIndex(counter, topEntry)-1));
-        EXTLocation *leftLoc = [locClass linearCombination:counter
-                                               ofLocations:(__bridge CFArrayRef)(locations)];
-        CFArraySetValueAtIndex(counter, topEntry, (void*)((NSInteger)CFArrayGetValueAtIndex(counter, topEntry)+1));
-        
-        // probably something more dramatic could happen here in the interest
-        // of speed, like forcing a carry.  this will do for now, though.
-        if (![self findTerm:leftLoc])
+        [self computeLeibnizProducts:run onPage:page];
+    }
+    
+    return;
+}
+
+// runs -computeLeibniz:with:onPage: on each of the @[loc1, loc2, sum] in
+// products, none of which reads a differential that another writes.  the
+// differentials they write to are found (or added) up front, and then the
+// products are grouped by that differential: the groups run concurrently, the
+// products within a group run in order, and each differential is stripped of
+// duplicate definitions once, after its whole group has been appended.
+-(void) computeLeibnizProducts:(NSArray*)products onPage:(int)page {
+    NSMutableDictionary *groupIndices = [NSMutableDictionary dictionary];
+    NSMutableArray *targets = [NSMutableArray array],
+                   *groups = [NSMutableArray array];
+    for (NSArray *product in products) {
+        EXTDifferential *dsum = [self leibnizDifferentialFor:product[0]
+                                                        with:product[1]
+                                                      onPage:page];
+        if (!dsum)
             continue;
         
-        // call -computeLeibniz on (the previous sum + the shifted coordinate)
-        [self computeLeibniz:leftLoc with:locations[topEntry] onPage:page];
+        NSNumber *index = groupIndices[dsum.start.location];
+        if (!index) {
+            index = @(targets.count);
+            groupIndices[dsum.start.location] = index;
+            [targets addObject:dsum];
+            [groups addObject:[NSMutableArray array]];
+        }
+        [groups[index.unsignedIntegerValue] addObject:product];
     }
     
-    // release the stuff ARC is not in charge of.
-    CFRelease(maxes); CFRelease(counter);
+    dispatch_apply(targets.count,
+                   dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                   ^(size_t i) {
+        @autoreleasepool {
+            EXTDifferential *dsum = targets[i];
+            for (NSArray *product in groups[i])
+                [self addLeibnizPartialsFor:product[0]
+                                       with:product[1]
+                                     onPage:page
+                                         to:dsum];
+            [dsum stripDuplicates];
+        }
+    });
     
-    return;
+    for (EXTDifferential *dsum in targets)
+        [self invalidateDifferential:dsum];
 }
 
 - (int)rankOfVector:(NSArray *)vector
@@ -753,10 +1193,11 @@
     if (!sumTerm || !multMatrix)
         return 0;
     
-    EXTMatrix *cycleMatrix = [EXTMatrix matrixWidth:((NSMutableDictionary*)otherTerm.homologyReps[page]).count height:(vector.count*otherTerm.size)];
+    NSDictionary *otherReps = [otherTerm homologyRepsForPage:page];
+    EXTMatrix *cycleMatrix = [EXTMatrix matrixWidth:otherReps.count height:(vector.count*otherTerm.size)];
     cycleMatrix.width = 0;
     int *cycleData = cycleMatrix.presentation.mutableBytes;
-    for (NSArray *cycle in otherTerm.homologyReps[page]) {
+    for (NSArray *cycle in otherReps) {
         NSArray *hadamardResult = [EXTMatrix hadamardVectors:vector with:cycle];
         for (int j = 0; j < cycle.count; j++)
             cycleData[cycleMatrix.height*cycleMatrix.width+j] =
@@ -831,4 +1272,8 @@
     return [self.multTables getMatrixFor:leftLoc with:rightLoc];
 }
 
+-(void) prepareProductsForPairs:(NSArray*)pairs {
+    [self.multTables assembleMatricesForPairs:pairs];
+}
+
 @end
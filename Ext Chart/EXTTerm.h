@@ -6,11 +6,13 @@
 //  Copyright 2011 Harvard University. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
-#import "EXTDocument.h"
 #import "EXTLocation.h"
 #import "EXTMatrix.h"
+#import "EXTPageStore.h"
+
+@class EXTSpectralSequence;
 
 // this class models a cell in the spectral sequence.  it needs to keep track of
 // many things, including not just its position but also its cycle/boundary
@@ -22,7 +24,8 @@
                                              // responders. basis element names.
     @property(retain) NSMutableArray* cycles; // EXTMatrixs of cycle group bases
     @property(retain) NSMutableArray* boundaries; // ...  of bdry group bases
-    @property(retain) NSMutableArray* homologyReps; // of homology dicts.
+    @property(retain) NSMutableArray* homologyReps; // of homology dicts, or
+                                                    // NSNull where dropped.
     @property(retain) EXTMatrix *displayBasis; // change of basis matrix, used
                                                // to display in a nonstd basis
     @property(retain) NSMutableArray* displayNames; // labels for display
@@ -36,11 +39,37 @@
                   withNames:(NSMutableArray*)whichNames
           andCharacteristic:(int)characteristic;
 
+    // the homology representatives on a page.  these may have been dropped
+    // (see -[EXTSpectralSequence dropsIntermediateRepresentatives]), in which
+    // case they're computed again, but not kept.
+    -(NSDictionary*) homologyRepsForPage:(int)whichPage;
+    -(void) dropHomologyRepsForPage:(int)whichPage;
+
     // useful for drawing
     -(int) size;
     -(int) dimension:(int)whichPage;
     -(void) updateDataForPage:(int)whichPage
                        inSSeq:(EXTSpectralSequence*)sSeq;
+    // updateDataForPage:inSSeq: in two halves.  the first reads the groups on
+    // the page before (here and on the neighboring terms, along with the
+    // presentations of the differentials between them) and writes nothing, so
+    // it can be run for every term on a page at once; it returns @[cycles,
+    // boundaries, homology representatives].  the second writes these down.
+    -(NSArray*) groupsForPage:(int)whichPage
+                       inSSeq:(EXTSpectralSequence*)sSeq;
+    -(void) storeGroups:(NSArray*)groups forPage:(int)whichPage;
+    // sends the groups on pages past E_0 out to store, both those computed
+    // already and those to come.  the arrays keep the same interface.
+    -(void) usePageStore:(EXTPageStore*)store;
 
     -(NSString*) nameForVector:(NSArray*)vector;
-@end
\ No newline at end of file
+@end
+
+// matches up the homology representatives of two terms along a map between
+// them.  this lives with the terms rather than the matrices so that EXTMatrix
+// builds against Foundation alone.
+@interface EXTMatrix (EXTHomologyKeys)
+-(NSDictionary*) homologyToHomologyKeysFrom:(EXTTerm*)source
+                                         to:(EXTTerm*)target
+                                     onPage:(int)page;
+@end
@@ -7,8 +7,6 @@
 //
 
 #import "EXTTerm.h"
-#import "EXTGrid.h"
-#import "EXTDocument.h"
 #import "EXTDifferential.h"
 #import "EXTMatrix.h"
 #import "EXTPair.h"
@@ -71,7 +69,7 @@
     for (int i = 0; i < self.boundaries.count; i++)
         ret.boundaries[i] = [self.boundaries[i] copy];
     for (int i = 0; i < self.homologyReps.count; i++)
-        ret.homologyReps[i] = [self.homologyReps[i] copy];
+        ret.homologyReps[i] = self.homologyReps[i];
     
     return ret;
 }
@@ -126,37 +124,42 @@
     return names.count;
 }
 
+// the matrix with the given characteristic, copied if it had another one so
+// that matrices shared with other terms are never written to.
+static EXTMatrix *EXTMatrixWithCharacteristic(EXTMatrix *matrix,
+                                              int characteristic) {
+    if (matrix.characteristic == characteristic)
+        return matrix;
+    
+    EXTMatrix *ret = [matrix copy];
+    ret.characteristic = characteristic;
+    
+    return ret;
+}
+
 // this assumes that the cycles from the page before have already been computed.
 // this may or may not be a desirable trait, but for the moment, that's the way
 // things are.
--(void) computeCycles:(int)whichPage // (the page we're moving *to*)
-                 sSeq:(EXTSpectralSequence*)sSeq {
+-(EXTMatrix*) cyclesForPage:(int)whichPage // (the page we're moving *to*)
+                       sSeq:(EXTSpectralSequence*)sSeq {
     // if we're at the bottom page, then there are no differentials to test.
-    if (whichPage == 0) {
-        return;
-    }
+    if (whichPage == 0)
+        return cycles[0];
 
     // otherwise...
     EXTMatrix *oldCycles = [cycles objectAtIndex:(whichPage-1)];
 
     // if the EXTTerm has already been emptied, don't even bother computing any
     // new differentials.
-    if ([oldCycles width] == 0) {
-        cycles[whichPage] = [EXTMatrix matrixWidth:0 height:self.size];
-        return;
-    }
+    if ([oldCycles width] == 0)
+        return [EXTMatrix matrixWidth:0 height:self.size];
     
     // try to find a freshly acting differential
     EXTDifferential *differential = [sSeq findDifflWithSource:self.location onPage:(whichPage-1)];
     
     // if no differentials act, then copy the old cycles anew.
-    if (!differential) {
-        cycles[whichPage] = [cycles[whichPage-1] copy];
-        return;
-    }
-    
-    // before touching the differential, we need to get it up-to-date.
-    [differential assemblePresentation];
+    if (!differential)
+        return [cycles[whichPage-1] copy];
     
     // we have the cospan B^{r-1}_{s,t} --> E^1_{s,t} <-d-- Z^{r-1}_{s+1,t-r+2}.
     // the pullback span encodes those elements of the right-hand source which
@@ -169,10 +172,12 @@
     EXTMatrix *incomingCycles = cycles[whichPage-1];
     EXTMatrix *right = differential.presentation;
     
-    // if there's something to match the characteristic by, then do it
+    // if there's something to match the characteristic by, then do it.  the
+    // boundaries belong to the target, so this works on a copy.
     if (differential.partialDefinitions.count > 0) {
         EXTPartialDefinition *firstP = differential.partialDefinitions[0];
-        left.characteristic = firstP.inclusion.characteristic;
+        left = EXTMatrixWithCharacteristic(left,
+                                    (int)firstP.inclusion.characteristic);
     }
     
     // this is the span B^{r-1}_{s, t} <-- S --> Z^{r-1}_{s+1, t-r+2}.
@@ -180,59 +185,95 @@
     
     // the composition of the two inclusions S >-> Z^{r-1}_{s+1, t-r+2} >-> ...
     // ... >-> E^1_{s+1, t-r+2} has image the cycle group Z^r_{s+1,t-r+2}.
-    EXTMatrix *cycleComposite = [EXTMatrix newMultiply:incomingCycles by:span[1]];
-    
-    // store it to the cycles list
-    cycles[whichPage] = cycleComposite;
-    
-    return;
+    return [EXTMatrix newMultiply:incomingCycles by:span[1]];
 }
 
--(void) computeBoundaries:(int)whichPage sSeq:(EXTSpectralSequence*)sSeq {
+-(EXTMatrix*) boundariesForPage:(int)whichPage sSeq:(EXTSpectralSequence*)sSeq {
     // if this is page 0, we have a default value to start with.
-    if (whichPage == 0) {
-        return;
-    }
+    if (whichPage == 0)
+        return boundaries[0];
     
     // try to get a differential on this page.
     EXTDifferential *differential = [sSeq findDifflWithTarget:self.location onPage:whichPage-1];
     
     // if we couldn't find a differential, then pretend that the differential is
-    // zero and just keep the old boundaries.
-    if (!differential) {
-        self.boundaries[whichPage] = self.boundaries[whichPage-1];
-        return;
-    }
-    
-    // clean up the differential's presentation before touching it
-    [differential assemblePresentation];
+    // zero and just keep the old boundaries.  copies share their entries until
+    // one of them is written to, so this is cheap.
+    if (!differential)
+        return [boundaries[whichPage-1] copy];
     
     // add these to the old boundaries
-    EXTMatrix *newBoundaries = [boundaries[whichPage - 1] copy];
-    [newBoundaries.presentation appendData:differential.presentation.presentation];
-    newBoundaries.width += differential.presentation.width;
+    EXTMatrix *newBoundaries =
+        [EXTMatrix directSumWithCommonTargetA:boundaries[whichPage - 1]
+                                            B:differential.presentation];
     
-    // find a minimum spanning set and store it
-    boundaries[whichPage] = [newBoundaries image];
+    // find a minimum spanning set
+    return [newBoundaries image];
+}
+
+-(NSArray*) groupsForPage:(int)whichPage inSSeq:(EXTSpectralSequence*)sSeq {
+    // with no differential in or out on the page before, nothing changes, and
+    // the new page can share everything with the old one.
+    if (whichPage > 0 && homologyReps.count >= whichPage &&
+        ![sSeq findDifflWithSource:self.location onPage:(whichPage-1)] &&
+        ![sSeq findDifflWithTarget:self.location onPage:(whichPage-1)]) {
+        EXTMatrix *oldCycles = cycles[whichPage-1],
+                  *oldBoundaries = boundaries[whichPage-1];
+        
+        if (oldCycles.characteristic == sSeq.defaultCharacteristic &&
+            oldBoundaries.characteristic == sSeq.defaultCharacteristic)
+            return @[[oldCycles copy], [oldBoundaries copy],
+                     [self homologyRepsForPage:(whichPage-1)]];
+    }
+    
+    EXTMatrix *cycleMat = [self cyclesForPage:whichPage sSeq:sSeq],
+              *boundaryMat = [self boundariesForPage:whichPage sSeq:sSeq];
+    cycleMat = EXTMatrixWithCharacteristic(cycleMat, sSeq.defaultCharacteristic);
+    boundaryMat = EXTMatrixWithCharacteristic(boundaryMat,
+                                              sSeq.defaultCharacteristic);
+    
+    return @[cycleMat, boundaryMat,
+             [EXTMatrix findOrdersOf:boundaryMat in:cycleMat]];
+}
 
-    return;
+-(void) storeGroups:(NSArray*)groups forPage:(int)whichPage {
+    cycles[whichPage] = groups[0];
+    boundaries[whichPage] = groups[1];
+    homologyReps[whichPage] = groups[2];
+}
+
+-(void) usePageStore:(EXTPageStore*)store {
+    if ([cycles isKindOfClass:[EXTPagedArray class]] &&
+        ((EXTPagedArray*)cycles).store == store)
+        return;
+    
+    cycles = [[EXTPagedArray alloc] initWithArray:cycles store:store];
+    boundaries = [[EXTPagedArray alloc] initWithArray:boundaries store:store];
+    homologyReps = [[EXTPagedArray alloc] initWithArray:homologyReps
+                                                  store:store];
 }
 
 -(void) updateDataForPage:(int)whichPage
                    inSSeq:(EXTSpectralSequence*)sSeq {
-    [self computeCycles:whichPage sSeq:sSeq];
-    [self computeBoundaries:whichPage sSeq:sSeq];
-    
-    EXTMatrix *cycleMat = self.cycles[whichPage],
-              *boundaryMat = self.boundaries[whichPage];
-    cycleMat.characteristic = sSeq.defaultCharacteristic;
-    boundaryMat.characteristic = sSeq.defaultCharacteristic;
+    [self storeGroups:[self groupsForPage:whichPage inSSeq:sSeq]
+              forPage:whichPage];
+}
+
+-(NSDictionary*) homologyRepsForPage:(int)whichPage {
+    id reps = homologyReps[whichPage];
+    if (reps != [NSNull null])
+        return reps;
     
-    homologyReps[whichPage] = [EXTMatrix findOrdersOf:boundaryMat in:cycleMat];
+    return [EXTMatrix findOrdersOf:boundaries[whichPage] in:cycles[whichPage]];
+}
+
+-(void) dropHomologyRepsForPage:(int)whichPage {
+    if (whichPage > 0 && whichPage < homologyReps.count)
+        homologyReps[whichPage] = [NSNull null];
 }
 
 -(int) dimension:(int)whichPage {
-    return ((NSDictionary*)homologyReps[whichPage]).count;
+    return [self homologyRepsForPage:whichPage].count;
 }
 
 -(NSString*) nameForVector:(NSArray*)vector {
@@ -263,3 +304,53 @@
 }
 
 @end
+
+@implementation EXTMatrix (EXTHomologyKeys)
+
+-(NSDictionary*) homologyToHomologyKeysFrom:(EXTTerm*)source
+                                         to:(EXTTerm*)target
+                                     onPage:(int)page {
+    NSArray *hSourceKeys = [source homologyRepsForPage:page].allKeys,
+            *hTargetKeys = [target homologyRepsForPage:page].allKeys;
+    
+    EXTMatrix *hSource = [EXTMatrix matrixWidth:hSourceKeys.count height:source.size],
+              *hTarget = [EXTMatrix matrixWidth:hTargetKeys.count height:target.size];
+    
+    // build source and target
+    int *hSourceData = hSource.presentation.mutableBytes;
+    for (int i = 0; i < hSource.width; i++) {
+        NSArray *vector = hSourceKeys[i];
+        for (int j = 0; j < hSource.height; j++)
+            hSourceData[i*hSource.height + j] = [vector[j] intValue];
+    }
+    
+    NSArray *hSourcePair = [EXTMatrix formIntersection:source.cycles[page] with:hSource];
+    EXTMatrix *hSourceInCycles = [EXTMatrix newMultiply:hSourcePair[0]
+                                                     by:[(EXTMatrix*)hSourcePair[1] invert]];
+    
+    int *hTargetData = hTarget.presentation.mutableBytes;
+    for (int i = 0; i < hTarget.width; i++) {
+        NSArray *vector = hTargetKeys[i];
+        for (int j = 0; j < hTarget.height; j++)
+            hTargetData[i*hTarget.height + j] = [vector[j] intValue];
+    }
+    
+    NSArray *pair = [EXTMatrix formIntersection:[EXTMatrix newMultiply:self by:hSourceInCycles]
+                                           with:[EXTMatrix directSumWithCommonTargetA:hTarget B:target.boundaries[page]]];
+    
+    EXTMatrix *lift = [EXTMatrix newMultiply:pair[1] by:[(EXTMatrix*)pair[0] invertOntoMap]];
+    
+    NSMutableDictionary *assignment = [NSMutableDictionary dictionaryWithCapacity:hSourceKeys.count];
+    for (int i = 0; i < hSourceKeys.count; i++)
+        for (int j = 0; j < hTargetKeys.count; j++) {
+            if (((int*)lift.presentation.mutableBytes)[i*lift.height+j] == 0)
+                continue;
+            if ([[assignment allValues] indexOfObject:hTargetKeys[j]] != NSNotFound)
+                continue;
+            assignment[hSourceKeys[i]] = hTargetKeys[j];
+        }
+    
+    return assignment;
+}
+
+@end
@@ -11,6 +11,7 @@
 #import "EXTDocumentWindowController.h"
 #import "EXTChartViewController.h"
 #import "EXTTerm.h"
+#import "EXTDocument.h"
 
 @interface EXTTermInspectorViewController () <NSTableViewDataSource, NSTableViewDelegate, EXTDocumentInspectorViewDelegate>
 
@@ -89,7 +90,7 @@
         self.bMatrixEditor.rowNames = [term.names valueForKey:@"description"];
         self.zMatrixEditor.rowNames = [term.names valueForKey:@"description"];
         
-        homologyReps = term.homologyReps[page];
+        homologyReps = [term homologyRepsForPage:page];
     } else {
         self.bMatrixEditor.representedObject = nil;
         self.zMatrixEditor.representedObject = nil;
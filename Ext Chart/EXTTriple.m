@@ -34,20 +34,31 @@
                                                 [self a], [self b], [self c]];
 }
 
+-(EXTGrading) grading {
+    EXTGrading ret = {3, {a, b, c}};
+    return ret;
+}
+
++(EXTTriple*) locationWithGrading:(EXTGrading)grading {
+    return [EXTTriple tripleWithA:grading.coordinates[0]
+                                B:grading.coordinates[1]
+                                C:grading.coordinates[2]];
+}
+
 +(EXTTriple*) addLocation:(EXTTriple *)a to:(EXTTriple *)b {
-    return [EXTTriple tripleWithA:(a.a + b.a) B:(a.b + b.b) C:(a.c + b.c)];
+    return [EXTTriple locationWithGrading:EXTGradingAdd(a.grading, b.grading)];
 }
 
 +(EXTTriple*) identityLocation {
-    return [EXTTriple tripleWithA:0 B:0 C:0];
+    return [EXTTriple locationWithGrading:EXTGradingZero(3)];
 }
 
 +(EXTTriple*) negate:(EXTTriple*)loc {
-    return [EXTTriple tripleWithA:(-loc.a) B:(-loc.b) C:(-loc.c)];
+    return [EXTTriple locationWithGrading:EXTGradingScale(loc.grading, -1)];
 }
 
 +(EXTTriple*) scale:(EXTTriple*)loc by:(int)scale {
-    return [EXTTriple tripleWithA:(loc.a*scale) B:(loc.b*scale) C:(loc.c*scale)];
+    return [EXTTriple locationWithGrading:EXTGradingScale(loc.grading, scale)];
 }
 
 +(EXTTriple*) followDiffl:(EXTTriple *)a page:(int)page {
@@ -78,16 +89,7 @@
 }
 
 - (NSUInteger) hash {
-	long long key = [self a];
-	key += [self b];
-	key = (~key) + (key << 18); // key = (key << 18) - key - 1;
-    key += [self c];
-	key = key ^ (key >> 31);
-	key = key * 21; // key = (key + (key << 2)) + (key << 4);
-	key = key ^ (key >> 11);
-	key = key + (key << 6);
-	key = key ^ (key >> 22);
-	return (int) key;
+	return (NSUInteger)EXTGradingHash(self.grading);
 }
 
 -(BOOL) isEqual:(id)other {
@@ -117,7 +119,7 @@
 
 +(EXTTriple*) linearCombination:(CFArrayRef)coeffs
                   ofLocations:(CFArrayRef)generators {
-    int a = 0, b = 0, c = 0;
+    EXTGrading sum = EXTGradingZero(3);
     
     // access this just once.
     int max = CFArrayGetCount(coeffs);
@@ -127,12 +129,10 @@
         __unsafe_unretained EXTTriple *thisGuy = CFArrayGetValueAtIndex(generators, i);
         NSInteger scale = (NSInteger)CFArrayGetValueAtIndex(coeffs, i);
         
-        a += scale*thisGuy->a;
-        b += scale*thisGuy->b;
-        c += scale*thisGuy->c;
+        sum = EXTGradingAddMultiple(sum, thisGuy.grading, (int)scale);
     }
     
-    return [EXTTriple tripleWithA:a B:b C:c];
+    return [EXTTriple locationWithGrading:sum];
 }
 
 @end
@@ -186,16 +186,12 @@
                                 C:[result[2] intValue]];
 }
 
+-(EXTGridProjection) gridProjection {
+    return EXTGridProjectionCompose(userToScreen, internalToUser);
+}
+
 -(EXTIntPoint) gridPoint:(EXTTriple*)loc {
-    EXTTriple *userCoordsTriple = [self convertFromInternalToUser:loc];
-    NSArray *userCoords = @[@(userCoordsTriple.a),
-                            @(userCoordsTriple.b),
-                            @(userCoordsTriple.c)];
-    
-    NSArray *screenCoords = [userToScreen actOn:userCoords];
-    
-    return (EXTIntPoint){[screenCoords[0] intValue],
-                         [screenCoords[1] intValue]};
+    return EXTGridProjectionApply([self gridProjection], loc.grading);
 }
 
 -(EXTIntPoint) followDifflAtGridLocation:(EXTIntPoint)gridLocation
@@ -12,7 +12,7 @@
 //  provided that they propagate as zero.  These classes track such regions.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 #import "EXTLocation.h"
 #import "EXTPair.h"
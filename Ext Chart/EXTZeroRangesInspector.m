@@ -64,6 +64,7 @@
     if ((row < 0) || (row >= self.zeroRanges.count))
         return;
     
+    [self.sseq invalidateZeroRange:self.zeroRanges[row]];
     [self.zeroRanges removeObjectAtIndex:row];
     [self.documentWindowController.document updateChangeCount:NSChangeDone];
     [self.tableView deselectAll:sender];
@@ -92,6 +93,7 @@
             return;
     }
     
+    [self.sseq invalidateZeroRange:self.zeroRanges.lastObject];
     [self.documentWindowController.document updateChangeCount:NSChangeDone];
     [self.tableView reloadData];
     [self.tableView selectRowIndexes:[NSIndexSet indexSetWithIndex:(self.zeroRanges.count-1)] byExtendingSelection:NO];
@@ -176,7 +178,12 @@
 - (void)popoverWillClose:(NSNotification *)notification {
     if ([[_activeZR class] isSubclassOfClass:[EXTZeroRangeStrict class]])
         return;
-    else if ([[_activeZR class] isSubclassOfClass:[EXTZeroRangePair class]]) {
+    
+    // the terms the range used to cover are stale, as are the ones it covers
+    // after the edit.
+    [self.sseq invalidateZeroRange:_activeZR];
+    
+    if ([[_activeZR class] isSubclassOfClass:[EXTZeroRangePair class]]) {
         EXTZeroRangePair *zrPair = (EXTZeroRangePair*)_activeZR;
         zrPair.leftEdge = self.leftEdge.integerValue;
         zrPair.rightEdge = self.rightEdge.integerValue;
@@ -193,6 +200,7 @@
     } else
         return;
     
+    [self.sseq invalidateZeroRange:_activeZR];
     [self.documentWindowController.document updateChangeCount:NSChangeDone];
     [_tableView reloadData];
     
@@ -45,6 +45,12 @@ static const NSInteger _kNumberOfPagesToTest = 5;
         }
 
         XCTAssertEqual(gridLocations.count, self.viewModel.termCells.count, @"There must be at most one cell at a grid location");
+
+        const EXTIntRect gridRect = {{-1, 1}, {3, 3}};
+        NSSet *expectedCells = [NSSet setWithArray:[self.viewModel.termCells filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(EXTChartViewModelTermCell *termCell, NSDictionary *bindings) {
+            return EXTIntPointInRect(termCell.gridLocation, gridRect);
+        }]]];
+        XCTAssertEqualObjects([NSSet setWithArray:[self.viewModel termCellsInGridRect:gridRect]], expectedCells, @"Cells in a grid rect should be those located in it");
     }
 }
 
@@ -0,0 +1,671 @@
+//
+//  EXTMatrixTestCase.m
+//  Ext Chart
+//
+//  Copyright (c) 2026 Harvard University. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "EXTMatrix.h"
+#import "EXTDenseMultiply.h"
+#import "EXTScratch.h"
+
+#include <dispatch/dispatch.h>
+
+
+static EXTMatrix *EXTRandomMatrix(int width, int height, int characteristic, int density) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:height];
+    ret.characteristic = characteristic;
+
+    int *data = ret.presentation.mutableBytes;
+    for (int i = 0; i < width*height; i++)
+        if (random() % 100 < density)
+            data[i] = (int)(random() % (characteristic ? characteristic : 7)) - (characteristic ? 0 : 3);
+
+    return ret;
+}
+
+// schoolbook product, reduced into [0, characteristic).
+static EXTMatrix *EXTReferenceProduct(EXTMatrix *left, EXTMatrix *right, int characteristic) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)right.width height:(int)left.height];
+    ret.characteristic = characteristic;
+
+    int *leftData = left.presentation.mutableBytes,
+        *rightData = right.presentation.mutableBytes,
+        *retData = ret.presentation.mutableBytes;
+    for (int k = 0; k < right.width; k++)
+        for (int i = 0; i < left.height; i++) {
+            long long sum = 0;
+            for (int j = 0; j < left.width; j++)
+                sum += (long long)leftData[j*left.height+i] * rightData[k*right.height+j];
+            if (characteristic)
+                sum = ((sum % characteristic) + characteristic) % characteristic;
+            retData[k*ret.height+i] = (int)sum;
+        }
+
+    return ret;
+}
+
+// kronecker product, entry by entry, reduced into [0, characteristic).
+static EXTMatrix *EXTReferenceKronecker(EXTMatrix *left, EXTMatrix *right, int characteristic) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:(int)(left.width*right.width)
+                                     height:(int)(left.height*right.height)];
+    ret.characteristic = characteristic;
+
+    int *leftData = left.presentation.mutableBytes,
+        *rightData = right.presentation.mutableBytes,
+        *retData = ret.presentation.mutableBytes;
+    for (int i = 0; i < left.width; i++)
+        for (int j = 0; j < right.width; j++)
+            for (int k = 0; k < left.height; k++)
+                for (int l = 0; l < right.height; l++) {
+                    long long entry = (long long)leftData[i*left.height+k] * rightData[j*right.height+l];
+                    if (characteristic)
+                        entry = ((entry % characteristic) + characteristic) % characteristic;
+                    retData[(i*right.width+j)*ret.height + k*right.height+l] = (int)entry;
+                }
+
+    return ret;
+}
+
+static bool EXTMatricesAgree(EXTMatrix *a, EXTMatrix *b, int characteristic) {
+    if (a.width != b.width || a.height != b.height)
+        return false;
+
+    int *aData = a.presentation.mutableBytes, *bData = b.presentation.mutableBytes;
+    for (int i = 0; i < a.width*a.height; i++) {
+        long long x = aData[i], y = bData[i];
+        if (characteristic) {
+            x = ((x % characteristic) + characteristic) % characteristic;
+            y = ((y % characteristic) + characteristic) % characteristic;
+        }
+        if (x != y)
+            return false;
+    }
+
+    return true;
+}
+
+static bool EXTMatrixIsZero(EXTMatrix *a, int characteristic) {
+    return EXTMatricesAgree(a, [EXTMatrix matrixWidth:(int)a.width height:(int)a.height], characteristic);
+}
+
+static int EXTRankOfColumns(EXTMatrix *a, EXTMatrix *b) {
+    EXTMatrix *sum = [EXTMatrix directSumWithCommonTargetA:a B:b];
+    sum.characteristic = a.characteristic;
+    return [sum rank];
+}
+
+static EXTMatrix *EXTIntegerMatrix(int width, int height, const int *entries) {
+    EXTMatrix *ret = [EXTMatrix matrixWidth:width height:height];
+    memcpy(ret.presentation.mutableBytes, entries, sizeof(int)*width*height);
+    return ret;
+}
+
+@interface EXTMatrixTestCase : XCTestCase
+@end
+
+@implementation EXTMatrixTestCase
+
+- (void)setUp {
+    [super setUp];
+    srandom(1729);
+}
+
+#pragma mark - characteristic 2
+
+- (void)testCharacteristicTwoMultiply {
+    // the larger shapes go through the four russians path.
+    int shapes[][3] = {{1, 1, 1}, {5, 9, 3}, {63, 65, 64}, {130, 70, 100}};
+
+    for (int s = 0; s < sizeof(shapes)/sizeof(shapes[0]); s++) {
+        EXTMatrix *left = EXTRandomMatrix(shapes[s][1], shapes[s][0], 2, 40),
+                  *right = EXTRandomMatrix(shapes[s][2], shapes[s][1], 2, 40);
+
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:right],
+                                       EXTReferenceProduct(left, right, 2), 2),
+                      @"F_2 product disagrees with the schoolbook product");
+    }
+}
+
+- (void)testCharacteristicTwoKernelAndImage {
+    for (int trial = 0; trial < 20; trial++) {
+        EXTMatrix *matrix = EXTRandomMatrix(1 + trial*4, 1 + (trial*7) % 50, 2, 30);
+        EXTMatrix *kernel = [matrix kernel], *image = [matrix image];
+
+        XCTAssertTrue(EXTMatrixIsZero([EXTMatrix newMultiply:matrix by:kernel], 2),
+                      @"Kernel vectors should be killed by the matrix");
+        XCTAssertEqual(kernel.width + image.width, matrix.width, @"Rank-nullity should hold");
+        XCTAssertEqual([kernel rank], kernel.width, @"Kernel basis should be independent");
+    }
+}
+
+- (void)testCharacteristicTwoColumnReduceMatchesImage {
+    EXTMatrix *matrix = EXTRandomMatrix(40, 30, 2, 20);
+    EXTMatrix *reduced = [matrix columnReduce];
+
+    XCTAssertEqual([reduced rank], [matrix rank], @"Column reduction should preserve rank");
+    XCTAssertEqual(EXTRankOfColumns(matrix, reduced), [matrix rank],
+                   @"Column reduction should preserve the image");
+}
+
+- (void)testCharacteristicTwoIntersection {
+    EXTMatrix *left = EXTRandomMatrix(12, 20, 2, 30),
+              *right = EXTRandomMatrix(15, 20, 2, 30);
+    NSArray *span = [EXTMatrix formIntersection:left with:right];
+
+    XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:span[0]],
+                                   [EXTMatrix newMultiply:right by:span[1]], 2),
+                  @"The pullback square should commute");
+    XCTAssertEqual(((EXTMatrix*)span[0]).width, 12 + 15 - EXTRankOfColumns(left, right),
+                   @"The pullback should have the expected dimension");
+}
+
+- (void)testCharacteristicTwoHadamardProduct {
+    EXTMatrix *left = EXTRandomMatrix(3, 5, 2, 50),
+              *right = EXTRandomMatrix(7, 11, 2, 50);
+    EXTMatrix *product = [EXTMatrix hadamardProduct:left with:right];
+    left.characteristic = right.characteristic = 0;
+    EXTMatrix *reference = [EXTMatrix hadamardProduct:left with:right];
+
+    XCTAssertTrue(EXTMatricesAgree(product, reference, 2), @"F_2 Kronecker product disagrees with the integral one");
+}
+
+#pragma mark - odd characteristic
+
+- (void)testOddPrimeKernelAndImage {
+    for (int trial = 0; trial < 20; trial++) {
+        EXTMatrix *matrix = EXTRandomMatrix(1 + trial*3, 1 + (trial*5) % 40, 5, 30);
+        EXTMatrix *kernel = [matrix kernel], *image = [matrix image];
+
+        XCTAssertTrue(EXTMatrixIsZero([EXTMatrix newMultiply:matrix by:kernel], 5),
+                      @"Kernel vectors should be killed by the matrix");
+        XCTAssertEqual(kernel.width + image.width, matrix.width, @"Rank-nullity should hold");
+        XCTAssertEqual([image rank], image.width, @"Image basis should be independent");
+        XCTAssertEqual(EXTRankOfColumns(matrix, image), image.width, @"Image should span the columns");
+    }
+}
+
+- (void)testOddPrimeInvert {
+    for (int trial = 0; trial < 10; trial++) {
+        EXTMatrix *matrix = EXTRandomMatrix(12, 12, 7, 60);
+        EXTMatrix *inverse = [matrix invert];
+
+        if ([matrix rank] < 12) {
+            XCTAssertNil(inverse, @"Singular matrices have no inverse");
+            continue;
+        }
+
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:matrix by:inverse],
+                                       [EXTMatrix identity:12], 7),
+                      @"Inverse should be a right inverse");
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:inverse by:matrix],
+                                       [EXTMatrix identity:12], 7),
+                      @"Inverse should be a left inverse");
+    }
+}
+
+- (void)testOddPrimeAssemblePresentation {
+    // a map defined on two complementary pieces of its source should
+    // reassemble to the original map.
+    EXTMatrix *map = EXTRandomMatrix(6, 4, 3, 50);
+    EXTPartialDefinition *first = [EXTPartialDefinition new],
+                         *second = [EXTPartialDefinition new];
+    first.inclusion = [EXTMatrix includeEvenlySpacedBasis:3 endDim:6 offset:0 spacing:1];
+    second.inclusion = [EXTMatrix includeEvenlySpacedBasis:3 endDim:6 offset:3 spacing:1];
+    first.inclusion.characteristic = second.inclusion.characteristic = 3;
+    first.action = [EXTMatrix newMultiply:map by:first.inclusion];
+    second.action = [EXTMatrix newMultiply:map by:second.inclusion];
+
+    EXTMatrix *assembled = [EXTMatrix assemblePresentation:[@[first, second] mutableCopy]
+                                           sourceDimension:6
+                                           targetDimension:4];
+    XCTAssertTrue(EXTMatricesAgree(assembled, map, 3), @"Partial definitions should reassemble the map");
+}
+
+- (void)testFieldOrders {
+    // B is a random subspace of the random subspace Z.
+    EXTMatrix *Z = [EXTRandomMatrix(10, 20, 5, 50) image];
+    EXTMatrix *B = [[EXTMatrix newMultiply:Z by:EXTRandomMatrix(4, (int)Z.width, 5, 50)] image];
+    NSDictionary *orders = [EXTMatrix findOrdersOf:B in:Z];
+
+    XCTAssertEqual(orders.count, Z.width - B.width, @"Z/B should have the expected dimension");
+
+    EXTMatrix *representatives = [EXTMatrix matrixWidth:(int)orders.count height:20];
+    representatives.characteristic = 5;
+    int *data = representatives.presentation.mutableBytes, column = 0;
+    for (NSArray *vector in orders) {
+        XCTAssertEqualObjects(orders[vector], @0, @"Generators over a field are free");
+        for (int j = 0; j < 20; j++)
+            data[column*20 + j] = [vector[j] intValue];
+        column++;
+    }
+    XCTAssertEqual(EXTRankOfColumns(B, representatives), Z.width, @"Representatives should complement B in Z");
+}
+
+#pragma mark - dense products
+
+- (void)testDenseMultiplyPaths {
+    // shapes straddling the row, inner and column blocks, in characteristics
+    // where the accumulators need reducing at every block and almost never.
+    int characteristics[] = {0, 3, 6, 65521, 2147483647},
+        shapes[][3] = {{1, 1, 1}, {7, 65, 17}, {300, 130, 40}};
+    EXTDenseMultiplyPath paths[] = {EXTDenseMultiplyScalar, EXTDenseMultiplySSE41,
+                                    EXTDenseMultiplyAVX2, EXTDenseMultiplyNEON};
+
+    for (int p = 0; p < 4; p++) {
+        if (!EXTDenseMultiplySetPath(paths[p]))
+            continue;
+
+        for (int c = 0; c < 5; c++)
+            for (int s = 0; s < 3; s++) {
+                EXTMatrix *left = EXTRandomMatrix(shapes[s][1], shapes[s][0], characteristics[c], 60),
+                          *right = EXTRandomMatrix(shapes[s][2], shapes[s][1], characteristics[c], 60);
+
+                XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:right],
+                                               EXTReferenceProduct(left, right, characteristics[c]),
+                                               characteristics[c]),
+                              @"Dense product disagrees with the schoolbook product");
+            }
+    }
+
+    EXTDenseMultiplySetPath(EXTDenseMultiplyPreferredPath());
+}
+
+- (void)testDenseMultiplyPerformance {
+    EXTMatrix *left = EXTRandomMatrix(512, 512, 7, 100),
+              *right = EXTRandomMatrix(512, 512, 7, 100);
+
+    [self measureBlock:^{
+        [EXTMatrix newMultiply:left by:right];
+    }];
+}
+
+- (void)testSchoolbookMultiplyPerformance {
+    // the baseline for testDenseMultiplyPerformance.
+    EXTMatrix *left = EXTRandomMatrix(512, 512, 7, 100),
+              *right = EXTRandomMatrix(512, 512, 7, 100);
+
+    [self measureBlock:^{
+        EXTReferenceProduct(left, right, 7);
+    }];
+}
+
+#pragma mark - sparse matrices
+
+- (void)testSparseProducts {
+    // a percent or so of nonzero entries puts these on the sparse routines.
+    int characteristics[] = {0, 2, 5, 6};
+    for (int c = 0; c < 4; c++) {
+        int characteristic = characteristics[c];
+        EXTMatrix *left = EXTRandomMatrix(150, 120, characteristic, 1),
+                  *right = EXTRandomMatrix(90, 150, characteristic, 1);
+
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:right],
+                                       EXTReferenceProduct(left, right, characteristic),
+                                       characteristic),
+                      @"Sparse product disagrees with the schoolbook product");
+
+        EXTMatrix *identity = [EXTMatrix identity:12],
+                  *factor = EXTRandomMatrix(7, 9, characteristic, 40);
+        identity.characteristic = characteristic;
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix hadamardProduct:identity with:factor],
+                                       EXTReferenceKronecker(identity, factor, characteristic),
+                                       characteristic),
+                      @"Sparse Kronecker product disagrees with the reference");
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix hadamardProduct:factor with:identity],
+                                       EXTReferenceKronecker(factor, identity, characteristic),
+                                       characteristic),
+                      @"Sparse Kronecker product disagrees with the reference");
+    }
+}
+
+- (void)testSparseReduction {
+    int characteristics[] = {2, 5};
+    for (int c = 0; c < 2; c++) {
+        int characteristic = characteristics[c];
+        EXTMatrix *matrix = EXTRandomMatrix(200, 160, characteristic, 1);
+        EXTMatrix *kernel = [matrix kernel], *image = [matrix image];
+
+        XCTAssertTrue(EXTMatrixIsZero([EXTMatrix newMultiply:matrix by:kernel], characteristic),
+                      @"Kernel vectors should be killed by the matrix");
+        XCTAssertEqual(kernel.width + image.width, matrix.width, @"Rank-nullity should hold");
+        XCTAssertEqual([kernel rank], kernel.width, @"Kernel basis should be independent");
+        XCTAssertEqual(EXTRankOfColumns(matrix, image), image.width, @"Image should span the columns");
+
+        EXTColumnReduction *reduction = [matrix columnReductionWithLimit:100];
+        XCTAssertTrue(EXTMatricesAgree(EXTReferenceProduct(matrix, reduction.transform, characteristic),
+                                       reduction.reduced, characteristic),
+                      @"The transform should carry the matrix to its reduction");
+    }
+
+    // a sparse, unitriangular matrix inverts.
+    EXTMatrix *matrix = [EXTMatrix identity:100];
+    matrix.characteristic = 7;
+    int *data = matrix.presentation.mutableBytes;
+    for (int i = 1; i < 100; i += 3)
+        data[i*100 + i/2] = 3;
+    EXTMatrix *inverse = [matrix invert];
+    XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:matrix by:inverse], [EXTMatrix identity:100], 7),
+                  @"Inverse should be a right inverse");
+}
+
+- (void)testSparseStorage {
+    // writing through the presentation of a sparse matrix should stick.
+    EXTMatrix *identity = [EXTMatrix identity:50], *copy = [identity copy];
+    ((int*)identity.presentation.mutableBytes)[1] = 4;
+
+    XCTAssertEqual(((int*)identity.presentation.mutableBytes)[1], 4, @"Writes should land in the presentation");
+    XCTAssertEqual(((int*)copy.presentation.mutableBytes)[1], 0, @"Copies should be independent");
+    XCTAssertEqual(((int*)copy.presentation.mutableBytes)[51], 1, @"Copies should keep their entries");
+
+    EXTMatrix *inclusion = [EXTMatrix includeEvenlySpacedBasis:3 endDim:10 offset:4 spacing:2];
+    int *inclusionData = inclusion.presentation.mutableBytes;
+    XCTAssertEqual(inclusion.presentation.length, sizeof(int)*30, @"Inclusion should be 10 x 3");
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 10; j++)
+            XCTAssertEqual(inclusionData[i*10 + j], (j == 4 + 2*i) ? 1 : 0,
+                           @"Basis vector i should land on row offset + spacing*i");
+}
+
+- (void)testIntersectionLeavesOperands {
+    // unreduced entries, on both the dense and the sparse routines.
+    int densities[] = {60, 1};
+    for (int d = 0; d < 2; d++) {
+        EXTMatrix *left = EXTRandomMatrix(100, 120, 5, densities[d]),
+                  *right = EXTRandomMatrix(80, 120, 5, densities[d]);
+        ((int*)left.presentation.mutableBytes)[3] = 12;
+        ((int*)right.presentation.mutableBytes)[7] = -4;
+        EXTMatrix *leftCopy = [left copy], *rightCopy = [right copy];
+
+        NSArray *span = [EXTMatrix formIntersection:left with:right];
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:span[0]],
+                                       [EXTMatrix newMultiply:right by:span[1]], 5),
+                      @"The pullback square should commute");
+        XCTAssertEqual(((EXTMatrix*)span[0]).width, 100 + 80 - EXTRankOfColumns(left, right),
+                       @"The pullback should have the expected dimension");
+        XCTAssertTrue(EXTMatricesAgree(left, leftCopy, 0), @"The left operand should be untouched");
+        XCTAssertTrue(EXTMatricesAgree(right, rightCopy, 0), @"The right operand should be untouched");
+    }
+}
+
+#pragma mark - concurrency
+
+- (void)testEqualityLeavesOperands {
+    EXTMatrix *left = [EXTMatrix matrixWidth:2 height:2],
+              *right = [EXTMatrix matrixWidth:2 height:2];
+    left.characteristic = right.characteristic = 5;
+    ((int*)left.presentation.mutableBytes)[1] = 7;
+    ((int*)right.presentation.mutableBytes)[1] = 2;
+
+    XCTAssertEqualObjects(left, right, @"Equality should be modulo the characteristic");
+    XCTAssertEqual(((int*)left.presentation.mutableBytes)[1], 7, @"Comparing shouldn't reduce the entries");
+}
+
+- (void)testConcurrentReads {
+    // sparse matrices spread themselves out when first read densely, so
+    // several threads reading the same ones should still see the same entries.
+    const int count = 32;
+    EXTMatrix *inclusion = [EXTMatrix includeEvenlySpacedBasis:20 endDim:60 offset:1 spacing:3],
+              *other = EXTRandomMatrix(30, 60, 3, 2);
+    inclusion.characteristic = 3;
+    NSArray *reference = [EXTMatrix formIntersection:[inclusion copy] with:[other copy]];
+
+    NSArray *__strong *spans = (NSArray *__strong *)calloc(count, sizeof(NSArray*));
+    EXTMatrix *__strong *sums = (EXTMatrix *__strong *)calloc(count, sizeof(EXTMatrix*));
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        spans[i] = [EXTMatrix formIntersection:inclusion with:other];
+        sums[i] = [EXTMatrix directSumWithCommonTargetA:inclusion B:other];
+        if (i % 2)
+            [inclusion presentation];
+    });
+
+    EXTMatrix *sum = [EXTMatrix directSumWithCommonTargetA:inclusion B:other];
+    for (int i = 0; i < count; i++) {
+        // which routine each thread took depends on when the spreading
+        // happened, so compare the squares rather than the bases.
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:inclusion by:spans[i][0]],
+                                       [EXTMatrix newMultiply:other by:spans[i][1]], 3),
+                      @"Concurrent pullback squares should commute");
+        XCTAssertEqual(((EXTMatrix*)spans[i][0]).width, ((EXTMatrix*)reference[0]).width,
+                       @"Concurrent intersections should agree with a serial one");
+        XCTAssertTrue(EXTMatricesAgree(sums[i], sum, 3),
+                      @"Concurrent direct sums should agree with a serial one");
+        spans[i] = nil; sums[i] = nil;
+    }
+    free(spans);
+    free(sums);
+}
+
+#pragma mark - scratch space
+
+- (void)testScratchSpace {
+    EXTMatrix *matrix = EXTRandomMatrix(60, 50, 5, 60);
+    int rank = [matrix rank];
+
+    // once the arena has grown to fit, a reduction shouldn't touch the heap.
+    uint64_t allocations = EXTHeapAllocationCount();
+    for (int i = 0; i < 10; i++)
+        XCTAssertEqual([matrix rank], rank, @"Rank should be stable");
+    XCTAssertEqual(EXTHeapAllocationCount(), allocations, @"Rank shouldn't allocate matrix storage");
+
+    EXTMatrix *left = EXTRandomMatrix(30, 40, 5, 60),
+              *right = EXTRandomMatrix(25, 40, 5, 60);
+    [EXTMatrix formIntersection:left with:right];
+    allocations = EXTHeapAllocationCount();
+    NSArray *span = [EXTMatrix formIntersection:left with:right];
+    XCTAssertLessThanOrEqual(EXTHeapAllocationCount() - allocations, 2,
+                             @"An intersection should only allocate its inclusions");
+    XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:span[0]],
+                                   [EXTMatrix newMultiply:right by:span[1]], 5),
+                  @"The pullback square should commute");
+
+    EXTMatrix *square = EXTRandomMatrix(40, 40, 5, 60);
+    [EXTMatrix newMultiply:square by:square];
+    allocations = EXTHeapAllocationCount();
+    [EXTMatrix newMultiply:square by:square];
+    XCTAssertEqual(EXTHeapAllocationCount() - allocations, (uint64_t)1,
+                   @"A product should only allocate its result");
+}
+
+- (void)testColumnViews {
+    EXTMatrix *matrix = EXTRandomMatrix(6, 4, 0, 100);
+    EXTMatrix *view = [matrix columnsFrom:2 count:3];
+    ((int*)view.presentation.mutableBytes)[1] = 17;
+
+    XCTAssertEqual(view.width, 3, @"The view should have the columns asked for");
+    XCTAssertEqual(((int*)matrix.presentation.mutableBytes)[2*4 + 1], 17,
+                   @"Writes to a view should land in the matrix");
+
+    EXTMatrix *built = [EXTMatrix matrixHeight:4 capacity:6];
+    [built appendColumnsOf:[matrix columnsFrom:0 count:2]];
+    [built appendColumnsOf:[matrix columnsFrom:2 count:4]];
+    XCTAssertTrue(EXTMatricesAgree(built, matrix, 0), @"Appending views should rebuild the matrix");
+}
+
+#pragma mark - kronecker products
+
+- (void)testKroneckerProducts {
+    int characteristics[] = {0, 2, 5};
+    for (int c = 0; c < 3; c++) {
+        int characteristic = characteristics[c];
+        EXTMatrix *A = EXTRandomMatrix(4, 3, characteristic, 60),
+                  *B = EXTRandomMatrix(5, 6, characteristic, 60),
+                  *C = EXTRandomMatrix(2, 4, characteristic, 60),
+                  *D = EXTRandomMatrix(3, 5, characteristic, 60);
+        EXTMatrix *AB = [EXTMatrix hadamardProduct:A with:B],
+                  *CD = [EXTMatrix hadamardProduct:C with:D],
+                  *referenceAB = EXTReferenceKronecker(A, B, characteristic),
+                  *referenceCD = EXTReferenceKronecker(C, D, characteristic),
+                  *N = EXTRandomMatrix(7, 20, characteristic, 60),
+                  *M = EXTRandomMatrix(18, 9, characteristic, 60);
+
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:AB by:N],
+                                       EXTReferenceProduct(referenceAB, N, characteristic),
+                                       characteristic),
+                      @"(A (x) B) N disagrees with the reference");
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:M by:AB],
+                                       EXTReferenceProduct(M, referenceAB, characteristic),
+                                       characteristic),
+                      @"M (A (x) B) disagrees with the reference");
+
+        EXTMatrix *product = [EXTMatrix newMultiply:AB by:CD];
+        XCTAssertTrue([product isKindOfClass:[EXTKroneckerMatrix class]] &&
+                      ((EXTKroneckerMatrix*)product).left,
+                      @"A product of Kronecker products should stay unformed");
+        XCTAssertTrue(EXTMatricesAgree(product,
+                                       EXTReferenceProduct(referenceAB, referenceCD, characteristic),
+                                       characteristic),
+                      @"(A (x) B)(C (x) D) disagrees with the reference");
+        XCTAssertNil(((EXTKroneckerMatrix*)product).left,
+                     @"Reading the presentation should form the product");
+    }
+}
+
+- (void)testKroneckerReduction {
+    int characteristics[] = {2, 5};
+    for (int c = 0; c < 2; c++) {
+        int characteristic = characteristics[c];
+        EXTMatrix *A = EXTRandomMatrix(6, 4, characteristic, 50),
+                  *B = EXTRandomMatrix(5, 7, characteristic, 50);
+        EXTMatrix *product = [EXTMatrix hadamardProduct:A with:B],
+                  *reference = EXTReferenceKronecker(A, B, characteristic);
+        EXTMatrix *kernel = [product kernel], *image = [product image];
+
+        XCTAssertEqual([product rank], [reference rank], @"Rank should be multiplicative");
+        XCTAssertTrue(EXTMatrixIsZero(EXTReferenceProduct(reference, kernel, characteristic), characteristic),
+                      @"Kernel vectors should be killed by the product");
+        XCTAssertEqual(kernel.width, reference.width - [reference rank], @"Kernel should have full dimension");
+        XCTAssertEqual([kernel rank], kernel.width, @"Kernel basis should be independent");
+        XCTAssertEqual(image.width, [reference rank], @"Image should have full dimension");
+        XCTAssertEqual(EXTRankOfColumns(reference, image), image.width, @"Image should span the columns");
+    }
+}
+
+- (void)testKroneckerIntersection {
+    EXTMatrix *identity = [EXTMatrix identity:4];
+    identity.characteristic = 5;
+    EXTMatrix *A = EXTRandomMatrix(3, 6, 5, 50),
+              *C = EXTRandomMatrix(4, 6, 5, 50);
+
+    for (int shared = 0; shared < 2; shared++) {
+        EXTMatrix *left = shared ? [EXTMatrix hadamardProduct:identity with:A] :
+                                   [EXTMatrix hadamardProduct:A with:identity],
+                  *right = shared ? [EXTMatrix hadamardProduct:identity with:C] :
+                                    [EXTMatrix hadamardProduct:C with:identity];
+        int rank = EXTRankOfColumns(EXTReferenceKronecker(shared ? identity : A, shared ? A : identity, 5),
+                                    EXTReferenceKronecker(shared ? identity : C, shared ? C : identity, 5));
+        NSArray *span = [EXTMatrix formIntersection:left with:right];
+
+        XCTAssertTrue(EXTMatricesAgree([EXTMatrix newMultiply:left by:span[0]],
+                                       [EXTMatrix newMultiply:right by:span[1]], 5),
+                      @"The pullback square should commute");
+        XCTAssertEqual(((EXTMatrix*)span[0]).width, 12 + 16 - rank,
+                       @"The pullback should have the expected dimension");
+    }
+}
+
+#pragma mark - characteristic 0
+
+- (void)testIntegralOrders {
+    // in the basis of Z, B is spanned by (2, 0, 0) and (2, 6, 0).
+    int zEntries[] = {1, 1, 0,   0, 1, 0,   0, 0, 1},
+        bEntries[] = {2, 2, 0,   2, 8, 0};
+    EXTMatrix *Z = EXTIntegerMatrix(3, 3, zEntries),
+              *B = EXTIntegerMatrix(2, 3, bEntries);
+    NSDictionary *orders = [EXTMatrix findOrdersOf:B in:Z];
+
+    NSArray *sorted = [orders.allValues sortedArrayUsingSelector:@selector(compare:)];
+    XCTAssertEqualObjects(sorted, (@[@0, @2, @6]), @"Z/B should be Z (+) Z/2 (+) Z/6");
+
+    for (NSArray *vector in orders)
+        if ([orders[vector] isEqual:@0])
+            XCTAssertEqual(abs([vector[2] intValue]), 1, @"The free part should be generated by the last basis vector");
+}
+
+- (void)testIntegralOrdersBeyondInt {
+    // the old int-valued factorization overflows on entries this size.
+    int zEntries[] = {1, 0,   0, 1},
+        bEntries[] = {100000, 0,   0, 300000};
+    NSDictionary *orders = [EXTMatrix findOrdersOf:EXTIntegerMatrix(2, 2, bEntries)
+                                                in:EXTIntegerMatrix(2, 2, zEntries)];
+
+    XCTAssertEqualObjects(orders[(@[@0, @1])], @300000, @"Z/B should keep its large cyclic factors");
+    XCTAssertEqualObjects(orders[(@[@1, @0])], @100000, @"Z/B should keep its large cyclic factors");
+}
+
+- (void)testColumnReductionTransform {
+    int characteristics[] = {0, 2, 5, 6};
+    for (int c = 0; c < 4; c++)
+        for (int trial = 0; trial < 10; trial++) {
+            int characteristic = characteristics[c];
+            EXTMatrix *matrix = EXTRandomMatrix(8, 6, characteristic, 40);
+            EXTColumnReduction *reduction = [matrix columnReductionWithLimit:6];
+
+            XCTAssertTrue(EXTMatricesAgree(EXTReferenceProduct(matrix, reduction.transform, characteristic),
+                                           reduction.reduced, characteristic),
+                          @"The transform should carry the matrix to its reduction");
+
+            int pivots = 0;
+            for (NSNumber *pivotColumn in reduction.pivotColumns)
+                if (pivotColumn.intValue != -1)
+                    pivots++;
+            XCTAssertEqual(pivots, reduction.rank, @"The pivot map should record every pivot");
+        }
+}
+
+- (void)testIntegralInvert {
+    // a product of elementary matrices is invertible over Z.
+    EXTMatrix *matrix = [EXTMatrix identity:6];
+    int *data = matrix.presentation.mutableBytes;
+    for (int step = 0; step < 20; step++) {
+        int i = (int)(random() % 6), j = (int)(random() % 6), factor = (int)(random() % 5) - 2;
+        if (i == j)
+            continue;
+        for (int k = 0; k < 6; k++)
+            data[j*6 + k] += factor * data[i*6 + k];
+    }
+
+    EXTMatrix *inverse = [matrix invert];
+    XCTAssertTrue(EXTMatricesAgree(EXTReferenceProduct(matrix, inverse, 0), [EXTMatrix identity:6], 0),
+                  @"Unimodular matrices should invert over Z");
+
+    int singularEntries[] = {2, 0,   0, 1};
+    XCTAssertNil([EXTIntegerMatrix(2, 2, singularEntries) invert], @"Non-unimodular matrices have no inverse over Z");
+}
+
+- (void)testCompositeInvert {
+    // 3 is a unit mod 4 without being +-1, so dividing by it doesn't clear its row.
+    int entries[] = {1, 1,   0, 3};
+    EXTMatrix *matrix = EXTIntegerMatrix(2, 2, entries);
+    matrix.characteristic = 4;
+    EXTMatrix *inverse = [matrix invert];
+    XCTAssertTrue(EXTMatricesAgree(EXTReferenceProduct(matrix, inverse, 4), [EXTMatrix identity:2], 4),
+                  @"Matrices with unit pivots should invert mod 4");
+
+    // a product of elementary matrices and units is invertible mod 12.
+    int units[] = {1, 5, 7, 11};
+    EXTMatrix *product = [EXTMatrix matrixWidth:6 height:6];
+    product.characteristic = 12;
+    int *data = product.presentation.mutableBytes;
+    for (int i = 0; i < 6; i++)
+        data[i*6 + i] = units[random() % 4];
+    for (int step = 0; step < 30; step++) {
+        int i = (int)(random() % 6), j = (int)(random() % 6), factor = (int)(random() % 12);
+        if (i == j)
+            continue;
+        for (int k = 0; k < 6; k++)
+            data[j*6 + k] = (data[j*6 + k] + factor * data[i*6 + k]) % 12;
+    }
+
+    inverse = [product invert];
+    XCTAssertTrue(EXTMatricesAgree(EXTReferenceProduct(product, inverse, 12), [EXTMatrix identity:6], 12),
+                  @"Invertible matrices should invert mod 12");
+
+    int singularEntries[] = {2, 0,   0, 1};
+    EXTMatrix *singular = EXTIntegerMatrix(2, 2, singularEntries);
+    singular.characteristic = 4;
+    XCTAssertNil([singular invert], @"Matrices with a non-unit determinant have no inverse mod 4");
+}
+
+@end
@@ -9,6 +9,15 @@
 #import <XCTest/XCTest.h>
 #import "EXTDemos.h"
 #import "EXTChartViewModel.h"
+#import "EXTChunkedArchive.h"
+#import "EXTDifferential.h"
+#import "EXTLocationDictionary.h"
+#import "EXTMultiplicationTables.h"
+#import "EXTPageStore.h"
+#import "EXTPair.h"
+#import "EXTPolynomialSSeq.h"
+#import "EXTScratch.h"
+#import "EXTTerm.h"
 #import "NSValue+EXTIntPoint.h"
 
 @interface EXTTestCaseS5Demo : XCTestCase
@@ -126,6 +135,385 @@
     }
 }
 
+- (void)testIncrementalRecomputation
+{
+    EXTSpectralSequence *sequence = self.chartViewModel.sequence;
+    [sequence computeGroupsForPage:3];
+
+    EXTTerm *e = [sequence findTerm:[EXTPair pairWithA:1 B:0]],
+            *x = [sequence findTerm:[EXTPair pairWithA:0 B:2]],
+            *one = [sequence findTerm:[EXTPair pairWithA:0 B:0]];
+    XCTAssertEqual([e dimension:3], 0, @"d2(e) = x should kill e");
+    XCTAssertEqual([x dimension:3], 0, @"d2(e) = x should kill x");
+    EXTMatrix *untouchedCycles = one.cycles[3];
+
+    // make d2(e) = 0 instead.
+    EXTDifferential *diff = [sequence findDifflWithSource:e.location onPage:2];
+    for (EXTPartialDefinition *partial in diff.partialDefinitions)
+        partial.action = [EXTMatrix matrixWidth:(int)partial.action.width height:x.size];
+    [sequence invalidateDifferential:diff];
+    [sequence computeGroupsForPage:3];
+
+    XCTAssertEqual([e dimension:3], 1, @"e should survive a zero differential");
+    XCTAssertEqual([x dimension:3], 1, @"x should survive a zero differential");
+    XCTAssertEqual(one.cycles[3], untouchedCycles, @"Terms away from the edit shouldn't be recomputed");
+}
+
+- (void)testReplacedTermRecomputation
+{
+    EXTSpectralSequence *sequence = self.chartViewModel.sequence;
+    [sequence computeGroupsForPage:3];
+
+    // swapping a term out for another leaves the number of terms alone.
+    EXTPair *location = [EXTPair pairWithA:0 B:0];
+    EXTTerm *replacement = [EXTTerm term:location withNames:[NSMutableArray arrayWithArray:@[@"a", @"b"]] andCharacteristic:0];
+    [sequence.terms setObject:replacement forKey:location];
+    [sequence computeGroupsForPage:3];
+
+    XCTAssertEqual([replacement dimension:3], 2, @"A replaced term should be computed from scratch");
+}
+
+- (void)testMultiplicationCache
+{
+    EXTSpectralSequence *sequence = self.chartViewModel.sequence;
+    EXTMultiplicationTables *tables = sequence.multTables;
+    EXTPair *e = [EXTPair pairWithA:1 B:0], *x = [EXTPair pairWithA:0 B:2];
+
+    EXTMatrix *product = [tables getMatrixFor:e with:x];
+    XCTAssertEqual([tables getMatrixFor:e with:x], product, @"An unchanged entry should be assembled once");
+    [sequence prepareProductsForPairs:@[@[e, x], @[x, e]]];
+    XCTAssertEqual([tables getMatrixFor:e with:x], product, @"Preparing should leave current entries alone");
+
+    EXTPartialDefinition *zero = [EXTPartialDefinition new];
+    zero.inclusion = [EXTMatrix matrixWidth:0 height:1];
+    zero.action = [EXTMatrix matrixWidth:0 height:1];
+    [tables addPartialDefinition:zero to:e with:x];
+    XCTAssertNotEqual([tables getMatrixFor:e with:x], product, @"New partial definitions should be assembled");
+
+    // resizing x changes the shape of 1 * x, which has no partial definitions.
+    EXTPair *one = [EXTPair pairWithA:0 B:0];
+    XCTAssertEqual([tables getMatrixFor:one with:x].width, 1, @"1 * x should start out 1 x 1");
+    [[sequence findTerm:x].names addObject:@"y"];
+    [sequence prepareProductsForPairs:@[@[one, x]]];
+    XCTAssertEqual([tables getMatrixFor:one with:x].width, 2, @"Resized terms should be assembled");
+    XCTAssertEqual([tables getMatrixFor:one with:x].height, 2, @"Resized terms should be assembled");
+}
+
+- (EXTPolynomialSSeq *)coneSequence
+{
+    EXTPolynomialSSeq *sequence = [EXTPolynomialSSeq sSeqWithIndexingClass:[EXTPair class] andCharacteristic:0];
+    EXTPair *eta = [EXTPair pairWithA:1 B:1], *C2eta = [EXTPair pairWithA:2 B:0];
+    [sequence addPolyClass:@"eta" location:eta upTo:6];
+    [sequence addPolyClass:@"C(2eta)" location:C2eta upTo:1];
+
+    EXTDifferential *diff = [EXTDifferential differential:[sequence findTerm:C2eta] end:[sequence findTerm:eta] page:1];
+    EXTPartialDefinition *partial = [EXTPartialDefinition new];
+    partial.inclusion = [EXTMatrix identity:1];
+    partial.action = [[EXTMatrix identity:1] scale:2];
+    [diff.partialDefinitions addObject:partial];
+    [sequence addDifferential:diff];
+
+    [sequence computeGroupsForPage:0];
+    [sequence computeGroupsForPage:1];
+
+    return sequence;
+}
+
+- (void)testPolynomialTags
+{
+    EXTPolynomialSSeq *sequence = [self coneSequence];
+    EXTPair *eta = [EXTPair pairWithA:1 B:1], *C2eta = [EXTPair pairWithA:2 B:0];
+    EXTTerm *etaSquared = [sequence findTerm:[EXTPair pairWithA:2 B:2]];
+
+    EXTPolynomialTag *product = [EXTPolynomialTag sum:[sequence findTerm:eta].names[0] with:[sequence findTerm:eta].names[0]];
+    XCTAssertEqualObjects(product, etaSquared.names[0], @"eta * eta should be the tag of eta^2");
+    XCTAssertEqual(product.hash, [etaSquared.names[0] hash], @"Equal tags should hash alike");
+    XCTAssertNotEqual([[sequence findTerm:eta].names[0] hash], [[sequence findTerm:C2eta].names[0] hash], @"Different generators should hash apart");
+    XCTAssertEqual([[sequence indicesOfNamesInTerm:etaSquared][product] intValue], 0, @"Products should be found by hash");
+
+    [sequence changeName:@"eta" to:@"h"];
+    XCTAssertEqualObjects([etaSquared.names[0] description], @" (h)^{2}", @"Renaming should show up in the tags");
+
+    // archived tags are relinked to their generators.
+    EXTPolynomialSSeq *decoded = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:sequence]];
+    XCTAssertEqualObjects([decoded productWithLeft:eta right:C2eta].presentation, [sequence productWithLeft:eta right:C2eta].presentation, @"Decoded tags should multiply alike");
+
+    [sequence deleteClass:@"C(2eta)"];
+    XCTAssertEqual([sequence findTerm:[EXTPair pairWithA:3 B:1]].size, 0, @"Deleting a generator should remove its multiples");
+    XCTAssertEqual(((int *)[sequence productWithLeft:eta right:eta].presentation.mutableBytes)[0] != 0, YES, @"Products of the remaining generators should survive");
+}
+
+- (void)testLeibnizPropagationMatchesSerial
+{
+    EXTPair *eta = [EXTPair pairWithA:1 B:1], *C2eta = [EXTPair pairWithA:2 B:0];
+
+    EXTPolynomialSSeq *propagated = [self coneSequence];
+    [propagated propagateLeibniz:@[eta, C2eta] page:1];
+
+    // the products the counter lattice walks through, in its order.
+    EXTPolynomialSSeq *serial = [self coneSequence];
+    for (int k = 2; k <= 6; k++)
+        [serial computeLeibniz:[EXTPair pairWithA:(k-1) B:(k-1)] with:eta onPage:1];
+    for (int k = 1; k <= 6; k++)
+        [serial computeLeibniz:[EXTPair pairWithA:k B:k] with:C2eta onPage:1];
+
+    XCTAssertEqual([propagated.differentials[1] count], [serial.differentials[1] count], @"Propagation should find the same differentials");
+    for (EXTLocation *location in serial.differentials[1]) {
+        EXTDifferential *expected = serial.differentials[1][location],
+                        *actual = [propagated findDifflWithSource:location onPage:1];
+        XCTAssertNotNil(actual, @"Propagation should find the same differentials");
+        XCTAssertEqualObjects(actual.presentation, expected.presentation, @"Propagated differentials should agree with serial ones");
+    }
+}
+
+- (void)testSparseMonomialProducts
+{
+    EXTPolynomialSSeq *sequence = [self coneSequence];
+    EXTPair *etaSquared = [EXTPair pairWithA:2 B:2], *C2eta = [EXTPair pairWithA:2 B:0], *nowhere = [EXTPair pairWithA:-1 B:0];
+
+    EXTMatrix *leftMap = [[EXTMatrix identity:1] scale:3], *rightMap = [EXTMatrix matrixWidth:2 height:1];
+    ((int *)rightMap.presentation.mutableBytes)[0] = 2;
+    ((int *)rightMap.presentation.mutableBytes)[1] = -1;
+
+    EXTMatrix *expected = [EXTMatrix newMultiply:[sequence productWithLeft:etaSquared right:C2eta] by:[EXTMatrix hadamardProduct:leftMap with:rightMap]],
+              *actual = [sequence productWithLeft:etaSquared through:leftMap right:C2eta through:rightMap];
+    XCTAssertEqual(actual.width, 2, @"The product should take in the tensor product of the sources");
+    XCTAssertEqualObjects(actual.presentation, expected.presentation, @"Products through maps should agree with composing with the kronecker product");
+
+    XCTAssertEqualObjects([sequence productWithLeft:etaSquared through:nil right:C2eta through:nil].presentation, [sequence productWithLeft:etaSquared right:C2eta].presentation, @"Nil maps should act as identities");
+    XCTAssertEqual([sequence productWithLeft:nowhere through:nil right:C2eta through:nil].height, 0, @"Products with empty terms should be empty");
+}
+
+- (void)testBatchedResize
+{
+    EXTPair *eta = [EXTPair pairWithA:1 B:1], *C2eta = [EXTPair pairWithA:2 B:0];
+
+    EXTPolynomialSSeq *serial = [EXTPolynomialSSeq sSeqWithIndexingClass:[EXTPair class] andCharacteristic:0];
+    [serial addPolyClass:@"eta" location:eta upTo:6];
+    [serial addPolyClass:@"C(2eta)" location:C2eta upTo:1];
+
+    EXTPolynomialSSeq *batched = [EXTPolynomialSSeq sSeqWithIndexingClass:[EXTPair class] andCharacteristic:0];
+    [batched addPolyClass:@"eta" location:eta upTo:0];
+    [batched addPolyClass:@"C(2eta)" location:C2eta upTo:0];
+    [batched resizePolyClasses:@{@"eta": @6, @"C(2eta)": @1} onCondition:^bool(EXTLocation *loc) { return true; }];
+
+    XCTAssertEqual(batched.terms.count, serial.terms.count, @"Resizing together should find the same terms");
+    for (EXTLocation *location in serial.terms) {
+        EXTTerm *expected = serial.terms[location], *actual = [batched findTerm:location];
+        XCTAssertEqualObjects(actual.names, expected.names, @"Resizing together should list the monomials in the same order");
+        XCTAssertEqual([actual.cycles[0] width], expected.size, @"New monomials should be cycles");
+    }
+    XCTAssertEqualObjects(batched.generators[0][@"upperBound"], @6, @"The new bounds should be recorded");
+}
+
+- (void)testResizeAfterComputing
+{
+    EXTPair *eta = [EXTPair pairWithA:1 B:1], *C2eta = [EXTPair pairWithA:2 B:0];
+
+    // a second class alongside eta only grows terms that are already there,
+    // including the target of d1, so nothing is added to the dictionary.
+    EXTPolynomialSSeq *resized = [self coneSequence];
+    [resized computeGroupsForPage:2];
+    [resized addPolyClass:@"y" location:eta upTo:0];
+    [resized resizePolyClass:@"y" upTo:1 onCondition:^bool(EXTLocation *loc) { return [resized findTerm:loc] != nil; }];
+    [resized computeGroupsForPage:2];
+
+    EXTPolynomialSSeq *fresh = [EXTPolynomialSSeq sSeqWithIndexingClass:[EXTPair class] andCharacteristic:0];
+    [fresh addPolyClass:@"eta" location:eta upTo:6];
+    [fresh addPolyClass:@"C(2eta)" location:C2eta upTo:1];
+    [fresh addPolyClass:@"y" location:eta upTo:0];
+    [fresh resizePolyClass:@"y" upTo:1 onCondition:^bool(EXTLocation *loc) { return [fresh findTerm:loc] != nil; }];
+    EXTDifferential *diff = [EXTDifferential differential:[fresh findTerm:C2eta] end:[fresh findTerm:eta] page:1];
+    EXTPartialDefinition *partial = [EXTPartialDefinition new];
+    partial.inclusion = [EXTMatrix identity:1];
+    partial.action = [EXTMatrix matrixWidth:1 height:2];
+    ((int *)partial.action.presentation.mutableBytes)[0] = 2;
+    [diff.partialDefinitions addObject:partial];
+    [fresh addDifferential:diff];
+    [fresh computeGroupsForPage:2];
+
+    XCTAssertEqual(resized.terms.count, fresh.terms.count, @"Resizing onto existing terms shouldn't add any");
+    for (EXTLocation *location in fresh.terms) {
+        EXTTerm *expected = fresh.terms[location], *actual = [resized findTerm:location];
+        XCTAssertEqual(actual.size, expected.size, @"Resized terms should have grown");
+        for (int page = 0; page <= 2; page++)
+            XCTAssertEqual([actual dimension:page], [expected dimension:page], @"Resizing after computing should agree with resizing first");
+    }
+}
+
+- (void)testTensorSplicesSharedLocations
+{
+    EXTPair *unit = [EXTPair pairWithA:0 B:0], *one = [EXTPair pairWithA:1 B:0], *two = [EXTPair pairWithA:2 B:0];
+    EXTSpectralSequence *left = [[EXTSpectralSequence sSeqWithUnit:[EXTPair class] andCharacteristic:0] tensorWithPolyClass:@"a" location:one upTo:1];
+    EXTSpectralSequence *tensor = [left tensorWithPolyClass:@"b" location:one upTo:1];
+
+    XCTAssertEqual(tensor.terms.count, 3, @"The pairs should land in three locations");
+    XCTAssertEqual([tensor findTerm:unit].size, 1, @"1 (x) 1 should sit alone");
+    XCTAssertEqual([tensor findTerm:two].size, 1, @"a (x) b should sit alone");
+
+    NSSet *names = [NSSet setWithArray:[[tensor findTerm:one].names valueForKey:@"description"]];
+    XCTAssertEqualObjects(names, ([NSSet setWithArray:@[@"(1)^{0} (a)^{1} (b)^{0}", @"(1)^{0} (a)^{0} (b)^{1}"]]), @"Both pairs at (1, 0) should be spliced together");
+
+    EXTMultiplicationEntry *entry = [tensor.multTables performSoftLookup:one with:one];
+    XCTAssertEqual(entry.partialDefinitions.count, 2, @"a (x) 1 and 1 (x) b should multiply each other, but not themselves");
+    for (EXTPartialDefinition *partial in entry.partialDefinitions) {
+        XCTAssertEqual(partial.inclusion.height, 4, @"Products should include into the tensor square of the spliced term");
+        XCTAssertEqual(partial.action.height, 1, @"Products should land in the term at (2, 0)");
+    }
+}
+
+- (void)testPageStore
+{
+    EXTPageStore *store = [EXTPageStore temporaryStore];
+    EXTMatrix *matrix = [[EXTMatrix identity:3] scale:5];
+    NSDictionary *reps = @{@[@1, @0]: @2};
+    uint64_t matrixOffset = [store appendObject:matrix], repsOffset = [store appendObject:reps];
+    XCTAssertEqualObjects([[store objectAtOffset:matrixOffset] presentation], matrix.presentation, @"Matrices should come back out of the store");
+    XCTAssertEqualObjects([store objectAtOffset:repsOffset], reps, @"Archived objects should come back out of the store");
+
+    EXTPolynomialSSeq *plain = [self coneSequence], *paged = [self coneSequence];
+    paged.pageStore = store;
+    [plain computeGroupsForPage:3];
+    [paged computeGroupsForPage:3];
+
+    for (EXTLocation *location in plain.terms) {
+        EXTTerm *expected = plain.terms[location], *actual = [paged findTerm:location];
+        XCTAssertTrue([actual.cycles isKindOfClass:[EXTPagedArray class]], @"Terms should move their pages into the store");
+        for (int page = 0; page <= 3; page++) {
+            XCTAssertEqualObjects([actual.cycles[page] presentation], [expected.cycles[page] presentation], @"Stored cycles should match");
+            XCTAssertEqualObjects([actual.boundaries[page] presentation], [expected.boundaries[page] presentation], @"Stored boundaries should match");
+            XCTAssertEqual([actual dimension:page], [expected dimension:page], @"Stored homology should match");
+        }
+    }
+}
+
+- (void)testSharedPages
+{
+    EXTMatrix *matrix = [[EXTMatrix identity:3] scale:5], *copy = [matrix copy];
+    ((int*)copy.presentation.mutableBytes)[0] = 7;
+    XCTAssertEqual(((int*)matrix.presentation.mutableBytes)[0], 5, @"Writing to a copy shouldn’t touch the original");
+    XCTAssertEqual(((int*)copy.presentation.mutableBytes)[0], 7, @"Writing to a copy should stick");
+
+    EXTMatrix *original = [[EXTMatrix identity:3] scale:5],
+              *shared = [original copy];
+    XCTAssertTrue([shared entries] == [original entries], @"Reading a copy shouldn’t copy it");
+    uint64_t allocations = EXTHeapAllocationCount();
+    ((int*)shared.presentation.mutableBytes)[0] = 7;
+    ((int*)original.presentation.mutableBytes)[0] = 3;
+    XCTAssertEqual(EXTHeapAllocationCount() - allocations, (uint64_t)1, @"Once a copy has its own entries, its original should write in place");
+    XCTAssertEqual([shared entries][0], 7, @"Writing to the original shouldn’t touch the copy");
+
+    EXTPolynomialSSeq *plain = [self coneSequence], *dropping = [self coneSequence];
+    dropping.dropsIntermediateRepresentatives = YES;
+    [plain computeGroupsForPage:3];
+    [dropping computeGroupsForPage:3];
+
+    for (EXTLocation *location in plain.terms) {
+        EXTTerm *expected = plain.terms[location], *actual = [dropping findTerm:location];
+        XCTAssertTrue(expected.homologyReps[3] == expected.homologyReps[2], @"Pages without differentials should share their representatives");
+        XCTAssertEqualObjects(actual.homologyReps[1], [NSNull null], @"Intermediate representatives should be dropped");
+        XCTAssertEqualObjects([actual homologyRepsForPage:1], expected.homologyReps[1], @"Dropped representatives should be recomputed");
+        XCTAssertEqualObjects([actual homologyRepsForPage:3], expected.homologyReps[3], @"The last page should keep its representatives");
+    }
+}
+
+- (void)testChunkedArchive
+{
+    for (EXTSpectralSequence *sequence in @[self.chartViewModel.sequence, [self coneSequence]]) {
+        EXTChunkedArchive *archive = [[EXTChunkedArchive alloc] initForWritingCompressed:YES];
+        [sequence writeToChunkedArchive:archive];
+        XCTAssertTrue([EXTChunkedArchive isChunkedArchive:archive.data], @"Archives should be recognizable");
+
+        NSError *error = nil;
+        EXTChunkedArchive *reading = [[EXTChunkedArchive alloc] initForReadingWithData:archive.data error:&error];
+        EXTSpectralSequence *copy = [EXTSpectralSequence sSeqFromChunkedArchive:reading error:&error];
+        XCTAssertNotNil(copy, @"Archives should read back: %@", error);
+        XCTAssertEqualObjects([copy class], [sequence class], @"The class of the sequence should survive");
+        XCTAssertEqual(copy.terms.count, sequence.terms.count, @"Every term should survive");
+
+        [sequence computeGroupsForPage:2];
+        [copy computeGroupsForPage:2];
+        for (EXTLocation *location in sequence.terms) {
+            EXTTerm *expected = sequence.terms[location], *actual = [copy findTerm:location];
+            XCTAssertEqualObjects(actual.names, expected.names, @"Names should survive");
+            XCTAssertEqualObjects([actual.cycles[0] presentation], [expected.cycles[0] presentation], @"E_0 cycles should survive");
+            for (int page = 0; page <= 2; page++)
+                XCTAssertEqual([actual dimension:page], [expected dimension:page], @"Homology should come out the same");
+        }
+
+        for (int page = 0; page < sequence.differentials.count; page++)
+            XCTAssertEqual([copy.differentials[page] count], [sequence.differentials[page] count], @"Every differential should survive");
+    }
+
+    // the S5 demo's products are all partial definitions.
+    EXTSpectralSequence *sequence = self.chartViewModel.sequence;
+    EXTChunkedArchive *archive = [[EXTChunkedArchive alloc] initForWritingCompressed:NO];
+    [sequence writeToChunkedArchive:archive];
+    EXTSpectralSequence *copy = [EXTSpectralSequence sSeqFromChunkedArchive:[[EXTChunkedArchive alloc] initForReadingWithData:archive.data error:NULL] error:NULL];
+    EXTPair *e = [EXTPair pairWithA:1 B:0], *x = [EXTPair pairWithA:0 B:2];
+    XCTAssertEqualObjects([[copy.multTables getMatrixFor:e with:x] presentation], [[sequence.multTables getMatrixFor:e with:x] presentation], @"Products should survive");
+
+    NSData *truncated = [archive.data subdataWithRange:NSMakeRange(0, archive.data.length - 8)];
+    NSError *error = nil;
+    EXTChunkedArchive *damaged = [[EXTChunkedArchive alloc] initForReadingWithData:truncated error:&error];
+    XCTAssertTrue(!damaged || ![EXTSpectralSequence sSeqFromChunkedArchive:damaged error:&error], @"Damaged archives shouldn’t load");
+    XCTAssertNotNil(error, @"Damaged archives should say why");
+}
+
+- (void)testLocationDictionary
+{
+    XCTAssertNotEqual([[EXTPair pairWithA:1 B:0] hash], [[EXTPair pairWithA:0 B:1] hash], @"Points on an antidiagonal shouldn’t share a hash");
+
+    EXTLocationDictionary *dictionary = [EXTLocationDictionary dictionary];
+    for (int a = -20; a <= 20; a++)
+        for (int b = -20; b <= 20; b++)
+            dictionary[[EXTPair pairWithA:a B:b]] = @(100*a + b);
+    XCTAssertEqual(dictionary.count, (NSUInteger)(41*41), @"Every location should be kept");
+
+    // clear out the odd antidiagonals, which leaves holes in the probe runs.
+    for (int a = -20; a <= 20; a++)
+        for (int b = -20; b <= 20; b++)
+            if ((a + b) % 2)
+                [dictionary removeObjectForKey:[EXTPair pairWithA:a B:b]];
+
+    for (int a = -20; a <= 20; a++)
+        for (int b = -20; b <= 20; b++) {
+            id expected = (a + b) % 2 ? nil : @(100*a + b);
+            XCTAssertEqualObjects(dictionary[[EXTPair pairWithA:a B:b]], expected, @"Lookups should survive removals");
+            XCTAssertEqualObjects([dictionary objectForGrading:[EXTPair pairWithA:a B:b].grading], expected, @"Lookups by grading should agree with lookups by location");
+        }
+
+    NSMutableDictionary *plain = [NSMutableDictionary dictionaryWithDictionary:dictionary];
+    XCTAssertEqualObjects(dictionary, plain, @"Should compare equal to a plain dictionary");
+}
+
+- (void)testGridIndex
+{
+    EXTSpectralSequence *sequence = self.chartViewModel.sequence;
+    EXTTerm *e = [sequence findTerm:[EXTPair pairWithA:1 B:0]];
+
+    XCTAssertEqualObjects([sequence findTermsUnderPoint:(EXTIntPoint){1, 0}], @[e], @"e should sit at (1, 0)");
+    XCTAssertEqual([sequence findTermsUnderPoint:(EXTIntPoint){2, 0}].count, 0, @"Nothing should sit at (2, 0)");
+    XCTAssertEqual([sequence findTermsInGridRect:(EXTIntRect){{0, 0}, {2, 3}}].count, 4, @"1, e, x and ex should lie in [0, 2) x [0, 3)");
+    XCTAssertEqual([sequence findDifflsSourcedUnderPoint:(EXTIntPoint){1, 0} onPage:2].count, 1, @"d2(e) should be found from its source");
+
+    // terms added or removed later should be picked up.
+    EXTTerm *far = [EXTTerm term:[EXTPair pairWithA:-40 B:100] withNames:[NSMutableArray arrayWithArray:@[@"y"]] andCharacteristic:0];
+    [sequence.terms setObject:far forKey:far.location];
+    XCTAssertEqualObjects([sequence findTermsUnderPoint:(EXTIntPoint){-40, 100}], @[far], @"New terms should be indexed");
+    XCTAssertEqualObjects([sequence findTermsInGridRect:(EXTIntRect){{-100, 50}, {100, 100}}], @[far], @"New terms should be found by rect");
+    [sequence.terms removeObjectForKey:far.location];
+    XCTAssertEqual([sequence findTermsUnderPoint:(EXTIntPoint){-40, 100}].count, 0, @"Removed terms should leave the index");
+
+    // so should a change of grading.
+    EXTPairToPoint *convertor = (EXTPairToPoint *)sequence.locConvertor;
+    EXTMatrix *swap = [EXTMatrix matrixWidth:2 height:2];
+    ((int *)swap.presentation.mutableBytes)[1] = 1;
+    ((int *)swap.presentation.mutableBytes)[2] = 1;
+    convertor.userToScreen = swap;
+    XCTAssertEqualObjects([sequence findTermsUnderPoint:(EXTIntPoint){0, 1}], @[e], @"Regrading should move e to (0, 1)");
+}
+
 // This is an experiment. We could have non-programmers write JSON or property list representations of the expected data
 // and use this generic test.
 // The problem is that the error is extremely generic—representations don’t match—which makes it harder to determine